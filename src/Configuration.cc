@@ -0,0 +1,72 @@
+#include "Configuration.h"
+
+#include <cstdlib>
+#include <cerrno>
+
+Configuration::Configuration() : _verbose(false), _outputName(OUTPUT_NAME_DATE), _distanceMethod(DISTANCE_HAVERSINE), _jobs(1)
+{
+}
+
+Configuration::Configuration(const std::map<std::string, std::string> &values) : _values(values)
+{
+	_verbose = getBool("verbose");
+	_directory = get("directory");
+	const std::string& outputName = get("output_name");
+	if(outputName.empty() || outputName == "date")
+	{
+		_outputName = OUTPUT_NAME_DATE;
+	}
+	else if(outputName == "name")
+	{
+		_outputName = OUTPUT_NAME_SESSION_NAME;
+	}
+	else
+	{
+		THROW_STREAM("Unknown output_name '" << outputName << "', expected date or name");
+	}
+	_trigger = get("trigger");
+	_distanceMethod = parseDistanceMethod(get("distance_method"));
+	_jobs = getUInt("jobs", 1);
+}
+
+const std::string& Configuration::get(const std::string& key) const
+{
+	static const std::string undefined;
+	auto it = _values.find(key);
+	return it == _values.end() ? undefined : it->second;
+}
+
+uint32_t Configuration::getUInt(const std::string& key, uint32_t defaultValue) const
+{
+	const std::string& value = get(key);
+	if(value.empty())
+	{
+		return defaultValue;
+	}
+	char *end = nullptr;
+	errno = 0;
+	unsigned long result = strtoul(value.c_str(), &end, 10);
+	if(value[0] < '0' || value[0] > '9' || *end != '\0' || errno == ERANGE || result > UINT32_MAX)
+	{
+		THROW_STREAM("Invalid value '" << value << "' for " << key << ", expected a positive integer");
+	}
+	return result;
+}
+
+bool Configuration::getBool(const std::string& key, bool defaultValue) const
+{
+	const std::string& value = get(key);
+	if(value.empty())
+	{
+		return defaultValue;
+	}
+	if(value == "true" || value == "yes" || value == "1")
+	{
+		return true;
+	}
+	if(value == "false" || value == "no" || value == "0")
+	{
+		return false;
+	}
+	THROW_STREAM("Invalid value '" << value << "' for " << key << ", expected true or false");
+}
@@ -0,0 +1,56 @@
+#ifndef _CONFIGURATION_H
+#define _CONFIGURATION_H
+
+#include <string>
+#include <map>
+#include <cstdint>
+#include "Utils.h"
+
+// Configuration of the program, built once from the configuration file and the
+// command line options, then given by const reference to devices, filters and outputs.
+// Values used by several layers are converted and checked when the configuration
+// is built. Options specific to a layer are converted by the layer itself, once,
+// in its configure() method.
+class Configuration
+{
+	public:
+		enum OutputName
+		{
+			OUTPUT_NAME_DATE,
+			OUTPUT_NAME_SESSION_NAME
+		};
+
+		Configuration();
+		/**
+		 * @param values configuration keys and their values
+		 * @throw std::runtime_error if a value can't be converted
+		 */
+		explicit Configuration(const std::map<std::string, std::string> &values);
+
+		bool has(const std::string& key) const         { return _values.count(key) != 0; };
+		// Raw value of a key, empty string if the key is not defined
+		const std::string& get(const std::string& key) const;
+		// Value of a key as a number: defaultValue if the key is not defined or empty, throws if it's not a number
+		uint32_t getUInt(const std::string& key, uint32_t defaultValue = 0) const;
+		// Value of a key as a boolean (true/yes/1 or false/no/0): defaultValue if the key is not defined or empty, throws otherwise
+		bool getBool(const std::string& key, bool defaultValue = false) const;
+
+		bool isVerbose() const                         { return _verbose; };
+		const std::string& getDirectory() const        { return _directory; };
+		OutputName getOutputName() const               { return _outputName; };
+		const std::string& getTrigger() const          { return _trigger; };
+		DistanceMethod getDistanceMethod() const       { return _distanceMethod; };
+		// Number of sessions processed in parallel, 0 for one per core
+		uint32_t getJobs() const                       { return _jobs; };
+
+	private:
+		std::map<std::string, std::string> _values;
+		bool _verbose;
+		std::string _directory;
+		OutputName _outputName;
+		std::string _trigger;
+		DistanceMethod _distanceMethod;
+		uint32_t _jobs;
+};
+
+#endif
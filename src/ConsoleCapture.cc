@@ -0,0 +1,112 @@
+#include "ConsoleCapture.h"
+
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+
+namespace
+{
+	thread_local ConsoleCapture *currentCapture = nullptr;
+
+	// Installed in std::cout and std::cerr: sends the characters to the capture of the
+	// current thread if there is one, to the original buffer of the stream otherwise.
+	class RedirectBuffer : public std::streambuf
+	{
+		public:
+			RedirectBuffer(std::streambuf *original, bool error) : _original(original), _error(error) { };
+
+		protected:
+			int_type overflow(int_type c) override
+			{
+				if(traits_type::eq_int_type(c, traits_type::eof()))
+				{
+					return traits_type::not_eof(c);
+				}
+				if(currentCapture != nullptr)
+				{
+					char character = traits_type::to_char_type(c);
+					currentCapture->append(_error, &character, 1);
+					return c;
+				}
+				return _original->sputc(traits_type::to_char_type(c));
+			}
+
+			std::streamsize xsputn(const char *text, std::streamsize length) override
+			{
+				if(currentCapture != nullptr)
+				{
+					currentCapture->append(_error, text, length);
+					return length;
+				}
+				return _original->sputn(text, length);
+			}
+
+			int sync() override
+			{
+				return currentCapture != nullptr ? 0 : _original->pubsync();
+			}
+
+		private:
+			std::streambuf *_original;
+			bool _error;
+	};
+
+	std::once_flag redirectInstalled;
+
+	void installRedirect()
+	{
+		// Never deleted: std::cout and std::cerr are still used while static objects are destroyed
+		std::cout.rdbuf(new RedirectBuffer(std::cout.rdbuf(), false));
+		std::cerr.rdbuf(new RedirectBuffer(std::cerr.rdbuf(), true));
+	}
+}
+
+void ConsoleCapture::install()
+{
+	std::call_once(redirectInstalled, installRedirect);
+}
+
+void ConsoleCapture::start()
+{
+	install();
+	currentCapture = this;
+	_capturing = true;
+}
+
+void ConsoleCapture::stop()
+{
+	if(_capturing && currentCapture == this)
+	{
+		currentCapture = nullptr;
+	}
+	_capturing = false;
+}
+
+void ConsoleCapture::append(bool error, const char *text, size_t length)
+{
+	if(_chunks.empty() || _chunks.back().error != error)
+	{
+		_chunks.push_back(Chunk { error, std::string() });
+	}
+	_chunks.back().text.append(text, length);
+}
+
+void ConsoleCapture::replay() const
+{
+	for(const auto& chunk : _chunks)
+	{
+		std::ostream &stream = chunk.error ? std::cerr : std::cout;
+		stream << chunk.text;
+	}
+	std::cout.flush();
+}
+
+std::string ConsoleCapture::str() const
+{
+	std::string result;
+	for(const auto& chunk : _chunks)
+	{
+		result += chunk.text;
+	}
+	return result;
+}
@@ -0,0 +1,45 @@
+#ifndef _CONSOLECAPTURE_H
+#define _CONSOLECAPTURE_H
+
+#include <string>
+#include <vector>
+
+// Captures what the current thread writes to std::cout and std::cerr.
+// Tasks running in parallel capture their messages, which are then printed
+// in a deterministic order with replay(). Other threads are not affected.
+class ConsoleCapture
+{
+	public:
+		ConsoleCapture() : _capturing(false) { };
+		~ConsoleCapture()                            { stop(); };
+
+		ConsoleCapture(const ConsoleCapture&) = delete;
+		ConsoleCapture& operator=(const ConsoleCapture&) = delete;
+
+		// Hooks std::cout and std::cerr. Done by the first start() if not called before, but must be
+		// called first when other threads may be writing to the console at that time.
+		static void install();
+
+		// Starts capturing the messages of the current thread
+		void start();
+		// Stops capturing: messages are written to the console again
+		void stop();
+		// Writes the captured messages to std::cout and std::cerr, in the order they were written
+		void replay() const;
+		// Captured messages, std::cout and std::cerr ones mixed
+		std::string str() const;
+
+		void append(bool error, const char *text, size_t length);
+
+	private:
+		struct Chunk
+		{
+			bool error;
+			std::string text;
+		};
+
+		std::vector<Chunk> _chunks;
+		bool _capturing;
+};
+
+#endif
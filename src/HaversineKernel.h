@@ -0,0 +1,171 @@
+// Vectorized haversine kernel.
+//
+// This file has no include guard: Utils.cc includes it in a region compiled
+// for the target instruction set, after defining:
+//  - HAVERSINE_NAMESPACE: namespace in which the kernel is defined
+//  - VEC: vector of doubles (GCC vector extension, e.g. __m256d)
+//  - VMASK: vector of 64 bits integers with the same size as VEC
+//  - WIDTH: number of doubles in VEC
+//  - VSET1(x), VLOADU(p), VSTOREU(p, v), VSQRT(v) and VFMA(a, b, c) (a*b+c)
+//
+// sin, cos and asin are evaluated with polynomials whose truncation error is
+// below 1e-17, so that the result only differs from the scalar libm version
+// by rounding errors.
+
+namespace HAVERSINE_NAMESPACE
+{
+	static inline VEC select(VMASK mask, VEC ifTrue, VEC ifFalse)
+	{
+		return (VEC)(((VMASK)ifTrue & mask) | ((VMASK)ifFalse & ~mask));
+	}
+
+	// Rounds to the nearest integer, valid for |x| < 2^51
+	static inline VEC roundToInt(VEC x)
+	{
+		const VEC magic = VSET1(6755399441055744.0);
+		return (x + magic) - magic;
+	}
+
+	// Returns r in [-pi/4, pi/4] such that x = r + n*pi/2, and whether n is odd
+	static inline VEC reduceQuadrant(VEC x, VMASK &odd)
+	{
+		// pi/2 split in two parts, the first one having enough trailing zeros for n*PIO2_HI to be exact
+		const VEC PIO2_HI = VSET1(1.57079632673412561417e+00);
+		const VEC PIO2_LO = VSET1(6.07710050650619224932e-11);
+		VEC n = roundToInt(x * VSET1(2.0 / PI));
+		VEC half = n * VSET1(0.5);
+		odd = (VMASK)(half != roundToInt(half));
+		return (x - n * PIO2_HI) - n * PIO2_LO;
+	}
+
+	// sin(r) for |r| <= pi/4 (Taylor series up to r^17)
+	static inline VEC sinPolynomial(VEC r)
+	{
+		VEC z = r * r;
+		VEC p = VSET1(2.8114572543455206e-15);
+		p = VFMA(p, z, VSET1(-7.647163731819816e-13));
+		p = VFMA(p, z, VSET1(1.6059043836821613e-10));
+		p = VFMA(p, z, VSET1(-2.505210838544172e-08));
+		p = VFMA(p, z, VSET1(2.7557319223985893e-06));
+		p = VFMA(p, z, VSET1(-0.0001984126984126984));
+		p = VFMA(p, z, VSET1(0.008333333333333333));
+		p = VFMA(p, z, VSET1(-0.16666666666666666));
+		return r + r * z * p;
+	}
+
+	// cos(r) for |r| <= pi/4 (Taylor series up to r^16)
+	static inline VEC cosPolynomial(VEC r)
+	{
+		VEC z = r * r;
+		VEC p = VSET1(4.779477332387385e-14);
+		p = VFMA(p, z, VSET1(-1.1470745597729725e-11));
+		p = VFMA(p, z, VSET1(2.08767569878681e-09));
+		p = VFMA(p, z, VSET1(-2.755731922398589e-07));
+		p = VFMA(p, z, VSET1(2.48015873015873e-05));
+		p = VFMA(p, z, VSET1(-0.001388888888888889));
+		p = VFMA(p, z, VSET1(0.041666666666666664));
+		return (VSET1(1.0) - z * VSET1(0.5)) + z * z * p;
+	}
+
+	static inline VEC squaredSin(VEC x)
+	{
+		VMASK odd;
+		VEC r = reduceQuadrant(x, odd);
+		VEC sin = sinPolynomial(r);
+		// sin(r)^2 <= 1/2 so cos(r)^2 = 1 - sin(r)^2 does not lose precision
+		VEC squared = sin * sin;
+		return select(odd, VSET1(1.0) - squared, squared);
+	}
+
+	// |cos(x)|: latitudes are in [-90, 90] so their cosine is never negative
+	static inline VEC absCos(VEC x)
+	{
+		VMASK odd;
+		VEC r = reduceQuadrant(x, odd);
+		VEC value = select(odd, sinPolynomial(r), cosPolynomial(r));
+		return select((VMASK)(value < VSET1(0.0)), -value, value);
+	}
+
+	// asin(sqrt(h)) for h in [0, 1]
+	static inline VEC asinSqrt(VEC h)
+	{
+		VEC s = VSQRT(h);
+		// Above 0.5: asin(s) = pi/2 - 2*asin(sqrt((1-s)/2))
+		VMASK big = (VMASK)(s > VSET1(0.5));
+		VEC w = select(big, (VSET1(1.0) - s) * VSET1(0.5), h);
+		VEC r = select(big, VSQRT(w), s);
+		// asin(r) = r * P(r^2) with r^2 = w <= 1/4 (Taylor series up to r^49)
+		// Both halves of the polynomial are evaluated separately to shorten the dependency chains:
+		// P(w) = E(w^2) + w*O(w^2)
+		VEC w2 = w * w;
+		VEC e = VSET1(0.0024894486782468836);
+		e = VFMA(e, w2, VSET1(0.002846178401108942));
+		e = VFMA(e, w2, VSET1(0.003297059503473485));
+		e = VFMA(e, w2, VSET1(0.003880964558837669));
+		e = VFMA(e, w2, VSET1(0.004660143486915096));
+		e = VFMA(e, w2, VSET1(0.005740037670841924));
+		e = VFMA(e, w2, VSET1(0.0073125258735988454));
+		e = VFMA(e, w2, VSET1(0.009761609529194078));
+		e = VFMA(e, w2, VSET1(0.01396484375));
+		e = VFMA(e, w2, VSET1(0.022372159090909092));
+		e = VFMA(e, w2, VSET1(0.044642857142857144));
+		e = VFMA(e, w2, VSET1(0.16666666666666666));
+		VEC o = VSET1(0.002338091892111975);
+		o = VFMA(o, w2, VSET1(0.00265787063820729));
+		o = VFMA(o, w2, VSET1(0.0030578216492580306));
+		o = VFMA(o, w2, VSET1(0.0035692053938259347));
+		o = VFMA(o, w2, VSET1(0.004240907093679363));
+		o = VFMA(o, w2, VSET1(0.005153309682319905));
+		o = VFMA(o, w2, VSET1(0.006447210311889649));
+		o = VFMA(o, w2, VSET1(0.008390335809616815));
+		o = VFMA(o, w2, VSET1(0.011551800896139705));
+		o = VFMA(o, w2, VSET1(0.017352764423076924));
+		o = VFMA(o, w2, VSET1(0.030381944444444444));
+		o = VFMA(o, w2, VSET1(0.075));
+		VEC p = VFMA(o, w, e);
+		VEC asinR = r + r * w * p;
+		return select(big, VSET1(PI / 2.0) - asinR * VSET1(2.0), asinR);
+	}
+
+	// Same formula as ArcInRadians, WIDTH segments at a time.
+	// Returns the number of segments computed, the remaining ones (less than WIDTH) are left to the caller.
+	static size_t distances(const double *lat, const double *lon, size_t nbSegments, double *result)
+	{
+		const VEC degToRad = VSET1(DEG_TO_RAD);
+		const VEC half = VSET1(0.5);
+		const VEC one = VSET1(1.0);
+		size_t i = 0;
+		if(nbSegments < WIDTH)
+		{
+			return i;
+		}
+		// The cosine of each latitude is used by two segments: it is computed once and
+		// shifted by one lane through cosLat
+		double cosLat[2 * WIDTH];
+		VEC cos1 = absCos(VLOADU(lat) * degToRad);
+		for(; i + WIDTH <= nbSegments; i += WIDTH)
+		{
+			VEC cos2;
+			VEC cosNext = cos1;
+			if(i + 2 * WIDTH <= nbSegments + 1)
+			{
+				cosNext = absCos(VLOADU(lat + i + WIDTH) * degToRad);
+				VSTOREU(cosLat, cos1);
+				VSTOREU(cosLat + WIDTH, cosNext);
+				cos2 = VLOADU(cosLat + 1);
+			}
+			else
+			{
+				cos2 = absCos(VLOADU(lat + i + 1) * degToRad);
+			}
+			VEC latitudeArc = (VLOADU(lat + i) - VLOADU(lat + i + 1)) * degToRad;
+			VEC longitudeArc = (VLOADU(lon + i) - VLOADU(lon + i + 1)) * degToRad;
+			VEC h = squaredSin(latitudeArc * half) + cos1 * cos2 * squaredSin(longitudeArc * half);
+			// Rounding errors must not bring h above 1
+			h = select((VMASK)(h > one), one, h);
+			VSTOREU(result + i, asinSqrt(h) * VSET1(2.0 * EARTH_RADIUS_IN_METERS));
+			cos1 = cosNext;
+		}
+		return i;
+	}
+}
@@ -0,0 +1,101 @@
+#include "ImportLedger.h"
+
+#include <iomanip>
+#include <sstream>
+
+ImportLedger::ImportLedger(const std::string &filename) : _filename(filename)
+{
+	std::ifstream file(filename.c_str());
+	std::string line;
+	while(std::getline(file, line))
+	{
+		std::istringstream fields(line);
+		std::string device, id, fingerprint, outputs;
+		if(!std::getline(fields, device, '\t') || !std::getline(fields, id, '\t') || !std::getline(fields, fingerprint, '\t') || !std::getline(fields, outputs))
+		{
+			continue;
+		}
+		std::istringstream value(fingerprint);
+		uint64_t parsed = 0;
+		if(!(value >> std::hex >> parsed)) continue;
+		apply(device + '\t' + id, parsed, splitString(outputs));
+	}
+}
+
+std::string ImportLedger::key(const std::string &device, const SessionId &id)
+{
+	std::ostringstream oss;
+	oss << device << '\t' << std::hex << std::setfill('0');
+	for(char c : id)
+	{
+		oss << std::setw(2) << (int)(unsigned char)c;
+	}
+	return oss.str();
+}
+
+void ImportLedger::apply(const std::string &key, uint64_t fingerprint, const std::list<std::string> &outputs)
+{
+	Entry &entry = _entries[key];
+	if(entry.fingerprint != fingerprint)
+	{
+		// The session changed: what was imported before is outdated
+		entry.fingerprint = fingerprint;
+		entry.outputs.clear();
+	}
+	entry.outputs.insert(outputs.begin(), outputs.end());
+}
+
+bool ImportLedger::has(const std::string &device, const SessionId &id) const
+{
+	return _entries.count(key(device, id)) != 0;
+}
+
+bool ImportLedger::isImported(const std::string &device, const SessionId &id, uint64_t fingerprint, const std::list<std::string> &outputs) const
+{
+	auto entry = _entries.find(key(device, id));
+	if(entry == _entries.end() || entry->second.fingerprint != fingerprint) return false;
+	for(const auto& output : outputs)
+	{
+		if(entry->second.outputs.count(output) == 0) return false;
+	}
+	return true;
+}
+
+void ImportLedger::record(const std::string &device, const SessionId &id, uint64_t fingerprint, const std::list<std::string> &outputs)
+{
+	if(!_file.is_open())
+	{
+		// A record cut by a crash must not swallow the next one
+		std::ifstream existing(_filename.c_str(), std::ios_base::in | std::ios_base::binary);
+		bool cut = existing.seekg(-1, std::ios_base::end) && existing.get() != '\n';
+		_file.open(_filename.c_str(), std::ios_base::out | std::ios_base::app);
+		if(cut) _file << std::endl;
+	}
+	std::string sessionKey = key(device, id);
+	_file << sessionKey << '\t' << std::hex << fingerprint << std::dec << '\t';
+	for(auto output = outputs.begin(); output != outputs.end(); ++output)
+	{
+		_file << (output == outputs.begin() ? "" : ",") << *output;
+	}
+	_file << std::endl;
+	if(!_file)
+	{
+		THROW_STREAM("Unable to write import ledger " << _filename);
+	}
+	apply(sessionKey, fingerprint, outputs);
+}
+
+uint64_t ImportLedger::summaryFingerprint(const Session &session)
+{
+	time_t time = session.getTime();
+	uint32_t nbPoints = session.getNbPoints();
+	double duration = session.getDuration();
+	uint32_t distance = session.getDistance();
+	uint32_t nbLaps = session.getNbLaps();
+	uint64_t hash = hashBytes(session.getId().begin(), session.getId().size());
+	hash = hashBytes(&time, sizeof(time), hash);
+	hash = hashBytes(&nbPoints, sizeof(nbPoints), hash);
+	hash = hashBytes(&duration, sizeof(duration), hash);
+	hash = hashBytes(&distance, sizeof(distance), hash);
+	return hashBytes(&nbLaps, sizeof(nbLaps), hash);
+}
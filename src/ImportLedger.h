@@ -0,0 +1,58 @@
+#ifndef _IMPORTLEDGER_H
+#define _IMPORTLEDGER_H
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "bom/Session.h"
+
+// Sessions already imported, and to which outputs, so that import=new neither depends on the
+// names of the output files nor checks each of them.
+// A session is identified by its device and its id. Its fingerprint (see Session::getFingerprint)
+// tells if it changed since it was imported: a session that grew on the watch is imported again.
+// Records are appended to a file, one per line, with tab separated fields: device, id and
+// fingerprint in hexadecimal, then outputs separated by commas. For a given session, the last
+// record wins. The whole file is read once to index the records by session.
+class ImportLedger
+{
+	public:
+		// Reads the records of the ledger file if there is one. Lines that can't be read (like one cut by a crash) are ignored.
+		explicit ImportLedger(const std::string &filename);
+
+		ImportLedger(const ImportLedger&) = delete;
+		ImportLedger& operator=(const ImportLedger&) = delete;
+
+		// Tells if there is a record of a session, whatever its fingerprint
+		bool has(const std::string &device, const SessionId &id) const;
+		// Tells if a session with this fingerprint was imported to each of the outputs
+		bool isImported(const std::string &device, const SessionId &id, uint64_t fingerprint, const std::list<std::string> &outputs) const;
+
+		/**
+		 * Records that a session was imported to outputs, written to the file at once
+		 * @throw std::runtime_error if the file can't be written
+		 */
+		void record(const std::string &device, const SessionId &id, uint64_t fingerprint, const std::list<std::string> &outputs);
+
+		// Fingerprint of a session from the summary given with the list of sessions, for devices that don't give one
+		static uint64_t summaryFingerprint(const Session &session);
+
+	private:
+		struct Entry
+		{
+			uint64_t fingerprint;
+			std::unordered_set<std::string> outputs;
+		};
+
+		static std::string key(const std::string &device, const SessionId &id);
+		// Applies a record to the index
+		void apply(const std::string &key, uint64_t fingerprint, const std::list<std::string> &outputs);
+
+		std::string _filename;
+		std::ofstream _file;
+		std::unordered_map<std::string, Entry> _entries;
+};
+
+#endif
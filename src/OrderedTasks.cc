@@ -0,0 +1,74 @@
+#include "OrderedTasks.h"
+
+OrderedTasks::OrderedTasks(ThreadPool &pool) : _pool(pool), _next(0), _nbRunning(0)
+{
+	// Other threads may be writing to the console while tasks run: hooks must be installed now
+	ConsoleCapture::install();
+}
+
+OrderedTasks::~OrderedTasks()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_taskDone.wait(lock, [this] { return _nbRunning == 0; });
+}
+
+void OrderedTasks::submit(std::function<void()> task)
+{
+	_tasks.emplace_back(new Task());
+	Task *current = _tasks.back().get();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_nbRunning;
+	}
+	_pool.submit([this, current, task]()
+	{
+		current->console.start();
+		try
+		{
+			task();
+		}
+		catch(...)
+		{
+			current->error = std::current_exception();
+		}
+		current->console.stop();
+		std::lock_guard<std::mutex> lock(_mutex);
+		current->done = true;
+		--_nbRunning;
+		_taskDone.notify_all();
+	});
+}
+
+bool OrderedTasks::completeNext()
+{
+	if(_next == _tasks.size())
+	{
+		return false;
+	}
+	Task *task = _tasks[_next++].get();
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_taskDone.wait(lock, [task] { return task->done; });
+	}
+	task->console.replay();
+	std::exception_ptr error = task->error;
+	if(_next == _tasks.size())
+	{
+		// All done: the messages of the tasks are not kept until the next ones
+		_tasks.clear();
+		_next = 0;
+	}
+	if(error)
+	{
+		std::rethrow_exception(error);
+	}
+	return true;
+}
+
+void OrderedTasks::completeAll()
+{
+	while(completeNext())
+	{
+		// Each call prints the messages of a task
+	}
+}
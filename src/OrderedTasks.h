@@ -0,0 +1,60 @@
+#ifndef _ORDEREDTASKS_H
+#define _ORDEREDTASKS_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ConsoleCapture.h"
+#include "ThreadPool.h"
+
+// Tasks run on a pool of threads, with their messages captured, and completed in the order they
+// were submitted: their messages are printed and their results used in the same order whatever
+// the number of threads. Several groups of tasks can share the same pool.
+class OrderedTasks
+{
+	public:
+		explicit OrderedTasks(ThreadPool &pool);
+		// Waits for the tasks still running, without printing their messages
+		~OrderedTasks();
+
+		OrderedTasks(const OrderedTasks&) = delete;
+		OrderedTasks& operator=(const OrderedTasks&) = delete;
+
+		// Queues a task. What it writes to the console is printed when it is completed.
+		void submit(std::function<void()> task);
+
+		/**
+		 * Waits for the first task not completed yet and prints its messages.
+		 * @return false if all the tasks submitted were already completed
+		 * @throw the exception thrown by the task
+		 */
+		bool completeNext();
+		/**
+		 * Completes all the tasks submitted, in order
+		 * @throw the exception thrown by a task, once the previous ones are completed
+		 */
+		void completeAll();
+
+	private:
+		struct Task
+		{
+			Task() : done(false) { };
+			ConsoleCapture console;
+			std::exception_ptr error;
+			bool done;
+		};
+
+		ThreadPool &_pool;
+		std::vector<std::unique_ptr<Task>> _tasks;
+		// Index in _tasks of the first task not completed
+		size_t _next;
+		// Tasks submitted to the pool and not done yet
+		size_t _nbRunning;
+		std::mutex _mutex;
+		std::condition_variable _taskDone;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "Pipeline.h"
+#include "filter/Filter.h"
+#include "output/Output.h"
+#include "Registry.h"
+
+#include <iostream>
+
+Pipeline::Pipeline(const Configuration &configuration, const std::list<std::string> &filters, const std::list<std::string> &outputs, ThreadPool &pool) :
+	_configuration(configuration), _filters(filters), _outputs(outputs), _tasks(pool)
+{
+}
+
+void Pipeline::add(Session *session)
+{
+	auto inserted = _exported.insert(std::make_pair(session, std::list<std::string>()));
+	if(!inserted.second || static_cast<const Session*>(session)->getPoints().empty())
+	{
+		// Most likely not imported when using a file: there is nothing to export
+		return;
+	}
+	// Elements of an unordered_map are not moved when others are inserted
+	std::list<std::string> *exported = &inserted.first->second;
+	_tasks.submit([this, session, exported]() { *exported = process(session); });
+}
+
+bool Pipeline::contains(const Session *session) const
+{
+	return _exported.count(session) != 0;
+}
+
+const std::list<std::string>& Pipeline::getExported(const Session *session) const
+{
+	static const std::list<std::string> none;
+	auto it = _exported.find(session);
+	return it == _exported.end() ? none : it->second;
+}
+
+void Pipeline::finish()
+{
+	_tasks.completeAll();
+}
+
+std::list<std::string> Pipeline::process(Session *session) const
+{
+	std::list<std::string> exported;
+	for(const auto& filterName : _filters)
+	{
+		filter::Filter *filter = LayerRegistry<filter::Filter>::getInstance()->getObject(filterName);
+		if(filter)
+		{
+			std::cout << "  Applying filter " << filterName << std::endl;
+			filter->filter(session, _configuration);
+		}
+		else
+		{
+			std::cout << "Filter does not exist: " << filterName << std::endl;
+		}
+	}
+	for(const auto& outputName : _outputs)
+	{
+		output::Output *output = LayerRegistry<output::Output>::getInstance()->getObject(outputName);
+		if(output)
+		{
+			try
+			{
+				output->dump(session, _configuration);
+				exported.push_back(outputName);
+			}
+			catch(std::exception &e)
+			{
+				std::cerr << "Error: couldn't export to output " << outputName << ":" << e.what() << std::endl;
+			}
+		}
+		else
+		{
+			std::cout << "Output does not exist: " << outputName << std::endl;
+		}
+	}
+	return exported;
+}
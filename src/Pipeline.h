@@ -0,0 +1,68 @@
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "bom/Session.h"
+#include "Configuration.h"
+#include "OrderedTasks.h"
+#include "ThreadPool.h"
+
+// Applies the filters, then the outputs, to sessions on worker threads.
+// Sessions are added as soon as they are read from the device so that they are
+// filtered and exported while the next ones are retrieved.
+// Each session is a task whose messages are captured, then printed by finish() in
+// the order sessions were added (see OrderedTasks): the console output is the same
+// whatever the number of threads and the time taken to read the sessions.
+class Pipeline
+{
+	public:
+		/**
+		 * @param configuration configuration given to filters and outputs
+		 * @param filters names of the filters to apply, in order
+		 * @param outputs names of the outputs to produce
+		 * @param pool threads processing the sessions, which may be shared with the device decoding them
+		 */
+		Pipeline(const Configuration &configuration, const std::list<std::string> &filters, const std::list<std::string> &outputs, ThreadPool &pool);
+
+		Pipeline(const Pipeline&) = delete;
+		Pipeline& operator=(const Pipeline&) = delete;
+
+		/**
+		 * Queues a session. Sessions without points are ignored.
+		 * The session must not be used by the caller until finish() returns.
+		 */
+		void add(Session *session);
+		// Tells if a session was given to add()
+		bool contains(const Session *session) const;
+		/**
+		 * Outputs a session was exported to, valid once finish() returned.
+		 * Empty if the session has no points or if a filter failed on it.
+		 */
+		const std::list<std::string>& getExported(const Session *session) const;
+
+		/**
+		 * Waits for all the sessions to be processed and prints their messages.
+		 * @throw the exception thrown while processing a session, once the messages of the previous ones are printed
+		 */
+		void finish();
+
+		/**
+		 * Applies the filters, then the outputs, to a session in the current thread
+		 * @return the outputs the session was exported to: unknown and failed outputs are left out
+		 * @throw std::exception if a filter fails
+		 */
+		std::list<std::string> process(Session *session) const;
+
+	private:
+		const Configuration &_configuration;
+		std::list<std::string> _filters;
+		std::list<std::string> _outputs;
+		// Outputs each session added was exported to, filled in by the tasks
+		std::unordered_map<const Session*, std::list<std::string>> _exported;
+		// Declared last: its destructor waits for the sessions being processed, without printing their messages
+		OrderedTasks _tasks;
+};
+
+#endif
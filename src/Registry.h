@@ -35,8 +35,13 @@ class LayerRegistry
 				delete object;
 			}
 		}
-		// TODO: What if filter is not registered ?
-		LayerType *getObject(const std::string& objectName) { return _objects[objectName]; };
+		// Returns nullptr if no object is registered with this name. Never modifies the registry so
+		// that it can be called from several threads.
+		LayerType *getObject(const std::string& objectName)
+		{
+			auto it = _objects.find(objectName);
+			return it == _objects.end() ? nullptr : it->second;
+		}
 		std::map<std::string, LayerType*> &getObjects() { return _objects; };
 
 	private:
@@ -0,0 +1,114 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t nbThreads) : _nbQueued(0), _nbPending(0), _nextQueue(0), _stopping(false)
+{
+	if(nbThreads == 0)
+	{
+		nbThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for(size_t i = 0; i < nbThreads; ++i)
+	{
+		_queues.emplace_back(new Queue());
+	}
+	for(size_t i = 0; i < nbThreads; ++i)
+	{
+		_threads.emplace_back(&ThreadPool::run, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_taskAvailable.notify_all();
+	for(auto& thread : _threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		index = _nextQueue++ % _queues.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+		_queues[index]->tasks.push_back(std::move(task));
+	}
+	// The task is counted once in its queue: a thread that reserves it is sure to find it
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_nbQueued;
+		++_nbPending;
+	}
+	_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_allDone.wait(lock, [this] { return _nbPending == 0; });
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()> &task)
+{
+	{
+		Queue &own = *_queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if(!own.tasks.empty())
+		{
+			task = std::move(own.tasks.front());
+			own.tasks.pop_front();
+			return true;
+		}
+	}
+	for(size_t i = 1; i < _queues.size(); ++i)
+	{
+		Queue &victim = *_queues[(index + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if(!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.back());
+			victim.tasks.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::run(size_t index)
+{
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_taskAvailable.wait(lock, [this] { return _nbQueued > 0 || _stopping; });
+			if(_nbQueued == 0)
+			{
+				return;
+			}
+			// Reserves one of the queued tasks
+			--_nbQueued;
+		}
+		std::function<void()> task;
+		while(!takeTask(index, task))
+		{
+			// Never loops: tasks are counted after being queued and only taken after being reserved
+			std::this_thread::yield();
+		}
+		task();
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(--_nbPending == 0)
+		{
+			_allDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool of threads.
+// Each thread has its own queue of tasks: tasks are spread over the queues when
+// submitted and a thread with an empty queue steals tasks from the others.
+// A thread takes its own tasks in submission order (so that tasks submitted
+// first finish first) and steals from the end of the other queues.
+class ThreadPool
+{
+	public:
+		/**
+		 * @param nbThreads number of threads, 0 for one per core
+		 */
+		explicit ThreadPool(size_t nbThreads);
+		// Waits for all submitted tasks to be done
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		size_t size() const          { return _threads.size(); };
+
+		/**
+		 * Queues a task. Exceptions thrown by the task are not caught: the task must handle them.
+		 */
+		void submit(std::function<void()> task);
+		// Waits for all submitted tasks to be done
+		void wait();
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		bool takeTask(size_t index, std::function<void()> &task);
+		void run(size_t index);
+
+		std::vector<std::unique_ptr<Queue>> _queues;
+		std::vector<std::thread> _threads;
+		// Protects the counters below and is used to put idle threads to sleep
+		std::mutex _mutex;
+		std::condition_variable _taskAvailable;
+		std::condition_variable _allDone;
+		size_t _nbQueued;
+		size_t _nbPending;
+		size_t _nextQueue;
+		bool _stopping;
+};
+
+#endif
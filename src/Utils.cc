@@ -7,6 +7,7 @@
 #include <cmath>
 #include <cerrno>
 #include <cstdlib>
+#include <cstdio>
 #include <cstring>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -33,6 +34,175 @@ time_t mktime_utc(struct tm *tm)
 #endif
 }
 
+namespace
+{
+	// Writes a number on at least iWidth digits
+	char *writeNumber(char *oBuffer, uint32_t iValue, int iWidth)
+	{
+		char digits[10];
+		int nbDigits = 0;
+		do
+		{
+			digits[nbDigits++] = '0' + iValue % 10;
+			iValue /= 10;
+		}
+		while(iValue != 0);
+		for(int i = nbDigits; i < iWidth; ++i)
+		{
+			*oBuffer++ = '0';
+		}
+		while(nbDigits > 0)
+		{
+			*oBuffer++ = digits[--nbDigits];
+		}
+		return oBuffer;
+	}
+}
+
+TimeCodec::TimeCodec() : _parsedDay(-1), _parsedDayTime(0), _parsedMinute(-1), _parsedMinuteTime(0)
+{
+	// Empty ranges: the first time converted fills them
+	_utcDate.begin = _localDate.begin = 0;
+	_utcDate.length = _localDate.length = 0;
+	_utcDate.seconds = _localDate.seconds = 0;
+	_utcDate.size = _localDate.size = 0;
+}
+
+bool TimeCodec::readFields(const char *iText, size_t iSize, int *oFields)
+{
+	if(iSize < TIME_SIZE) return false;
+	// Positions of year, month, day, hour, minute and second in 2013-12-27T14:09:08Z
+	static const int positions[] = { 0, 5, 8, 11, 14, 17 };
+	static const int widths[] = { 4, 2, 2, 2, 2, 2 };
+	unsigned invalid = 0;
+	for(int field = 0; field < 6; ++field)
+	{
+		int value = 0;
+		for(int i = 0; i < widths[field]; ++i)
+		{
+			unsigned digit = (unsigned char) iText[positions[field] + i] - '0';
+			invalid |= digit > 9;
+			value = value * 10 + digit;
+		}
+		oFields[field] = value;
+	}
+	return invalid == 0;
+}
+
+bool TimeCodec::parse(const char *iText, size_t iSize, struct tm &oTime)
+{
+	int fields[6];
+	if(!readFields(iText, iSize, fields)) return false;
+	memset(&oTime, 0, sizeof(oTime));
+	// In tm, year is year since 1900 and month is between 0 and 11
+	oTime.tm_year = fields[0] - 1900;
+	oTime.tm_mon  = fields[1] - 1;
+	oTime.tm_mday = fields[2];
+	oTime.tm_hour = fields[3];
+	oTime.tm_min  = fields[4];
+	oTime.tm_sec  = fields[5];
+	oTime.tm_isdst = -1;
+	return true;
+}
+
+bool TimeCodec::parseUtc(const char *iText, size_t iSize, time_t &oTime)
+{
+	int fields[6];
+	if(!readFields(iText, iSize, fields)) return false;
+	long day = fields[0] * 10000L + fields[1] * 100 + fields[2];
+	if(day != _parsedDay)
+	{
+		tm time;
+		memset(&time, 0, sizeof(time));
+		time.tm_year = fields[0] - 1900;
+		time.tm_mon  = fields[1] - 1;
+		time.tm_mday = fields[2];
+		_parsedDayTime = mktime_utc(&time);
+		_parsedDay = day;
+	}
+	oTime = _parsedDayTime + fields[3] * 3600 + fields[4] * 60 + fields[5];
+	return true;
+}
+
+bool TimeCodec::parseLocal(const char *iText, size_t iSize, time_t &oTime)
+{
+	int fields[6];
+	if(!readFields(iText, iSize, fields)) return false;
+	long long minute = (fields[0] * 10000LL + fields[1] * 100 + fields[2]) * 10000 + fields[3] * 100 + fields[4];
+	if(minute != _parsedMinute)
+	{
+		tm time;
+		memset(&time, 0, sizeof(time));
+		time.tm_year = fields[0] - 1900;
+		time.tm_mon  = fields[1] - 1;
+		time.tm_mday = fields[2];
+		time.tm_hour = fields[3];
+		time.tm_min  = fields[4];
+		time.tm_isdst = -1;
+		_parsedMinuteTime = mktime(&time);
+		_parsedMinute = minute;
+	}
+	oTime = _parsedMinuteTime + fields[5];
+	return true;
+}
+
+char *TimeCodec::writeDateTime(time_t iTime, char *oBuffer, bool iHumanReadable, bool iLocal)
+{
+	DateCache &cache = iLocal ? _localDate : _utcDate;
+	if(iTime < cache.begin || iTime - cache.begin >= cache.length)
+	{
+		tm time;
+		if(iLocal)
+		{
+			localtime_r(&iTime, &time);
+		}
+		else
+		{
+			gmtime_r(&iTime, &time);
+		}
+		cache.size = snprintf(cache.date, sizeof(cache.date), "%d-%02d-%02d", time.tm_year + 1900, time.tm_mon + 1, time.tm_mday);
+		if(iLocal)
+		{
+			cache.begin = iTime - time.tm_sec;
+			cache.length = 60;
+			cache.seconds = time.tm_hour * 3600 + time.tm_min * 60;
+		}
+		else
+		{
+			cache.begin = iTime - (time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec);
+			cache.length = 86400;
+			cache.seconds = 0;
+		}
+	}
+	memcpy(oBuffer, cache.date, cache.size);
+	char *current = oBuffer + cache.size;
+	uint32_t seconds = cache.seconds + (uint32_t) (iTime - cache.begin);
+	*current++ = iHumanReadable ? ' ' : 'T';
+	current = writeNumber(current, seconds / 3600, 2);
+	*current++ = ':';
+	current = writeNumber(current, seconds / 60 % 60, 2);
+	*current++ = ':';
+	return writeNumber(current, seconds % 60, 2);
+}
+
+size_t TimeCodec::format(time_t iTime, char *oBuffer, bool iHumanReadable, bool iLocal)
+{
+	char *current = writeDateTime(iTime, oBuffer, iHumanReadable, iLocal);
+	if(!iHumanReadable) *current++ = 'Z';
+	*current = 0;
+	return current - oBuffer;
+}
+
+size_t TimeCodec::format(time_t iTime, uint32_t iMillis, char *oBuffer, bool iHumanReadable, bool iLocal)
+{
+	char *current = writeDateTime(iTime, oBuffer, iHumanReadable, iLocal);
+	*current++ = '.';
+	current = writeNumber(current, iMillis, 3);
+	if(!iHumanReadable) *current++ = 'Z';
+	*current = 0;
+	return current - oBuffer;
+}
+
 std::string Formatter::str() const
 {
 	return _stream.str();
@@ -187,6 +357,17 @@ uint32_t str_to_int(const std::string& intAsString)
 	return result;
 }
 
+uint64_t hashBytes(const void *data, size_t length, uint64_t hash)
+{
+	const unsigned char *bytes = static_cast<const unsigned char*>(data);
+	for(size_t i = 0; i < length; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 // Computes the distance, in meters, between two WGS-84 positions.
 // The result is equal to EARTH_RADIUS_IN_METERS*ArcInRadians(from,to)
 double distanceEarth(double lat1,double lon1,double lat2,double lon2)
@@ -198,3 +379,164 @@ double distanceEarth(const Point& p1, const Point& p2)
 {
 	return distanceEarth(p1.getLatitude(), p1.getLongitude(), p2.getLatitude(), p2.getLongitude());
 }
+
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+// AVX2/FMA version, only used when the CPU supports it (see selectHaversineKernel).
+// There is no SSE2 version: with two lanes and no FMA it is slower than the scalar libm functions.
+#define HAVERSINE_AVX2
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+typedef long long HaversineMask256 __attribute__((vector_size(32)));
+#define HAVERSINE_NAMESPACE haversine_avx2
+#define VEC __m256d
+#define VMASK HaversineMask256
+#define WIDTH 4
+#define VSET1(x) _mm256_set1_pd(x)
+#define VLOADU(p) _mm256_loadu_pd(p)
+#define VSTOREU(p, v) _mm256_storeu_pd(p, v)
+#define VSQRT(v) _mm256_sqrt_pd(v)
+#define VFMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#include "HaversineKernel.h"
+#undef HAVERSINE_NAMESPACE
+#undef VEC
+#undef VMASK
+#undef WIDTH
+#undef VSET1
+#undef VLOADU
+#undef VSTOREU
+#undef VSQRT
+#undef VFMA
+#pragma GCC pop_options
+#endif
+
+namespace
+{
+	typedef size_t (*HaversineKernel)(const double *lat, const double *lon, size_t nbSegments, double *result);
+
+	struct HaversineImplementation
+	{
+		HaversineKernel kernel;
+		const char *name;
+	};
+
+	HaversineImplementation selectHaversineKernel()
+	{
+#ifdef HAVERSINE_AVX2
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		{
+			return { haversine_avx2::distances, "avx2" };
+		}
+#endif
+		return { nullptr, "scalar" };
+	}
+
+	const HaversineImplementation& haversineImplementation()
+	{
+		static const HaversineImplementation implementation = selectHaversineKernel();
+		return implementation;
+	}
+}
+
+void distanceEarthBatch(const double *lat, const double *lon, size_t nbPoints, double *distances)
+{
+	if(nbPoints < 2)
+	{
+		return;
+	}
+	size_t nbSegments = nbPoints - 1;
+	size_t done = 0;
+	HaversineKernel kernel = haversineImplementation().kernel;
+	if(kernel != nullptr)
+	{
+		done = kernel(lat, lon, nbSegments, distances);
+	}
+	for(size_t i = done; i < nbSegments; ++i)
+	{
+		distances[i] = distanceEarth(lat[i], lon[i], lat[i+1], lon[i+1]);
+	}
+}
+
+const char* distanceEarthBatchImplementation()
+{
+	return haversineImplementation().name;
+}
+
+DistanceMethod parseDistanceMethod(const std::string& name)
+{
+	if(name.empty() || name == "haversine")
+	{
+		return DISTANCE_HAVERSINE;
+	}
+	if(name == "equirectangular")
+	{
+		return DISTANCE_EQUIRECTANGULAR;
+	}
+	THROW_STREAM("Unknown distance_method '" << name << "', expected haversine or equirectangular");
+}
+
+// With a latitude gap d (radians) from the reference, the second order expansion of cos(lat)
+// is off by less than tan(lat)*d^3/6 (relative): 4e-6 at 80 degrees. The projection on a plane
+// adds less than 1e-7 on segments shorter than 1 km. Checked by the distance benchmark.
+const double DistanceEngine::EQUIRECTANGULAR_MAX_RELATIVE_ERROR = 1e-5;
+const double DistanceEngine::EQUIRECTANGULAR_MAX_SEGMENT = 1000;
+const double DistanceEngine::EQUIRECTANGULAR_MAX_LATITUDE_GAP = 1;
+const double DistanceEngine::EQUIRECTANGULAR_MAX_LATITUDE = 80;
+
+DistanceEngine::DistanceEngine(DistanceMethod method, double referenceLatitude) :
+	_method(method), _referenceLatitude(referenceLatitude),
+	_cosReference(cos(referenceLatitude * DEG_TO_RAD)), _sinReference(sin(referenceLatitude * DEG_TO_RAD))
+{
+}
+
+bool DistanceEngine::equirectangular(double lat1, double lon1, double lat2, double lon2, double &result) const
+{
+	double middle = (lat1 + lat2) * 0.5;
+	double gap = middle - _referenceLatitude;
+	if(fabs(gap) > EQUIRECTANGULAR_MAX_LATITUDE_GAP || fabs(middle) > EQUIRECTANGULAR_MAX_LATITUDE)
+	{
+		return false;
+	}
+	gap *= DEG_TO_RAD;
+	double cosMiddle = _cosReference - gap * (_sinReference + gap * 0.5 * _cosReference);
+	double longitudeArc = lon1 - lon2;
+	if(longitudeArc > 180) longitudeArc -= 360;
+	if(longitudeArc < -180) longitudeArc += 360;
+	double x = longitudeArc * cosMiddle;
+	double y = lat1 - lat2;
+	result = EARTH_RADIUS_IN_METERS * DEG_TO_RAD * sqrt(x * x + y * y);
+	return result <= EQUIRECTANGULAR_MAX_SEGMENT;
+}
+
+double DistanceEngine::distance(double lat1, double lon1, double lat2, double lon2) const
+{
+	double result;
+	if(_method == DISTANCE_EQUIRECTANGULAR && equirectangular(lat1, lon1, lat2, lon2, result))
+	{
+		return result;
+	}
+	return distanceEarth(lat1, lon1, lat2, lon2);
+}
+
+double DistanceEngine::distance(const Point& p1, const Point& p2) const
+{
+	return distance(p1.getLatitude(), p1.getLongitude(), p2.getLatitude(), p2.getLongitude());
+}
+
+void DistanceEngine::distances(const double *lat, const double *lon, size_t nbPoints, double *result) const
+{
+	if(_method == DISTANCE_HAVERSINE)
+	{
+		distanceEarthBatch(lat, lon, nbPoints, result);
+		return;
+	}
+	for(size_t i = 0; i + 1 < nbPoints; ++i)
+	{
+		if(!equirectangular(lat[i], lon[i], lat[i+1], lon[i+1], result[i]))
+		{
+			result[i] = distanceEarth(lat[i], lon[i], lat[i+1], lon[i+1]);
+		}
+	}
+}
@@ -7,9 +7,9 @@
 #include <sstream>
 #include <memory>
 #include <cstdint>
+#include <ctime>
 
 #ifdef WINDOWS
-#include <ctime>
 #include <cstring>
 
 void localtime_r (const time_t *timer, struct tm *result);
@@ -18,6 +18,58 @@ void gmtime_r (const time_t *timer, struct tm *result);
 
 time_t mktime_utc(struct tm *tm);
 
+// Reads and writes ISO-8601 times of fixed width (2013-12-27T14:09:08Z) in buffers of the caller.
+// Only the first 19 characters of a time are read: fractions of second and time zone are ignored.
+// Converting a date is the costly part, so the last one is kept: consecutive times of a session
+// are converted with a few additions (per day for UTC, per minute for local times because of
+// daylight saving time). It is then meant to be used by a single thread.
+class TimeCodec
+{
+	public:
+		// Shortest time read: 2013-12-27T14:09:08Z
+		static const size_t TIME_SIZE = 20;
+		// Size of the buffer needed by format, whatever the time
+		static const size_t FORMAT_BUFFER_SIZE = 48;
+
+		TimeCodec();
+
+		// Reads the fields of a time. Returns false if it is too short or a digit is missing.
+		static bool parse(const char *iText, size_t iSize, struct tm &oTime);
+		// Reads a time in UTC, as mktime_utc does
+		bool parseUtc(const char *iText, size_t iSize, time_t &oTime);
+		// Reads a local time, as mktime does
+		bool parseLocal(const char *iText, size_t iSize, time_t &oTime);
+
+		// Writes 2013-12-27T14:09:08Z or, if human readable, 2013-12-27 14:09:08 followed by a NUL character.
+		// Returns the number of characters written, the NUL excluded.
+		size_t format(time_t iTime, char *oBuffer, bool iHumanReadable = false, bool iLocal = false);
+		// Same with milliseconds: 2013-12-27T14:09:08.250Z or 2013-12-27 14:09:08.250
+		size_t format(time_t iTime, uint32_t iMillis, char *oBuffer, bool iHumanReadable = false, bool iLocal = false);
+
+	private:
+		// Date of the times in [begin, begin + length[, written before their hour
+		struct DateCache
+		{
+			time_t begin;
+			time_t length;
+			// Seconds since midnight at begin
+			int seconds;
+			char date[24];
+			size_t size;
+		};
+
+		// Writes the date and the time, without the final Z
+		char *writeDateTime(time_t iTime, char *oBuffer, bool iHumanReadable, bool iLocal);
+		static bool readFields(const char *iText, size_t iSize, int *oFields);
+
+		DateCache _utcDate;
+		DateCache _localDate;
+		long _parsedDay;
+		time_t _parsedDayTime;
+		long long _parsedMinute;
+		time_t _parsedMinuteTime;
+};
+
 class Point;
 
 #define THROW_STREAM(stream) throw std::runtime_error(Formatter() << stream);  // NOLINT: parenthesis around 'stream' would prevent using << in THROW_STREAM
@@ -52,7 +104,71 @@ std::list<std::string> splitString(std::string toSplit, std::string separator =
 
 uint32_t str_to_int(const std::string& intAsString);
 
+// 64 bits FNV-1a hash of bytes: hashes of several buffers are chained by giving the previous one
+static const uint64_t HASH_BYTES_SEED = 14695981039346656037ULL;
+uint64_t hashBytes(const void *data, size_t length, uint64_t hash = HASH_BYTES_SEED);
+
 double distanceEarth(double lat1, double lon1, double lat2, double lon2);
 double distanceEarth(const Point& p1, const Point& p2);
 
+// Computes the lengths of the segments joining consecutive positions:
+// distances[i] is the distance between (lat[i], lon[i]) and (lat[i+1], lon[i+1]),
+// so nbPoints-1 values are written. Latitudes must be in [-90, 90].
+// Uses AVX2 when the CPU supports it: results then match distanceEarth within
+// DISTANCE_EARTH_BATCH_TOLERANCE (relative) plus 1e-9 meter, except for nearly
+// antipodal positions where the haversine formula itself is only accurate to
+// about one meter.
+void distanceEarthBatch(const double *lat, const double *lon, size_t nbPoints, double *distances);
+static const double DISTANCE_EARTH_BATCH_TOLERANCE = 1e-12;
+// Name of the implementation used by distanceEarthBatch: "avx2" or "scalar"
+const char* distanceEarthBatchImplementation();
+
+enum DistanceMethod
+{
+	DISTANCE_HAVERSINE,
+	DISTANCE_EQUIRECTANGULAR
+};
+
+// Converts the value of the configuration key distance_method ("haversine" or "equirectangular")
+DistanceMethod parseDistanceMethod(const std::string& name);
+
+// Computes distances between positions with a given method:
+//  - haversine: distanceEarth
+//  - equirectangular: positions are projected on a plane, longitudes being
+//    scaled by the cosine of the latitude. This cosine is expanded to the
+//    second order around a reference latitude (typically the middle of the
+//    session) so that no trigonometric function is evaluated per segment.
+//    Segments longer than EQUIRECTANGULAR_MAX_SEGMENT, further than
+//    EQUIRECTANGULAR_MAX_LATITUDE_GAP from the reference latitude or above
+//    EQUIRECTANGULAR_MAX_LATITUDE (where the error could exceed the bound) are
+//    computed with distanceEarth, so that the difference with distanceEarth
+//    never exceeds EQUIRECTANGULAR_MAX_RELATIVE_ERROR.
+class DistanceEngine
+{
+	public:
+		static const double EQUIRECTANGULAR_MAX_RELATIVE_ERROR;
+		static const double EQUIRECTANGULAR_MAX_SEGMENT;
+		static const double EQUIRECTANGULAR_MAX_LATITUDE_GAP;
+		static const double EQUIRECTANGULAR_MAX_LATITUDE;
+
+		explicit DistanceEngine(DistanceMethod method = DISTANCE_HAVERSINE, double referenceLatitude = 0);
+
+		DistanceMethod getMethod() const       { return _method; };
+		double getReferenceLatitude() const    { return _referenceLatitude; };
+
+		double distance(double lat1, double lon1, double lat2, double lon2) const;
+		double distance(const Point& p1, const Point& p2) const;
+		// Same as distanceEarthBatch, with the method of the engine
+		void distances(const double *lat, const double *lon, size_t nbPoints, double *result) const;
+
+	private:
+		// Returns false if the segment is out of the domain where the error bound holds
+		bool equirectangular(double lat1, double lon1, double lat2, double lon2, double &result) const;
+
+		DistanceMethod _method;
+		double _referenceLatitude;
+		double _cosReference;
+		double _sinReference;
+};
+
 #endif
@@ -0,0 +1,53 @@
+#include "Arena.h"
+#include <functional>
+
+const size_t Arena::DEFAULT_BLOCK_SIZE;
+
+Arena::Arena(size_t firstBlockSize) : _used(0), _nextBlockSize(firstBlockSize > 0 ? firstBlockSize : DEFAULT_BLOCK_SIZE)
+{
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+	if(!_blocks.empty())
+	{
+		Block &block = _blocks.back();
+		uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+		size_t offset = ((base + _used + alignment - 1) & ~(alignment - 1)) - base;
+		if(offset + size <= block.size)
+		{
+			_used = offset + size;
+			return block.data.get() + offset;
+		}
+	}
+	// Blocks are allocated with new[] so their beginning is suitably aligned for any fundamental type
+	addBlock(size);
+	_used = size;
+	return _blocks.back().data.get();
+}
+
+bool Arena::owns(const void *ptr) const
+{
+	std::less<const char*> before;
+	auto p = static_cast<const char*>(ptr);
+	for(const auto& block : _blocks)
+	{
+		if(!before(p, block.data.get()) && before(p, block.data.get() + block.size))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Arena::addBlock(size_t minSize)
+{
+	size_t size = _nextBlockSize;
+	while(size < minSize) size *= 2;
+	Block block;
+	block.data.reset(new char[size]);
+	block.size = size;
+	_blocks.push_back(std::move(block));
+	// Grow geometrically so that the number of blocks stays small when the size hint was wrong
+	_nextBlockSize = size * 2;
+}
@@ -0,0 +1,61 @@
+#ifndef _BOM_ARENA_H
+#define _BOM_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Bump allocator: objects are carved out of big blocks which are only freed
+// when the arena is destroyed. Objects are never destroyed individually, so
+// only trivially destructible types can be created in it.
+class Arena
+{
+	public:
+		explicit Arena(size_t firstBlockSize = DEFAULT_BLOCK_SIZE);
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		/**
+		 * Allocates raw memory
+		 * @param size number of bytes needed
+		 * @param alignment alignment required for the returned address
+		 */
+		void *allocate(size_t size, size_t alignment);
+
+		template<typename T, typename... Args>
+		T *create(Args&&... args)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "Arena never calls destructors");
+			return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		/**
+		 * Tells if a pointer was allocated by this arena
+		 * @param ptr the pointer to check
+		 */
+		bool owns(const void *ptr) const;
+
+		size_t getNbBlocks() const { return _blocks.size(); };
+
+		static const size_t DEFAULT_BLOCK_SIZE = 16384;
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<char[]> data;
+			size_t size;
+		};
+
+		void addBlock(size_t minSize);
+
+		std::vector<Block> _blocks;
+		size_t _used;
+		size_t _nextBlockSize;
+};
+
+#endif
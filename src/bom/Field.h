@@ -25,20 +25,6 @@ class Field
 		// Implicit conversion
 		operator T () const { return _value; };
 
-		// A function to be able to print a string containing the value only if field is defined
-		std::string toStream(const std::string& before = "", const std::string& after = "") const
-		{
-			if (_defined)
-			{
-				std::ostringstream oss;
-				oss.precision(8);
-				oss << before << _value << after;
-				return oss.str();
-			}
-			return "";
-		}
-		
-
 	private:
 		bool _defined;
 		T _value;
@@ -38,27 +38,18 @@ class Point
 		uint16_t getFiability() const               { return _fiability; };
 		bool isImportant() const                    { return _important; };
 		time_t getTime() const                      { return _time; };
+		uint32_t getMillis() const                  { return _millis; };
 		const Field<uint32_t> getDistance() const   { return _distance;}
-		// TODO: Is it really the right place ? We may want to do it with any time ! To move in a "utils" part
 		const std::string getTimeAsString(bool human_readable=false, bool local=false) const
 		{
-			char buffer[256];
-			tm time_tm;
-			if(local)
-			{
-				localtime_r(&_time, &time_tm);
-			}
-			else
-			{
-				gmtime_r(&_time, &time_tm);
-			}
-			std::stringstream format_string;
-			if(human_readable)
-				format_string << "%Y-%m-%d %H:%M:%S." << std::setw(3) << std::setfill('0') << _millis;
-			else
-				format_string << "%Y-%m-%dT%H:%M:%S." << std::setw(3) << std::setfill('0') << _millis << "Z";
-			strftime(buffer, 256, format_string.str().c_str(), &time_tm);
-			return std::string(buffer);
+			return formatTime(_time, _millis, human_readable, local);
+		};
+
+		static const std::string formatTime(time_t time, uint32_t millis, bool human_readable=false, bool local=false)
+		{
+			char buffer[TimeCodec::FORMAT_BUFFER_SIZE];
+			TimeCodec codec;
+			return std::string(buffer, codec.format(time, millis, buffer, human_readable, local));
 		};
 
 	private:
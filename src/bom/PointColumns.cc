@@ -0,0 +1,117 @@
+#include "PointColumns.h"
+#include "../Utils.h"
+#include <algorithm>
+
+PointColumns::PointColumns(const std::vector<Point*> &points, DistanceMethod distanceMethod)
+{
+	size_t nb = points.size();
+	_time.reserve(nb);
+	_millis.reserve(nb);
+	_lat.reserve(nb);
+	_lon.reserve(nb);
+	_alt.reserve(nb);
+	_speed.reserve(nb);
+	_bpm.reserve(nb);
+	_distance.reserve(nb);
+	_defined.reserve(nb);
+	for(const auto& point : points)
+	{
+		uint8_t defined = 0;
+		if(point->getLatitude().isDefined())   defined |= LATITUDE;
+		if(point->getLongitude().isDefined())  defined |= LONGITUDE;
+		if(point->getAltitude().isDefined())   defined |= ALTITUDE;
+		if(point->getSpeed().isDefined())      defined |= SPEED;
+		if(point->getHeartRate().isDefined())  defined |= HEARTRATE;
+		if(point->getDistance().isDefined())   defined |= DISTANCE;
+		_time.push_back(point->getTime());
+		_millis.push_back(point->getMillis());
+		_lat.push_back(point->getLatitude());
+		_lon.push_back(point->getLongitude());
+		_alt.push_back(point->getAltitude());
+		_speed.push_back(point->getSpeed());
+		_bpm.push_back(point->getHeartRate());
+		_distance.push_back(point->getDistance());
+		_defined.push_back(defined);
+	}
+
+	double minLatitude = 0;
+	double maxLatitude = 0;
+	bool first = true;
+	for(size_t i = 0; i < nb; ++i)
+	{
+		if(isDefined(i, LATITUDE))
+		{
+			minLatitude = first ? _lat[i] : std::min(minLatitude, _lat[i]);
+			maxLatitude = first ? _lat[i] : std::max(maxLatitude, _lat[i]);
+			first = false;
+		}
+	}
+	_distanceEngine = DistanceEngine(distanceMethod, (minLatitude + maxLatitude) / 2);
+}
+
+const std::vector<double>& PointColumns::getCumulativeDistances() const
+{
+	if(_cumulativeDistance.size() != size())
+	{
+		_cumulativeDistance.resize(size());
+		// Length of all segments in one pass (segments[i-1] joins points i-1 and i),
+		// the ones whose ends have no position are ignored below
+		std::vector<double> segments(size() > 1 ? size() - 1 : 0);
+		_distanceEngine.distances(_lat.data(), _lon.data(), size(), segments.data());
+		double total = 0;
+		for(size_t i = 0; i < size(); ++i)
+		{
+			if(isDefined(i, DISTANCE))
+			{
+				total = _distance[i];
+			}
+			else if(i > 0 && isDefined(i, POSITION) && isDefined(i-1, POSITION))
+			{
+				total += segments[i-1];
+			}
+			else if(i > 0 && isDefined(i, SPEED))
+			{
+				total += (_time[i] - _time[i-1]) * _speed[i] / 3.6;
+			}
+			_cumulativeDistance[i] = total;
+		}
+	}
+	return _cumulativeDistance;
+}
+
+const std::vector<double>& PointColumns::getElapsedSeconds() const
+{
+	if(_elapsed.size() != size())
+	{
+		_elapsed.resize(size());
+		for(size_t i = 0; i < size(); ++i)
+		{
+			_elapsed[i] = _time[i] - _time[0];
+		}
+	}
+	return _elapsed;
+}
+
+const std::vector<double>& PointColumns::getInstantSpeeds() const
+{
+	if(_instantSpeed.size() != size())
+	{
+		const std::vector<double> &distances = getCumulativeDistances();
+		_instantSpeed.resize(size());
+		double speed = 0;
+		for(size_t i = 0; i + 1 < size(); ++i)
+		{
+			time_t duration = _time[i+1] - _time[i];
+			if(duration > 0)
+			{
+				speed = (3.6 * (distances[i+1] - distances[i])) / duration;
+			}
+			_instantSpeed[i] = speed;
+		}
+		if(!empty())
+		{
+			_instantSpeed.back() = speed;
+		}
+	}
+	return _instantSpeed;
+}
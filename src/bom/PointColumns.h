@@ -0,0 +1,153 @@
+#ifndef _BOM_POINTCOLUMNS_H
+#define _BOM_POINTCOLUMNS_H
+
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include "../bom/Point.h"
+#include "../Utils.h"
+
+class PointColumns;
+
+// Lightweight read-only view on one point of a PointColumns.
+// Exposes the same getters as Point so that code scanning points can use
+// either of them, but values are read from the contiguous columns.
+class PointRef
+{
+	public:
+		PointRef(const PointColumns *columns, size_t index) : _columns(columns), _index(index) { };
+
+		Field<double> getLatitude() const;
+		Field<double> getLongitude() const;
+		Field<int16_t> getAltitude() const;
+		Field<double> getSpeed() const;
+		Field<uint16_t> getHeartRate() const;
+		Field<uint32_t> getDistance() const;
+		time_t getTime() const;
+		uint32_t getMillis() const;
+		const std::string getTimeAsString(bool human_readable=false, bool local=false) const
+		{
+			return Point::formatTime(getTime(), getMillis(), human_readable, local);
+		};
+
+		size_t getIndex() const { return _index; };
+
+	private:
+		const PointColumns *_columns;
+		size_t _index;
+};
+
+// Columnar (structure of arrays) copy of the points of a session.
+// Each channel is stored in its own contiguous array and a bitmap tells, for
+// each point, which of the optional channels are defined. This is what filters
+// and outputs scanning all the points of a session should read from.
+class PointColumns
+{
+	public:
+		enum DefinedBit
+		{
+			LATITUDE  = 1 << 0,
+			LONGITUDE = 1 << 1,
+			ALTITUDE  = 1 << 2,
+			SPEED     = 1 << 3,
+			HEARTRATE = 1 << 4,
+			DISTANCE  = 1 << 5,
+			POSITION  = LATITUDE | LONGITUDE
+		};
+
+		class const_iterator
+		{
+			public:
+				const_iterator(const PointColumns *columns, size_t index) : _columns(columns), _index(index) { };
+				PointRef operator*() const                           { return PointRef(_columns, _index); };
+				const_iterator& operator++()                         { ++_index; return *this; };
+				bool operator==(const const_iterator& other) const   { return _index == other._index; };
+				bool operator!=(const const_iterator& other) const   { return _index != other._index; };
+
+			private:
+				const PointColumns *_columns;
+				size_t _index;
+		};
+
+		/**
+		 * @param points the points of the session
+		 * @param distanceMethod method used to compute the length of segments. The reference latitude
+		 *        of the equirectangular method is the middle of the latitudes of the points.
+		 */
+		explicit PointColumns(const std::vector<Point*> &points, DistanceMethod distanceMethod = DISTANCE_HAVERSINE);
+
+		size_t size() const                       { return _time.size(); };
+		bool empty() const                        { return _time.empty(); };
+		PointRef operator[](size_t index) const   { return PointRef(this, index); };
+		const_iterator begin() const              { return const_iterator(this, 0); };
+		const_iterator end() const                { return const_iterator(this, size()); };
+
+		/**
+		 * Tells if all the channels given in mask are defined for a point
+		 * @param index index of the point
+		 * @param mask combination of DefinedBit
+		 */
+		bool isDefined(size_t index, uint8_t mask) const { return (_defined[index] & mask) == mask; };
+
+		const std::vector<time_t>& getTimes() const        { return _time; };
+		const std::vector<uint32_t>& getMillis() const     { return _millis; };
+		const std::vector<double>& getLatitudes() const    { return _lat; };
+		const std::vector<double>& getLongitudes() const   { return _lon; };
+		const std::vector<int16_t>& getAltitudes() const   { return _alt; };
+		const std::vector<double>& getSpeeds() const       { return _speed; };
+		const std::vector<uint16_t>& getHeartRates() const { return _bpm; };
+		const std::vector<uint32_t>& getDistances() const  { return _distance; };
+		const std::vector<uint8_t>& getDefined() const     { return _defined; };
+		const DistanceEngine& getDistanceEngine() const    { return _distanceEngine; };
+
+		// Derived channels: computed on first use, then shared by all filters and outputs
+
+		/**
+		 * Distance in meters from the first point. Uses the distance given by the watch when
+		 * defined, otherwise adds the length of the segment from the previous point (or the
+		 * distance travelled at the point speed when positions are missing).
+		 */
+		const std::vector<double>& getCumulativeDistances() const;
+		/**
+		 * Whole seconds elapsed since the first point
+		 */
+		const std::vector<double>& getElapsedSeconds() const;
+		/**
+		 * Speed in km/h on the segment starting at each point, computed from cumulative distances.
+		 * Last point (and points with no elapsed time since the previous one) get the previous speed.
+		 */
+		const std::vector<double>& getInstantSpeeds() const;
+
+	private:
+		std::vector<time_t>   _time;
+		std::vector<uint32_t> _millis;
+		std::vector<double>   _lat;
+		std::vector<double>   _lon;
+		std::vector<int16_t>  _alt;
+		std::vector<double>   _speed;
+		std::vector<uint16_t> _bpm;
+		std::vector<uint32_t> _distance;
+		std::vector<uint8_t>  _defined;
+		DistanceEngine        _distanceEngine;
+
+		mutable std::vector<double> _cumulativeDistance;
+		mutable std::vector<double> _elapsed;
+		mutable std::vector<double> _instantSpeed;
+};
+
+template<typename T>
+inline Field<T> columnField(bool defined, T value)
+{
+	return defined ? Field<T>(value) : Field<T>(FieldUndef);
+}
+
+inline Field<double> PointRef::getLatitude() const    { return columnField(_columns->isDefined(_index, PointColumns::LATITUDE), _columns->getLatitudes()[_index]); }
+inline Field<double> PointRef::getLongitude() const   { return columnField(_columns->isDefined(_index, PointColumns::LONGITUDE), _columns->getLongitudes()[_index]); }
+inline Field<int16_t> PointRef::getAltitude() const   { return columnField(_columns->isDefined(_index, PointColumns::ALTITUDE), _columns->getAltitudes()[_index]); }
+inline Field<double> PointRef::getSpeed() const       { return columnField(_columns->isDefined(_index, PointColumns::SPEED), _columns->getSpeeds()[_index]); }
+inline Field<uint16_t> PointRef::getHeartRate() const { return columnField(_columns->isDefined(_index, PointColumns::HEARTRATE), _columns->getHeartRates()[_index]); }
+inline Field<uint32_t> PointRef::getDistance() const  { return columnField(_columns->isDefined(_index, PointColumns::DISTANCE), _columns->getDistances()[_index]); }
+inline time_t PointRef::getTime() const               { return _columns->getTimes()[_index]; }
+inline uint32_t PointRef::getMillis() const           { return _columns->getMillis()[_index]; }
+
+#endif
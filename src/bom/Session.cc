@@ -1,6 +1,74 @@
 #include "Session.h"
 #include "../Utils.h"
 #include <iostream>
+#include <unordered_map>
+
+const size_t SessionId::MAX_SIZE;
+
+size_t Session::removePoints(const std::vector<bool> &toRemove)
+{
+	// Index of the point that replaces each point: itself if kept, otherwise the previous kept one
+	const size_t none = _points.size();
+	std::vector<size_t> translation(_points.size());
+	size_t lastKept = none;
+	size_t firstKept = none;
+	for(size_t i = 0; i < _points.size(); ++i)
+	{
+		if(!toRemove[i])
+		{
+			lastKept = i;
+			if(firstKept == none) firstKept = i;
+		}
+		translation[i] = lastKept;
+	}
+
+	// Rebind laps through the translation table: only lap boundaries need to be located in the points
+	std::unordered_map<const Point*, size_t> boundaries;
+	for(const auto& lap : _laps)
+	{
+		boundaries.emplace(lap->getStartPoint(), none);
+		boundaries.emplace(lap->getEndPoint(), none);
+	}
+	for(size_t i = 0; i < _points.size() && !boundaries.empty(); ++i)
+	{
+		auto found = boundaries.find(_points[i]);
+		if(found != boundaries.end())
+		{
+			found->second = i;
+		}
+	}
+	auto replacement = [&](size_t index) -> Point*
+	{
+		size_t kept = translation[index] == none ? firstKept : translation[index];
+		return kept == none ? nullptr : _points[kept];
+	};
+	for(auto& lap : _laps)
+	{
+		// Boundaries that are not points of the session are left unchanged
+		size_t start = boundaries[lap->getStartPoint()];
+		size_t end = boundaries[lap->getEndPoint()];
+		if(start != none) lap->setStartPoint(replacement(start));
+		if(end != none) lap->setEndPoint(replacement(end));
+	}
+
+	// Compact
+	size_t kept = 0;
+	for(size_t i = 0; i < _points.size(); ++i)
+	{
+		if(toRemove[i])
+		{
+			releasePoint(_points[i]);
+		}
+		else
+		{
+			_points[kept++] = _points[i];
+		}
+	}
+	size_t nbRemoved = _points.size() - kept;
+	_points.resize(kept);
+	invalidateColumns();
+	return nbRemoved;
+}
 
 void Session::getSummary(std::ostream& os) const
 {
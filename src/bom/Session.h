@@ -4,49 +4,136 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <memory>
 #include <cstdint>
 #include <ctime>
 #include <cstring>
+#include <algorithm>
+#include "../bom/Arena.h"
 #include "../bom/Lap.h"
 #include "../bom/Point.h"
+#include "../bom/SessionId.h"
+#include "../bom/PointColumns.h"
 #include "../Utils.h"
 
-typedef std::vector<char> SessionId;
-
 class Session
 {
 	public:
-		Session() : _id(0), _name("No name"), _num(0), _nb_points(0),
+		Session() : _id(), _name("No name"), _num(0), _nb_points(0),
 		            _duration(0), _distance(0), _max_speed(FieldUndef), _avg_speed(FieldUndef),
 			    _max_hr(FieldUndef), _avg_hr(FieldUndef), _calories(FieldUndef), _grams(FieldUndef),
-			    _ascent(FieldUndef), _descent(FieldUndef), _nb_laps(0)
+			    _ascent(FieldUndef), _descent(FieldUndef), _nb_laps(0), _fingerprint(0), _distanceMethod(DISTANCE_HAVERSINE), _columnsOutdated(false)
 		{ }
 
 		Session(SessionId id, uint32_t num, tm time, uint32_t nb_points, double duration, uint32_t distance, uint32_t nb_laps) :
 			         _id(std::move(id)), _name("No name"), _num(num), _local_time(time), _nb_points(nb_points),
 				 _duration(duration), _distance(distance), _max_speed(FieldUndef), _avg_speed(FieldUndef),
 				 _max_hr(FieldUndef), _avg_hr(FieldUndef), _calories(FieldUndef), _grams(FieldUndef),
-				 _ascent(FieldUndef), _descent(FieldUndef), _nb_laps(nb_laps)
+				 _ascent(FieldUndef), _descent(FieldUndef), _nb_laps(nb_laps), _fingerprint(0), _distanceMethod(DISTANCE_HAVERSINE), _columnsOutdated(false)
 		{
 			convertToGMT();
 		}
 
-		~Session()
+		// A session owns its points and laps: it can be moved but not copied
+		Session(const Session&) = delete;
+		Session& operator=(const Session&) = delete;
+		Session(Session&&) = default;
+
+		Session& operator=(Session&& other)
 		{
-			for(auto it = _points.begin(); it != _points.end(); ++it)
+			if(this != &other)
 			{
-				delete (*it);
+				releasePointsAndLaps();
+				Session moved(std::move(other));
+				swap(moved);
 			}
-			_points.clear();
-			for(auto it = _laps.begin(); it != _laps.end(); ++it)
+			return *this;
+		}
+
+		~Session()
+		{
+			releasePointsAndLaps();
+		}
+
+		void swap(Session& other)
+		{
+			std::swap(_id, other._id);
+			std::swap(_name, other._name);
+			std::swap(_num, other._num);
+			std::swap(_time, other._time);
+			std::swap(_local_time, other._local_time);
+			std::swap(_time_t, other._time_t);
+			std::swap(_nb_points, other._nb_points);
+			std::swap(_duration, other._duration);
+			std::swap(_distance, other._distance);
+			std::swap(_max_speed, other._max_speed);
+			std::swap(_avg_speed, other._avg_speed);
+			std::swap(_max_hr, other._max_hr);
+			std::swap(_avg_hr, other._avg_hr);
+			std::swap(_calories, other._calories);
+			std::swap(_grams, other._grams);
+			std::swap(_ascent, other._ascent);
+			std::swap(_descent, other._descent);
+			std::swap(_nb_laps, other._nb_laps);
+			std::swap(_fingerprint, other._fingerprint);
+			std::swap(_laps, other._laps);
+			std::swap(_points, other._points);
+			std::swap(_arena, other._arena);
+			std::swap(_distanceMethod, other._distanceMethod);
+			std::swap(_columns, other._columns);
+			std::swap(_columnsOutdated, other._columnsOutdated);
+		}
+
+		void addPoint(Point* point) { _points.push_back(point); invalidateColumns(); }
+		void addLap(Lap *lap)       { _laps.push_back(lap); }
+
+		/**
+		 * Creates a point in the memory owned by the session and adds it at the end of the session.
+		 * This is the way device parsers should create points: it avoids one allocation per point.
+		 * @param args arguments forwarded to Point constructor
+		 */
+		template<typename... Args>
+		Point *createPoint(Args&&... args)
+		{
+			Point *point = getArena().create<Point>(std::forward<Args>(args)...);
+			addPoint(point);
+			return point;
+		}
+
+		/**
+		 * Creates a lap in the memory owned by the session and adds it at the end of the session.
+		 * @param args arguments forwarded to Lap constructor
+		 */
+		template<typename... Args>
+		Lap *createLap(Args&&... args)
+		{
+			Lap *lap = getArena().create<Lap>(std::forward<Args>(args)...);
+			addLap(lap);
+			return lap;
+		}
+
+		/**
+		 * Frees a point that has been removed from the points of the session.
+		 * Points created with createPoint are only freed with the session.
+		 * @param point the point removed
+		 */
+		void releasePoint(Point *point)
+		{
+			if(!_arena || !_arena->owns(point))
 			{
-				delete (*it);
+				delete point;
 			}
-			_laps.clear();
 		}
 
-		void addPoint(Point* point) { _points.push_back(point); }
-		void addLap(Lap *lap)       { _laps.push_back(lap); }
+		/**
+		 * Removes and frees, in a single pass, the points marked for removal.
+		 * Laps starting or ending on a removed point are moved to the previous kept point
+		 * (or the first kept one when there is none before). When all points are removed,
+		 * lap boundaries are set to nullptr.
+		 * @param toRemove one flag per point, true for points to remove
+		 * @return the number of points removed
+		 */
+		size_t removePoints(const std::vector<bool> &toRemove);
 
 		void convertToGMT()
 		{
@@ -68,6 +155,8 @@ class Session
 		void setTimeT(time_t time)                 { _time_t = time; timesFromTimeT(); };
 		void setNbPoints(uint32_t nbPoints)        { _nb_points = nbPoints; };
 		void setNbLaps(uint32_t nbLaps)            { _nb_laps = nbLaps; };
+		// Identifies the content of the session, so that a session that changed on the device can be told apart (0 if unknown)
+		void setFingerprint(uint64_t fingerprint)  { _fingerprint = fingerprint; };
 
 		void setDuration(double duration)                 { _duration = duration; };
 		void setDistance(uint32_t distance)               { _distance = distance; };
@@ -96,9 +185,35 @@ class Session
 
 		std::vector<Lap*> &getLaps()                 { return _laps; };
 		const std::vector<Lap*> &getLaps() const     { return _laps; };
-		std::vector<Point*> &getPoints()             { return _points; };
+		// Non-const access may modify the points: columns will have to be rebuilt
+		std::vector<Point*> &getPoints()             { invalidateColumns(); return _points; };
 		const std::vector<Point*> &getPoints() const { return _points; };
 
+		/**
+		 * Columnar copy of the points, built on first use and rebuilt on next use after the points were modified.
+		 * The returned reference stays valid as long as the session exists.
+		 * Points modified through a pointer kept from an earlier getPoints() call are not tracked:
+		 * call invalidateColumns() after such modifications.
+		 */
+		const PointColumns &getColumns() const
+		{
+			if(!_columns)
+			{
+				_columns.reset(new PointColumns(_points, _distanceMethod));
+			}
+			else if(_columnsOutdated)
+			{
+				*_columns = PointColumns(_points, _distanceMethod);
+			}
+			_columnsOutdated = false;
+			return *_columns;
+		};
+		void invalidateColumns() const               { _columnsOutdated = true; };
+
+		// Method used for the length of segments in derived channels (see PointColumns::getDistanceEngine)
+		DistanceMethod getDistanceMethod() const     { return _distanceMethod; };
+		void setDistanceMethod(DistanceMethod method) { _distanceMethod = method; invalidateColumns(); };
+
 		// TODO: Check what is used, what is not, what should be added (like getLastPointTime() that would check if Point is empty) ...
 		const SessionId getId() const                  { return _id; };
 		const std::string getName() const              { return _name; };
@@ -122,36 +237,41 @@ class Session
 		const Field<uint32_t>& getDescent() const      { return _descent; };
 
 		uint32_t getNbLaps() const                     { return _nb_laps; };
+		uint32_t getNbPoints() const                   { return _nb_points; };
+		uint64_t getFingerprint() const                { return _fingerprint; };
 		time_t getTime() const                         { return _time_t; };
 
-		/* If watches doesn't set the distance for each point, we must try to compute them.
-		 * TODO: check against laps if computation is good enougth
-		 */
-		void ensurePointDistanceAreOk()
+	private:
+		void releasePointsAndLaps()
 		{
-			Point* previousPoint = nullptr;
-			double totalDistance = 0; // counter to avoid precision lost (because we round to meter in point::distance;
+			// Points and laps created by createPoint/createLap go away with the arena
 			for(auto it = _points.begin(); it != _points.end(); ++it)
 			{
-				Point* point = (*it);
-				if(!point->getDistance().isDefined())
+				releasePoint(*it);
+			}
+			_points.clear();
+			for(auto it = _laps.begin(); it != _laps.end(); ++it)
+			{
+				if(!_arena || !_arena->owns(*it))
 				{
-					if(previousPoint == nullptr)
-					{
-						point->setDistance(0); // First point: distance equal to zero
-					}
-					else
-					{
-						double distanceInMeter = distanceEarth(previousPoint->getLatitude(), previousPoint->getLongitude(), point->getLatitude(), point->getLongitude());
-						totalDistance = totalDistance + distanceInMeter;
-						point->setDistance(totalDistance);
-					}
+					delete (*it);
 				}
-				previousPoint = point;
 			}
+			_laps.clear();
+			invalidateColumns();
+		}
+
+		Arena &getArena()
+		{
+			if(!_arena)
+			{
+				// Sized from what the watch announced so that a whole session usually fits in a single block
+				size_t expectedSize = _nb_points * sizeof(Point) + _nb_laps * sizeof(Lap);
+				_arena.reset(new Arena(std::max(expectedSize, Arena::DEFAULT_BLOCK_SIZE)));
+			}
+			return *_arena;
 		}
 
-	private:
 		SessionId _id;
 		std::string _name;
 		uint32_t _num;
@@ -172,13 +292,17 @@ class Session
 		Field<uint32_t> _descent;
 
 		uint32_t _nb_laps;
+		uint64_t _fingerprint;
 		std::vector<Lap*> _laps;
 		std::vector<Point*> _points;
+		// Memory of the points and laps created with createPoint and createLap
+		std::unique_ptr<Arena> _arena;
+		DistanceMethod _distanceMethod;
+		// Kept on the heap so that references given by getColumns() survive a move of the session
+		mutable std::unique_ptr<PointColumns> _columns;
+		mutable bool _columnsOutdated;
 };
 
 std::ostream& operator<<(std::ostream& os, const Session& session);
 
-typedef std::map<SessionId, Session> SessionsMap;
-typedef std::pair<SessionId, Session> SessionsMapElement;
-
 #endif
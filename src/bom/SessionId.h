@@ -0,0 +1,83 @@
+#ifndef _BOM_SESSIONID_H
+#define _BOM_SESSIONID_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include "../Utils.h"
+
+// Identifier of a session as given by the device (raw bytes of the session
+// header for watches, filename prefix for file based devices).
+// Stored inline: copying, hashing and comparing it never allocates.
+class SessionId
+{
+	public:
+		static const size_t MAX_SIZE = 32;
+
+		SessionId() : _size(0), _data() { };
+
+		template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+		SessionId(InputIt first, InputIt last) : _size(0), _data()
+		{
+			for(; first != last; ++first)
+			{
+				push_back(*first);
+			}
+		};
+
+		SessionId(std::initializer_list<char> init) : SessionId(init.begin(), init.end()) { };
+
+		const char *begin() const             { return _data; };
+		const char *end() const               { return _data + _size; };
+		size_t size() const                   { return _size; };
+		bool empty() const                    { return _size == 0; };
+		char back() const                     { return _data[_size - 1]; };
+		char operator[](size_t index) const   { return _data[index]; };
+
+		bool operator==(const SessionId& other) const { return _size == other._size && memcmp(_data, other._data, _size) == 0; };
+		bool operator!=(const SessionId& other) const { return !(*this == other); };
+		bool operator<(const SessionId& other) const
+		{
+			int cmp = memcmp(_data, other._data, _size < other._size ? _size : other._size);
+			return cmp < 0 || (cmp == 0 && _size < other._size);
+		};
+
+		size_t hash() const
+		{
+			// FNV-1a
+			uint64_t h = 14695981039346656037ULL;
+			for(size_t i = 0; i < _size; ++i)
+			{
+				h ^= static_cast<unsigned char>(_data[i]);
+				h *= 1099511628211ULL;
+			}
+			return static_cast<size_t>(h);
+		};
+
+	private:
+		void push_back(char c)
+		{
+			if(_size >= MAX_SIZE)
+			{
+				THROW_STREAM("Session id longer than " << MAX_SIZE << " bytes");
+			}
+			_data[_size++] = c;
+		};
+
+		uint8_t _size;
+		char _data[MAX_SIZE];
+};
+
+namespace std
+{
+	template<>
+	struct hash<SessionId>
+	{
+		size_t operator()(const SessionId& id) const { return id.hash(); }
+	};
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include "SessionsMap.h"
+#include <iterator>
+#include <tuple>
+
+void SessionsMap::clear()
+{
+	_idIndex.clear();
+	_numIndex.clear();
+	_sessions.clear();
+	_numIndexOutdated = false;
+}
+
+std::pair<SessionsMap::iterator, bool> SessionsMap::emplace(const SessionId& id, Session&& session)
+{
+	auto found = _idIndex.find(id);
+	if(found != _idIndex.end())
+	{
+		return std::make_pair(found->second, false);
+	}
+	_sessions.emplace_back(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple(std::move(session)));
+	iterator it = std::prev(_sessions.end());
+	_idIndex.emplace(id, it);
+	_numIndexOutdated = true;
+	return std::make_pair(it, true);
+}
+
+SessionsMap::iterator SessionsMap::find(const SessionId& id)
+{
+	auto found = _idIndex.find(id);
+	return found == _idIndex.end() ? _sessions.end() : found->second;
+}
+
+SessionsMap::const_iterator SessionsMap::find(const SessionId& id) const
+{
+	auto found = _idIndex.find(id);
+	return found == _idIndex.end() ? _sessions.end() : const_iterator(found->second);
+}
+
+SessionsMap::iterator SessionsMap::findByNum(uint32_t num)
+{
+	if(_numIndexOutdated)
+	{
+		rebuildNumIndex();
+	}
+	auto found = _numIndex.find(num);
+	return found == _numIndex.end() ? _sessions.end() : found->second;
+}
+
+SessionsMap::iterator SessionsMap::erase(iterator it)
+{
+	_idIndex.erase(it->first);
+	_numIndexOutdated = true;
+	return _sessions.erase(it);
+}
+
+void SessionsMap::rebuildNumIndex()
+{
+	_numIndex.clear();
+	_numIndex.reserve(_sessions.size());
+	for(auto it = _sessions.begin(); it != _sessions.end(); ++it)
+	{
+		// emplace keeps the first session inserted with a given number
+		_numIndex.emplace(it->second.getNum(), it);
+	}
+	_numIndexOutdated = false;
+}
@@ -0,0 +1,63 @@
+#ifndef _BOM_SESSIONSMAP_H
+#define _BOM_SESSIONSMAP_H
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include "../bom/Session.h"
+
+// Sessions of a device, iterated in the order they were inserted (i.e. the
+// order in which the device listed them).
+// Lookups by id are done through a hash index. A secondary index by session
+// number is built on first use of findByNum.
+class SessionsMap
+{
+	public:
+		typedef std::pair<const SessionId, Session> value_type;
+		typedef std::list<value_type>::iterator iterator;
+		typedef std::list<value_type>::const_iterator const_iterator;
+
+		SessionsMap() : _numIndexOutdated(false) { };
+		SessionsMap(const SessionsMap&) = delete;
+		SessionsMap& operator=(const SessionsMap&) = delete;
+
+		iterator begin()              { return _sessions.begin(); };
+		iterator end()                { return _sessions.end(); };
+		const_iterator begin() const  { return _sessions.begin(); };
+		const_iterator end() const    { return _sessions.end(); };
+		size_t size() const           { return _sessions.size(); };
+		bool empty() const            { return _sessions.empty(); };
+		void clear();
+
+		/**
+		 * Adds a session if there is not already one with the same id
+		 * @param id the id of the session
+		 * @param session the session, moved into the container if inserted
+		 * @return the session with this id and whether it was inserted
+		 */
+		std::pair<iterator, bool> emplace(const SessionId& id, Session&& session);
+		std::pair<iterator, bool> insert(std::pair<SessionId, Session>&& element) { return emplace(element.first, std::move(element.second)); };
+
+		iterator find(const SessionId& id);
+		const_iterator find(const SessionId& id) const;
+
+		/**
+		 * Finds a session from its number (as displayed to the user).
+		 * If several sessions have the same number, the first inserted one is returned.
+		 * Session numbers must not be changed after insertion once this method has been used.
+		 * @param num the number of the session
+		 */
+		iterator findByNum(uint32_t num);
+
+		iterator erase(iterator it);
+
+	private:
+		void rebuildNumIndex();
+
+		std::list<value_type> _sessions;
+		std::unordered_map<SessionId, iterator> _idIndex;
+		std::unordered_map<uint32_t, iterator> _numIndex;
+		bool _numIndexOutdated;
+};
+
+#endif
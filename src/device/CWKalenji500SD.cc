@@ -329,8 +329,7 @@ namespace device
 			uint32_t distance = 0;
 			uint32_t nb_laps = line[13];
 
-			Session mySession(id, num, time, 0, duration, distance, nb_laps);
-			oSessions->insert(SessionsMapElement(id, mySession));
+			oSessions->emplace(id, Session(id, num, time, 0, duration, distance, nb_laps));
 		}
 	}
 
@@ -413,9 +412,8 @@ namespace device
 				total_distance += distance;
 				total_duration += duration;
 				offset += 16;
-				auto l = new Lap(0, 0, duration, distance, max_speed, 0, max_hr, avg_hr, 0, 0, 0, 0);
+				auto l = session.second.createLap(0, 0, duration, distance, max_speed, 0, max_hr, avg_hr, 0, 0, 0, 0);
 				l->setLapNum(i);
-				session.second.addLap(l);
 			}
 			session.second.setDistance(total_distance);
 			session.second.setDuration(total_duration);
@@ -441,8 +439,7 @@ namespace device
 				uint32_t hr = point[0];
 				double speed = (point[1] + 256.0*point[2]) / 100;
 
-				auto p = new Point(FieldUndef, FieldUndef, FieldUndef, speed, current_time + 5*nb_points, 0, hr, 3);
-				session.second.addPoint(p);
+				auto p = session.second.createPoint(FieldUndef, FieldUndef, FieldUndef, speed, current_time + 5*nb_points, 0, hr, 3);
 
 				if(nb_points == 0)
 				{
@@ -474,6 +471,7 @@ namespace device
 				nb_points++;
 			}
 			DEBUG_CMD(std::cout << std::endl << "End of points ..." << std::endl);
+			sessionCompleted(&(session.second));
 		}
 	}
 
@@ -0,0 +1,48 @@
+#include "Device.h"
+#include "../ImportLedger.h"
+#include "../OrderedTasks.h"
+#include "../Utils.h"
+
+#include <vector>
+
+namespace device
+{
+	void Device::setConfiguration(const Configuration &configuration)
+	{
+		_configuration = configuration;
+		_outputs = splitString(configuration.get("outputs"));
+	}
+
+	void Device::decodeSessions(SessionsMap *ioSessions, const std::function<void(Session*)> &decode)
+	{
+		std::vector<Session*> sessions;
+		// Destroyed first: its tasks are done before the sessions and decode go away
+		OrderedTasks tasks(getThreadPool());
+		for(auto& sessionPair : *ioSessions)
+		{
+			Session *session = &sessionPair.second;
+			sessions.push_back(session);
+			tasks.submit([session, &decode]() { decode(session); });
+		}
+		for(Session *session : sessions)
+		{
+			tasks.completeNext();
+			sessionCompleted(session);
+		}
+	}
+
+	ThreadPool& Device::getThreadPool()
+	{
+		if(_threadPool == nullptr)
+		{
+			_ownThreadPool.reset(new ThreadPool(_configuration.getJobs()));
+			_threadPool = _ownThreadPool.get();
+		}
+		return *_threadPool;
+	}
+
+	bool Device::isImported(const SessionId &id, uint64_t fingerprint)
+	{
+		return _importLedger != nullptr && _importLedger->isImported(getName(), id, fingerprint, _outputs);
+	}
+}
@@ -2,16 +2,23 @@
 #define _DEVICE_DEVICE_HPP_
 
 #include "../Registry.h"
+#include "../Configuration.h"
 #include "../source/Source.h"
-#include "../bom/Session.h"
+#include "../bom/SessionsMap.h"
+#include "../ThreadPool.h"
 
 #include <string>
+#include <list>
 #include <map>
+#include <functional>
+#include <memory>
 
 #define DECLARE_DEVICE(DeviceClass) static LayerRegistrer<Device, DeviceClass> _registrer;
 #define REGISTER_DEVICE(DeviceClass) LayerRegistrer<Device, DeviceClass> DeviceClass::_registrer;
 
-#define LOG_VERBOSE(x) if(_configuration["verbose"] == "true") { std::cout << __FILE__ << ":" << __LINE__ << ": " << x << std::endl; };  // NOLINT: parenthesis around 'x' would prevent using << in THROW_STREAM
+class ImportLedger;
+
+#define LOG_VERBOSE(x) if(_configuration.isVerbose()) { std::cout << __FILE__ << ":" << __LINE__ << ": " << x << std::endl; };  // NOLINT: parenthesis around 'x' would prevent using << in THROW_STREAM
 
 namespace device
 {
@@ -27,11 +34,32 @@ namespace device
 	class Device
 	{
 		public:
-			Device() : _dataSource(nullptr) {};
+			Device() : _dataSource(nullptr), _importLedger(nullptr), _threadPool(nullptr) {};
 			virtual ~Device() = default;
-			virtual void setConfiguration(std::map<std::string, std::string> configuration) {_configuration = configuration;}
+			virtual void setConfiguration(const Configuration &configuration);
 			virtual void setSource(source::Source *dataSource) { _dataSource = dataSource; };
 
+			/**
+			  Function called by getSessionsDetails with each session as soon as all its details are read,
+			  so that it can be filtered and exported while the next ones are retrieved. Devices that
+			  don't call it leave it to the caller to handle sessions once getSessionsDetails returns.
+			 */
+			typedef std::function<void(Session*)> SessionListener;
+			void setSessionListener(const SessionListener& listener) { _sessionListener = listener; };
+
+			/**
+			  Sessions already imported, given when only new sessions are imported so that devices able
+			  to fingerprint a session before reading it (like file based ones) can leave it out of the list.
+			 */
+			void setImportLedger(const ImportLedger *importLedger) { _importLedger = importLedger; };
+
+			/**
+			  Threads the device decodes sessions and parses files on, shared with the ones filtering and
+			  exporting the sessions it completes so that no more threads than jobs are busy. Devices
+			  without one create their own pool, with as many threads as the jobs of the configuration.
+			 */
+			void setThreadPool(ThreadPool *threadPool) { _threadPool = threadPool; };
+
 			/**
 			  Initialize the device. Any action that needs to be done before discussing with it.
 			 */
@@ -57,16 +85,50 @@ namespace device
 			/**
 			  Retrieve details of sessions passed in input/output map
 			  @param ioSessions The sessions to import, the function enrich it with details
+			  Sessions given to the session listener must not be modified afterwards.
 			 */
 			virtual void getSessionsDetails(SessionsMap *ioSessions) = 0;
 
+			/**
+			  Tells if the device only sends data on the IN end point after being asked to, so that reads
+			  can be submitted before the data is requested (see source::USB::setQueuedReads).
+			 */
+			virtual bool canQueueReads() { return false; };
+
 			virtual std::string getName() = 0;
 
 			virtual DeviceId getDeviceId() = 0;
 
 		protected:
-			std::map<std::string, std::string> _configuration;
+			// To be called once a session is complete: the device must not modify it anymore
+			void sessionCompleted(Session *session) { if(_sessionListener) _sessionListener(session); };
+
+			/**
+			  Decode sessions on the pool of threads of the device, for devices whose sessions are
+			  independent files. Each session is given to sessionCompleted once decoded,
+			  in the order of the map, with the messages written while decoding it, so that neither depends
+			  on the number of threads.
+			  @param decode Function filling a session with its details, called from the threads of the pool
+			  @throw the exception thrown while decoding a session, once the previous ones are completed
+			 */
+			void decodeSessions(SessionsMap *ioSessions, const std::function<void(Session*)> &decode);
+
+			// Pool given by setThreadPool, or the own pool of the device, created on first use
+			ThreadPool& getThreadPool();
+
+			// Tells if a session with this fingerprint was imported to all the outputs, false if there is no import ledger
+			bool isImported(const SessionId &id, uint64_t fingerprint);
+
+			Configuration _configuration;
+			// Outputs of the configuration, split once for all the sessions looked up in the import ledger
+			std::list<std::string> _outputs;
 			source::Source *_dataSource;
+			SessionListener _sessionListener;
+			const ImportLedger *_importLedger;
+
+		private:
+			ThreadPool *_threadPool;
+			std::unique_ptr<ThreadPool> _ownThreadPool;
 	};
 }
 
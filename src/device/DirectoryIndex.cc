@@ -0,0 +1,93 @@
+#include "DirectoryIndex.h"
+#include "../Utils.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifndef WINDOWS
+#include <fcntl.h>
+#endif
+
+namespace device
+{
+	DirectoryIndex::DirectoryIndex(const std::string &iPath, const std::vector<std::string> &iExtensions) : _extensions(iExtensions)
+	{
+		DIR *folder = opendir(iPath.c_str());
+		if(folder == nullptr)
+		{
+			THROW_STREAM("Couldn't open dir " << iPath);
+		}
+		struct dirent *entry = nullptr;
+		while((entry = readdir(folder)) != nullptr)
+		{
+			std::string name(entry->d_name);
+			size_t dot = name.find_last_of('.');
+			if(dot == std::string::npos) continue;
+			auto extension = std::find(_extensions.begin(), _extensions.end(), name.substr(dot));
+			if(extension == _extensions.end()) continue;
+
+			struct stat status;
+			#ifdef WINDOWS
+			int rc = stat((iPath + "/" + name).c_str(), &status);
+			#else
+			// Relative to the directory being read: the path isn't resolved again
+			int rc = fstatat(dirfd(folder), entry->d_name, &status, 0);
+			#endif
+			if(rc != 0 || !S_ISREG(status.st_mode)) continue;
+
+			std::vector<File> &files = _files[name.substr(0, dot)];
+			files.resize(_extensions.size());
+			File &file = files[extension - _extensions.begin()];
+			file.path = iPath + "/" + name;
+			file.size = status.st_size;
+			file.modificationTime = status.st_mtime;
+		}
+		closedir(folder);
+	}
+
+	std::vector<std::string> DirectoryIndex::getPrefixes() const
+	{
+		std::vector<std::string> prefixes;
+		prefixes.reserve(_files.size());
+		for(const auto& files : _files)
+		{
+			prefixes.push_back(files.first);
+		}
+		std::sort(prefixes.begin(), prefixes.end());
+		return prefixes;
+	}
+
+	bool DirectoryIndex::isComplete(const std::string &iPrefix) const
+	{
+		auto files = _files.find(iPrefix);
+		if(files == _files.end()) return false;
+		for(const File& file : files->second)
+		{
+			if(file.path.empty()) return false;
+		}
+		return true;
+	}
+
+	const DirectoryIndex::File* DirectoryIndex::find(const std::string &iPrefix, const std::string &iExtension) const
+	{
+		auto files = _files.find(iPrefix);
+		auto extension = std::find(_extensions.begin(), _extensions.end(), iExtension);
+		if(files == _files.end() || extension == _extensions.end()) return nullptr;
+		const File &file = files->second[extension - _extensions.begin()];
+		return file.path.empty() ? nullptr : &file;
+	}
+
+	uint64_t DirectoryIndex::getFingerprint(const std::string &iPrefix) const
+	{
+		uint64_t hash = hashBytes(iPrefix.data(), iPrefix.size());
+		auto files = _files.find(iPrefix);
+		if(files == _files.end()) return hash;
+		for(const File& file : files->second)
+		{
+			int64_t modificationTime = file.modificationTime;
+			hash = hashBytes(&file.size, sizeof(file.size), hash);
+			hash = hashBytes(&modificationTime, sizeof(modificationTime), hash);
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef _DEVICE_DIRECTORYINDEX_HPP_
+#define _DEVICE_DIRECTORYINDEX_HPP_
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace device
+{
+	/**
+	  The files of a device directory, listed once and grouped by name without extension (the prefix
+	  identifying a session on file-based devices). Only files with one of the given extensions are
+	  indexed, each one is stat'ed once: on FAT storage mounted over USB, a stat is expensive.
+	 */
+	class DirectoryIndex
+	{
+		public:
+			struct File
+			{
+				// Empty if there is no such file
+				std::string path;
+				uint64_t size;
+				time_t modificationTime;
+			};
+
+			/**
+			  @param iExtensions Extensions of the files to index, with their dot (".GHP"), case sensitive
+			  @throw std::runtime_error if the directory can't be read
+			 */
+			DirectoryIndex(const std::string &iPath, const std::vector<std::string> &iExtensions);
+
+			// Prefixes having at least one indexed file, sorted
+			std::vector<std::string> getPrefixes() const;
+			// Tells if a prefix has a file with each extension
+			bool isComplete(const std::string &iPrefix) const;
+			// File with a prefix and an extension, nullptr if there is none
+			const File* find(const std::string &iPrefix, const std::string &iExtension) const;
+			// Fingerprint of the files of a prefix, from their sizes and modification times (see Session::getFingerprint)
+			uint64_t getFingerprint(const std::string &iPrefix) const;
+
+		private:
+			std::vector<std::string> _extensions;
+			// Files of each prefix, in the order of _extensions
+			std::unordered_map<std::string, std::vector<File>> _files;
+	};
+}
+
+#endif
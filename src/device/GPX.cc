@@ -1,378 +1,349 @@
 #include "GPX.h"
+#include "GPXPointScanner.h"
+#include "XmlReader.h"
+#include "../OrderedTasks.h"
+#include "../source/File.h"
+#include <algorithm>
 #include <cstring>
+#include <memory>
+#include <vector>
+
+// Chunks of track points parsed in parallel are at least this long
+#define GPX_MIN_CHUNK_SIZE (1 << 20)
 
 namespace device
 {
 	REGISTER_DEVICE(GPX);
 
-	bool GPX::openDoc()
+	namespace
 	{
-		_document = xmlParseDoc(_docAsString);
-
-		if (_document == nullptr )
-		{
-			std::cerr << "Document not parsed successfully. \n" << _docAsString << std::endl;
-			return false;
-		}
-
-		_rootNode = xmlDocGetRootElement(_document);
-
-		if (_rootNode == nullptr)
-		{
-			std::cerr << "Empty document\n";
-			xmlFreeDoc(_document);
-			return false;
-		}
-
-		if (xmlStrcmp(_rootNode->name, (const xmlChar *) "gpx") != 0)
-		{
-			std::cerr << "Document of the wrong type, root node != gpx (" << _rootNode->name << ")" << std::endl;
-			xmlFreeDoc(_document);
-			return false;
-		}
-		return true;
+		// Times of consecutive points share their date
+		thread_local TimeCodec timeCodec;
 	}
 
-	void GPX::parseDoc(Session *oSession)
+	void GPX::parseDoc(Session *oSession, xmlTextReaderPtr iReader)
 	{
 		// Ignored data: attributes version and creator
-		xmlNodePtr cur = _rootNode->xmlChildrenNode;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "metadata") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "metadata") == 0)
 			{
-				parseMetadata(oSession, cur);
+				parseMetadata(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "trk") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "trk") == 0)
 			{
-				parseTrk(oSession, cur);
+				parseTrk(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "rte") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "rte") == 0)
 			{
-				parseTrkSegOrRoute(oSession, cur);
+				parseTrkSegOrRoute(oSession, iReader);
 			}
 			// TODO: The idea of a waypoint is to store a point of interest so it shouldn't be handled as rtePt or trkPt
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "wpt") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "wpt") == 0)
 			{
-				parseWayPoint(oSession, cur);
+				parseWayPoint(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "extensions") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "extensions") == 0)
 			{
-				parseExtensions(oSession, cur);
+				parseExtensions(oSession, iReader);
 			}
-			// Ignore text content of gpx node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void GPX::parseMetadata(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseMetadata(Session *oSession, xmlTextReaderPtr iReader)
 	{
 		// Ignored data: desc, author, copyright, link, keywords, bounds, extensions
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "name") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "name") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oSession->setName((const char*)data);
-				xmlFree(data);
+				oSession->setName(readXmlText(iReader));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "time") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "time") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				if(xmlStrlen(data) >= 20)
+				std::string data = readXmlText(iReader);
+				tm time;
+				if(TimeCodec::parse(data.data(), data.size(), time))
 				{
-					tm time;
-					memset(&time, 0, sizeof(time));
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time.tm_sec  = atoi((char*) data + 17);
-					time.tm_isdst = -1;
 					oSession->setTime(time);
 				}
 				else
 				{
-					std::cout << "Date is too short: '" << data << "'" << std::endl;
+					std::cout << "Invalid date: '" << data << "'" << std::endl;
 				}
-				xmlFree(data);
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in metadata not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in metadata not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void GPX::parseTrk(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseTrk(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "trkseg") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "trkseg") == 0)
 			{
-				parseTrkSegOrRoute(oSession, cur);
+				parseTrkSegOrRoute(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "name") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "name") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oSession->setName((const char*)data);
-				xmlFree(data);
+				oSession->setName(readXmlText(iReader));
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in trk not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in trk not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void GPX::parseTrkSegOrRoute(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseTrkSegOrRoute(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "trkpt") == 0 ||
-			    xmlStrcmp(cur->name, (const xmlChar *) "rtept") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "trkpt") == 0 ||
+			    xmlStrcmp(name, (const xmlChar *) "rtept") == 0)
 			{
-				parseWayPoint(oSession, cur);
+				parseWayPoint(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "name") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "name") == 0)
 			{
-				oSession->setName((char*)xmlNodeListGetString(_document, cur->xmlChildrenNode, 1));
+				oSession->setName(readXmlText(iReader));
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in trkSeg not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in trkSeg not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
 	// Handle all waypoints (same format for trkPt, rtePt, wayPt ...)
-	void GPX::parseWayPoint(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseWayPoint(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlChar *data;
-		auto aPoint = new Point();
-
-		data = xmlGetProp(rootNode, (xmlChar*)"lat");
-		aPoint->setLatitude(atof((char*)data));
-		xmlFree(data);
-
-		data = xmlGetProp(rootNode, (xmlChar*)"lon");
-		aPoint->setLongitude(atof((char*)data));
-		xmlFree(data);
-
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
+		auto aPoint = oSession->createPoint();
+		aPoint->setLatitude(readXmlAttribute(iReader, "lat"));
+		aPoint->setLongitude(readXmlAttribute(iReader, "lon"));
 
 		// TODO: missing speed
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "ele") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "ele") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				aPoint->setAltitude(atoi((char*) data));
-				xmlFree(data);
+				aPoint->setAltitude(atoi(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "time") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "time") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				if(xmlStrlen(data) >= 20)
+				std::string data = readXmlText(iReader);
+				time_t time;
+				if(timeCodec.parseLocal(data.data(), data.size(), time))
 				{
-					tm time_tm;
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time_tm.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time_tm.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time_tm.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time_tm.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time_tm.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time_tm.tm_sec  = atoi((char*) data + 17);
-					time_tm.tm_isdst = -1;
-					time_t time = mktime(&time_tm);
 					aPoint->setTime(time);
 				}
 				else
 				{
-					std::cout << "Date is too short in point: '" << data << "'" << std::endl;
+					std::cout << "Invalid date in point: '" << data << "'" << std::endl;
 				}
-				xmlFree(data);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "extensions") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "extensions") == 0)
 			{
-				parseWayPointExtensions(aPoint, cur);
+				parseWayPointExtensions(aPoint, iReader);
 			}
 			// Ignore comment but if a point have one, we consider it's an important point
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "cmt") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "cmt") == 0)
 			{
 				aPoint->setImportant(true);
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in point not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in point not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
-		oSession->addPoint(aPoint);
-		//std::cout << "Got a point for " << aPoint->getLatitude() << "," << aPoint->getLongitude() << " (" << aPoint->getAltitude() << ") " << aPoint->getHeartRate() << " bpm" << std::endl;
 	}
 
-	void GPX::parseWayPointExtensions(Point *oPoint, xmlNodePtr rootNode)
+	void GPX::parseWayPointExtensions(Point *oPoint, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-
 		// TODO: missing summary elements for which attribute must be checked to now the info contained
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "hr") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "hr") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setHeartRate(atoi((char*)data));
-				xmlFree(data);
+				oPoint->setHeartRate(atoi(readXmlText(iReader).c_str()));
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in trackPoint extensions not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in trackPoint extensions not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void GPX::parseExtensions(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseExtensions(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "lap") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "lap") == 0)
 			{
-				parseLap(oSession, cur);
+				parseLap(oSession, iReader);
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in extensions not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in extensions not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
 	}
 
 	// TODO: Store begin time. Find points from lap begin time and duration. Handle max and avg for hr and speed
-	void GPX::parseLap(Session *oSession, xmlNodePtr rootNode)
+	void GPX::parseLap(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlChar *data;
-		auto aLap = new Lap();
-
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
+		auto aLap = oSession->createLap();
 
 		// TODO: Handle start point / end point
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "index") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "index") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				aLap->setLapNum(atoi((char*) data));
-				xmlFree(data);
+				aLap->setLapNum(atoi(readXmlText(iReader).c_str()));
 			}
-			if (xmlStrcmp(cur->name, (const xmlChar *) "calories") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "calories") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				aLap->setCalories(atoi((char*) data));
-				xmlFree(data);
+				aLap->setCalories(atoi(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "distance") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "distance") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				aLap->setDistance(atoi((char*) data));
-				xmlFree(data);
+				aLap->setDistance(atoi(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "elapsedTime") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "elapsedTime") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				aLap->setDuration(atoi((char*) data));
-				xmlFree(data);
+				aLap->setDuration(atoi(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "startTime") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "startTime") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				if(xmlStrlen(data) >= 20)
-				{
-					/*
-					tm time_tm;
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time_tm.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time_tm.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time_tm.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time_tm.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time_tm.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time_tm.tm_sec  = atoi((char*) data + 17);
-					time_tm.tm_isdst = -1;
-					*/
-					// TODO: We need to use startTime to find start point ! Should be added to Point ?
-				}
-				else
+				std::string data = readXmlText(iReader);
+				if(data.size() < 20)
 				{
 					std::cout << "Date is too short in point: '" << data << "'" << std::endl;
 				}
-				xmlFree(data);
+				// TODO: We need to use startTime to find start point ! Should be added to Point ?
 			}
-			// Ignore text content of metadata node
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in lap not implemented in device::GPX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in lap not implemented in device::GPX");
 			}
-			cur = cur->next;
 		}
-		oSession->addLap(aLap);
 	}
 
-	void GPX::closeDoc()
+	bool GPX::parseTrackInParallel(Session *oSession)
 	{
-		xmlFreeDoc(_document);
+		// Chunks are scanned from the mapping of the file: other sources are read with libxml2 only
+		const source::File *file = dynamic_cast<const source::File*>(_dataSource);
+		if(file == nullptr || file->data() == nullptr || file->size() < GPX_FAST_PARSER_MIN_SIZE) return false;
+		const unsigned char *begin = file->data();
+		const unsigned char *end = begin + file->size();
+		const unsigned char *pointsBegin;
+		const unsigned char *pointsEnd;
+		if(!GPXPointScanner::locate(begin, end, &pointsBegin, &pointsEnd) || pointsEnd - pointsBegin < GPX_FAST_PARSER_MIN_SIZE) return false;
+
+		// The document without its track points: metadata, names and laps
+		XmlReader reader({ { begin, pointsBegin - begin }, { pointsEnd, end - pointsEnd } });
+		if(!reader.readRoot() || xmlStrcmp(xmlTextReaderConstLocalName(reader.get()), (const xmlChar *) "gpx") != 0) return false;
+		parseDoc(oSession, reader.get());
+		// Other points would have to be ordered with the ones of the track
+		if(reader.hasFailed() || !oSession->getPoints().empty()) return false;
+
+		// Chunks are scanned by the threads that filter and export sessions, which are idle while the file is read
+		ThreadPool &pool = getThreadPool();
+		size_t nbChunks = std::min(pool.size() * 4, (size_t)(pointsEnd - pointsBegin) / GPX_MIN_CHUNK_SIZE + 1);
+		std::vector<const unsigned char*> bounds = GPXPointScanner::split(pointsBegin, pointsEnd, nbChunks);
+		nbChunks = bounds.size() - 1;
+		std::vector<std::vector<Point>> points(nbChunks);
+		std::unique_ptr<bool[]> scanned(new bool[nbChunks]);
+		{
+			OrderedTasks tasks(pool);
+			for(size_t chunk = 0; chunk < nbChunks; ++chunk)
+			{
+				tasks.submit([&bounds, &points, &scanned, chunk]()
+				{
+					GPXPointScanner scanner;
+					scanned[chunk] = scanner.scan(bounds[chunk], bounds[chunk + 1], points[chunk]);
+				});
+			}
+			tasks.completeAll();
+		}
+		if(!std::all_of(scanned.get(), scanned.get() + nbChunks, [](bool ok) { return ok; })) return false;
+
+		// Chunks are added in the order of the file, and freed once copied to the session
+		for(std::vector<Point>& chunk : points)
+		{
+			for(const Point& point : chunk)
+			{
+				oSession->createPoint(point);
+			}
+			std::vector<Point>().swap(chunk);
+		}
+		LOG_VERBOSE("GPX: " << oSession->getPoints().size() << " track points read in " << nbChunks << " chunks");
+		return true;
 	}
 
 	void GPX::init(const DeviceId& deviceId)
 	{
 		_dataSource->init(deviceId.vendorId, deviceId.productId);
-		std::string fileContent;
-		unsigned char* line;
-		size_t length;
-		while(_dataSource->read_data(0x81, &line, &length))
-		{
-			fileContent.append((char*)line, length);
-		}
-		_docAsString = new xmlChar[fileContent.size()+2];
-		strncpy((char*)_docAsString, fileContent.c_str(), fileContent.size()+1);
 	}
 
 	void GPX::getSessionsList(SessionsMap *oSessions)
 	{
-		Session aSession;
-		if (openDoc())
+		if(_configuration.getBool("gpx_fast_parser", true))
+		{
+			Session session;
+			if(parseTrackInParallel(&session))
+			{
+				oSessions->emplace(SessionId(), std::move(session));
+				return;
+			}
+			LOG_VERBOSE("GPX: file not handled by the fast parser, parsing it with libxml2");
+		}
+
+		XmlReader reader(_dataSource);
+		if (!reader.readRoot())
+		{
+			std::cerr << (reader.hasFailed() ? "Document not parsed successfully." : "Empty document") << std::endl;
+			return;
+		}
+
+		const xmlChar *rootName = xmlTextReaderConstLocalName(reader.get());
+		if (xmlStrcmp(rootName, (const xmlChar *) "gpx") != 0)
+		{
+			std::cerr << "Document of the wrong type, root node != gpx (" << rootName << ")" << std::endl;
+			return;
+		}
+
+		auto session = oSessions->emplace(SessionId(), Session()).first;
+		parseDoc(&session->second, reader.get());
+		if (reader.hasFailed())
 		{
-			oSessions->insert(SessionsMapElement(aSession.getId(), aSession));
-			parseDoc(&(*oSessions)[aSession.getId()]);
-			// TODO: Understand why some cores appears when trying to free the document
-			//closeDoc();
+			// A document that isn't well formed gives no session, even if points were read before the error
+			std::cerr << "Document not parsed successfully." << std::endl;
+			oSessions->erase(session);
 		}
-		// TODO: else
 	}
 
 	void GPX::getSessionsDetails(SessionsMap *oSessions)
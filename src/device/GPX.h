@@ -2,12 +2,18 @@
 #define _DEVICE_GPX_HPP_
 
 #include "Device.h"
-#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+
+// Track points are read by the fast parser only when they take at least this size in the file:
+// smaller files are parsed faster by libxml2 alone than by a thread pool after a libxml2 pass on the header
+#define GPX_FAST_PARSER_MIN_SIZE (4 << 20)
 
 namespace device
 {
 	/**
 	  The interface for reading GPX files.
+	  The file is parsed as a stream: points go to the session as they are read, without building the whole document in memory.
+	  When the points of the file are a track that GPXPointScanner handles, they are read in parallel instead.
 	 */
 	class GPX : public Device
 	{
@@ -46,20 +52,23 @@ namespace device
 			DeviceId getDeviceId() override { return { 0x0, 0x0 }; };
 
 		private:
-			bool openDoc();
-			void parseDoc(Session *oSession);
-			void parseMetadata(Session *oSession, xmlNodePtr rootNode);
-			void parseTrk(Session *oSession, xmlNodePtr rootNode);
-			void parseTrkSegOrRoute(Session *oSession, xmlNodePtr rootNode);
-			void parseWayPoint(Session *oSession, xmlNodePtr rootNode);
-			void parseWayPointExtensions(Point *oPoint, xmlNodePtr rootNode);
-			void parseExtensions(Session *oSession, xmlNodePtr rootNode);
-			void parseLap(Session *oSession, xmlNodePtr rootNode);
-			void closeDoc();
+			// Each of them parses the current element of the reader and leaves it on the end of this element
+			void parseDoc(Session *oSession, xmlTextReaderPtr iReader);
+			void parseMetadata(Session *oSession, xmlTextReaderPtr iReader);
+			void parseTrk(Session *oSession, xmlTextReaderPtr iReader);
+			void parseTrkSegOrRoute(Session *oSession, xmlTextReaderPtr iReader);
+			void parseWayPoint(Session *oSession, xmlTextReaderPtr iReader);
+			void parseWayPointExtensions(Point *oPoint, xmlTextReaderPtr iReader);
+			void parseExtensions(Session *oSession, xmlTextReaderPtr iReader);
+			void parseLap(Session *oSession, xmlTextReaderPtr iReader);
 
-			xmlChar *_docAsString;
-			xmlDocPtr _document;
-			xmlNodePtr _rootNode;
+			/**
+			  Fast path for long tracks: the points of the track are read by GPXPointScanner, on the pool of
+			  threads of the device, and the rest of the document is parsed with libxml2.
+			  @return false if the file must be parsed with libxml2 only (track shorter than GPX_FAST_PARSER_MIN_SIZE
+			          or not handled by GPXPointScanner): oSession must be dropped
+			 */
+			bool parseTrackInParallel(Session *oSession);
 
 			DECLARE_DEVICE(GPX);
 	};
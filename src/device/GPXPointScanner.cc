@@ -0,0 +1,296 @@
+#include "GPXPointScanner.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace device
+{
+	namespace
+	{
+		const char POINT_START[] = "<trkpt";
+		const char POINT_END[] = "</trkpt>";
+		const size_t POINT_START_SIZE = sizeof(POINT_START) - 1;
+		const size_t POINT_END_SIZE = sizeof(POINT_END) - 1;
+
+		bool isSpace(unsigned char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		bool isNameEnd(unsigned char c)
+		{
+			return isSpace(c) || c == '>' || c == '/';
+		}
+
+		// Position of the next <trkpt tag, iEnd if there is none
+		const unsigned char *findPointStart(const unsigned char *iBegin, const unsigned char *iEnd)
+		{
+			const unsigned char *current = iBegin;
+			while(true)
+			{
+				current = std::search(current, iEnd, POINT_START, POINT_START + POINT_START_SIZE);
+				if(current == iEnd) return iEnd;
+				if(current + POINT_START_SIZE < iEnd && isNameEnd(current[POINT_START_SIZE])) return current;
+				++current;
+			}
+		}
+
+		// Text is followed by the '<' of its end tag: atoi stops there
+		int toInt(const std::pair<const unsigned char*, const unsigned char*> &iText)
+		{
+			return iText.first == iText.second ? 0 : atoi((const char*) iText.first);
+		}
+	}
+
+	bool GPXPointScanner::locate(const unsigned char *iBegin, const unsigned char *iEnd, const unsigned char **oPointsBegin, const unsigned char **oPointsEnd)
+	{
+		*oPointsBegin = findPointStart(iBegin, iEnd);
+		if((size_t)(iEnd - *oPointsBegin) < POINT_END_SIZE) return false;
+		// The end of the document is short: look for the last point from there
+		for(size_t offset = iEnd - *oPointsBegin - POINT_END_SIZE + 1; offset-- > 0;)
+		{
+			if(memcmp(*oPointsBegin + offset, POINT_END, POINT_END_SIZE) == 0)
+			{
+				*oPointsEnd = *oPointsBegin + offset + POINT_END_SIZE;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<const unsigned char*> GPXPointScanner::split(const unsigned char *iBegin, const unsigned char *iEnd, size_t iNbChunks)
+	{
+		std::vector<const unsigned char*> bounds(1, iBegin);
+		for(size_t chunk = 1; chunk < iNbChunks; ++chunk)
+		{
+			const unsigned char *bound = findPointStart(iBegin + (iEnd - iBegin) * chunk / iNbChunks, iEnd);
+			if(bound > bounds.back() && bound < iEnd) bounds.push_back(bound);
+		}
+		bounds.push_back(iEnd);
+		return bounds;
+	}
+
+	bool GPXPointScanner::scan(const unsigned char *iBegin, const unsigned char *iEnd, std::vector<Point> &oPoints)
+	{
+		_current = iBegin;
+		_end = iEnd;
+		while(true)
+		{
+			skipSpaces();
+			if(_current == _end) return true;
+			if(accept("</trkseg>"))
+			{
+				// Points of all segments go to the session one after the other
+				skipSpaces();
+				if(!accept("<trkseg>")) return false;
+			}
+			else if(!scanPoint(oPoints))
+			{
+				return false;
+			}
+		}
+	}
+
+	bool GPXPointScanner::scanPoint(std::vector<Point> &oPoints)
+	{
+		Range name;
+		Range attributes;
+		bool empty;
+		if(!readStartTag(name, attributes, empty)) return false;
+		if((size_t)(name.second - name.first) != POINT_START_SIZE - 1 || memcmp(name.first, POINT_START + 1, POINT_START_SIZE - 1) != 0) return false;
+
+		Point point;
+		double latitude;
+		double longitude;
+		if(!attribute(attributes, "lat", latitude) || !attribute(attributes, "lon", longitude)) return false;
+		point.setLatitude(latitude);
+		point.setLongitude(longitude);
+		while(!empty)
+		{
+			skipSpaces();
+			if(atEndTag())
+			{
+				if(!readEndTag(name)) return false;
+				break;
+			}
+			Range child;
+			Range childAttributes;
+			bool childEmpty;
+			Range text;
+			if(!readStartTag(child, childAttributes, childEmpty)) return false;
+			if(hasLocalName(child, "ele"))
+			{
+				if(!readText(child, childEmpty, text)) return false;
+				point.setAltitude(toInt(text));
+			}
+			else if(hasLocalName(child, "time"))
+			{
+				time_t time;
+				if(!readText(child, childEmpty, text) || !_timeCodec.parseLocal((const char*) text.first, text.second - text.first, time)) return false;
+				point.setTime(time);
+			}
+			else if(hasLocalName(child, "extensions"))
+			{
+				if(!childEmpty && !scanExtensions(point, child)) return false;
+			}
+			else
+			{
+				// A point with a comment is an important one
+				if(hasLocalName(child, "cmt")) point.setImportant(true);
+				if(!skipElement(child, childEmpty)) return false;
+			}
+		}
+		oPoints.push_back(point);
+		return true;
+	}
+
+	bool GPXPointScanner::scanExtensions(Point &oPoint, const Range &iName)
+	{
+		while(true)
+		{
+			skipSpaces();
+			if(atEndTag()) return readEndTag(iName);
+			Range child;
+			Range attributes;
+			bool empty;
+			if(!readStartTag(child, attributes, empty)) return false;
+			if(hasLocalName(child, "hr"))
+			{
+				Range text;
+				if(!readText(child, empty, text)) return false;
+				oPoint.setHeartRate(toInt(text));
+			}
+			else if(!skipElement(child, empty))
+			{
+				return false;
+			}
+		}
+	}
+
+	bool GPXPointScanner::readStartTag(Range &oName, Range &oAttributes, bool &oEmpty)
+	{
+		// Comments, CDATA, processing instructions and end tags aren't start tags
+		if(_end - _current < 2 || _current[0] != '<' || _current[1] == '/' || _current[1] == '!' || _current[1] == '?') return false;
+		const unsigned char *current = _current + 1;
+		oName.first = current;
+		while(current < _end && !isNameEnd(*current)) ++current;
+		oName.second = current;
+		oAttributes.first = current;
+		unsigned char quote = 0;
+		for(; current < _end; ++current)
+		{
+			if(quote != 0)
+			{
+				if(*current == quote) quote = 0;
+				// Entities would have to be replaced
+				else if(*current == '&' || *current == '<') return false;
+			}
+			else if(*current == '"' || *current == '\'')
+			{
+				quote = *current;
+			}
+			else if(*current == '>')
+			{
+				break;
+			}
+		}
+		if(current == _end || oName.first == oName.second) return false;
+		oEmpty = current[-1] == '/';
+		oAttributes.second = oEmpty ? current - 1 : current;
+		_current = current + 1;
+		return true;
+	}
+
+	bool GPXPointScanner::readEndTag(const Range &iName)
+	{
+		size_t length = iName.second - iName.first;
+		if(!accept("</") || (size_t)(_end - _current) < length || memcmp(_current, iName.first, length) != 0) return false;
+		_current += length;
+		skipSpaces();
+		return accept(">");
+	}
+
+	bool GPXPointScanner::readText(const Range &iName, bool iEmpty, Range &oText)
+	{
+		oText = Range(_current, _current);
+		if(iEmpty) return true;
+		const unsigned char *textEnd = static_cast<const unsigned char*>(memchr(_current, '<', _end - _current));
+		if(textEnd == nullptr || memchr(_current, '&', textEnd - _current) != nullptr) return false;
+		oText.second = textEnd;
+		_current = textEnd;
+		return readEndTag(iName);
+	}
+
+	bool GPXPointScanner::skipElement(const Range &iName, bool iEmpty)
+	{
+		if(iEmpty) return true;
+		_skipped.clear();
+		_skipped.push_back(iName);
+		while(!_skipped.empty())
+		{
+			const unsigned char *tag = static_cast<const unsigned char*>(memchr(_current, '<', _end - _current));
+			if(tag == nullptr) return false;
+			_current = tag;
+			if(atEndTag())
+			{
+				if(!readEndTag(_skipped.back())) return false;
+				_skipped.pop_back();
+				continue;
+			}
+			Range child;
+			Range attributes;
+			bool empty;
+			if(!readStartTag(child, attributes, empty)) return false;
+			if(!empty) _skipped.push_back(child);
+		}
+		return true;
+	}
+
+	void GPXPointScanner::skipSpaces()
+	{
+		while(_current < _end && isSpace(*_current)) ++_current;
+	}
+
+	bool GPXPointScanner::accept(const char *iText)
+	{
+		size_t length = strlen(iText);
+		if((size_t)(_end - _current) < length || memcmp(_current, iText, length) != 0) return false;
+		_current += length;
+		return true;
+	}
+
+	bool GPXPointScanner::attribute(const Range &iAttributes, const char *iName, double &oValue)
+	{
+		// Like libxml2, a missing attribute is read as 0
+		oValue = 0;
+		size_t length = strlen(iName);
+		const unsigned char *current = iAttributes.first;
+		while(true)
+		{
+			while(current < iAttributes.second && isSpace(*current)) ++current;
+			if(current == iAttributes.second) return true;
+			const unsigned char *name = current;
+			while(current < iAttributes.second && *current != '=' && !isSpace(*current)) ++current;
+			size_t nameLength = current - name;
+			while(current < iAttributes.second && isSpace(*current)) ++current;
+			if(current == iAttributes.second || *current++ != '=') return false;
+			while(current < iAttributes.second && isSpace(*current)) ++current;
+			if(current == iAttributes.second || (*current != '"' && *current != '\'')) return false;
+			unsigned char quote = *current++;
+			const unsigned char *value = current;
+			while(current < iAttributes.second && *current != quote) ++current;
+			if(current == iAttributes.second) return false;
+			// The value is followed by its quote: atof stops there
+			if(nameLength == length && memcmp(name, iName, length) == 0) oValue = atof((const char*) value);
+			++current;
+		}
+	}
+
+	bool GPXPointScanner::hasLocalName(const Range &iName, const char *iLocalName)
+	{
+		const unsigned char *localName = iName.second;
+		while(localName > iName.first && localName[-1] != ':') --localName;
+		size_t length = strlen(iLocalName);
+		return (size_t)(iName.second - localName) == length && memcmp(localName, iLocalName, length) == 0;
+	}
+}
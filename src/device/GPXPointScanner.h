@@ -0,0 +1,68 @@
+#ifndef _DEVICE_GPXPOINTSCANNER_HPP_
+#define _DEVICE_GPXPOINTSCANNER_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <utility>
+#include <vector>
+#include "../bom/Point.h"
+#include "../Utils.h"
+
+namespace device
+{
+	/**
+	  Reads the track points of a GPX file without libxml2, so that chunks of a long track can be read in parallel.
+	  Only what GPX::parseWayPoint reads is handled: lat and lon attributes, ele, time, hr in extensions and cmt,
+	  other elements of points are skipped. Anything else (comments, entities, other elements between points ...)
+	  makes scan() fail: the file must then be parsed with libxml2.
+	 */
+	class GPXPointScanner
+	{
+		public:
+			GPXPointScanner() : _current(nullptr), _end(nullptr) {};
+
+			/**
+			  Find the track points of a document: from the first <trkpt to the end of the last </trkpt>
+			  @return false if there is no track point
+			 */
+			static bool locate(const unsigned char *iBegin, const unsigned char *iEnd, const unsigned char **oPointsBegin, const unsigned char **oPointsEnd);
+
+			/**
+			  Split track points in about iNbChunks chunks, each one starting with <trkpt
+			  @return The boundaries of the chunks, iBegin and iEnd included
+			 */
+			static std::vector<const unsigned char*> split(const unsigned char *iBegin, const unsigned char *iEnd, size_t iNbChunks);
+
+			/**
+			  Read the track points of a chunk. They may be separated by the end of a trkseg and the start of the next one.
+			  @param oPoints The points read are added to it
+			  @return false if the chunk contains anything that isn't handled
+			 */
+			bool scan(const unsigned char *iBegin, const unsigned char *iEnd, std::vector<Point> &oPoints);
+
+		private:
+			typedef std::pair<const unsigned char*, const unsigned char*> Range;
+
+			bool scanPoint(std::vector<Point> &oPoints);
+			bool scanExtensions(Point &oPoint, const Range &iName);
+			bool readStartTag(Range &oName, Range &oAttributes, bool &oEmpty);
+			bool readEndTag(const Range &iName);
+			bool readText(const Range &iName, bool iEmpty, Range &oText);
+			bool skipElement(const Range &iName, bool iEmpty);
+			void skipSpaces();
+			bool accept(const char *iText);
+			bool atEndTag() const { return _end - _current >= 2 && _current[0] == '<' && _current[1] == '/'; };
+
+			// Value of an attribute as a number, 0 if it is missing. Returns false if attributes aren't well formed.
+			static bool attribute(const Range &iAttributes, const char *iName, double &oValue);
+			static bool hasLocalName(const Range &iName, const char *iLocalName);
+
+			const unsigned char *_current;
+			const unsigned char *_end;
+			// Open elements while skipping one, kept to avoid allocating for each point
+			std::vector<Range> _skipped;
+			TimeCodec _timeCodec;
+	};
+}
+
+#endif
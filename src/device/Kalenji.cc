@@ -1,5 +1,6 @@
 #include "Kalenji.h"
 #include "../Utils.h"
+#include "MoreDataReader.h"
 #include <cstring>
 #include <iomanip>
 #include <cmath>
@@ -111,7 +112,7 @@ namespace device
 				nb_laps = line[6];
 			}
 
-			Session mySession(id, num, time, nb_points, duration, distance, nb_laps);
+			Session &mySession = oSessions->emplace(id, Session(id, num, time, nb_points, duration, distance, nb_laps)).first->second;
 			if(type == Keymaze700Trail)
 			{
 				double max_speed = (line[19] + (line[20] << 8)) / 100.0;
@@ -129,7 +130,6 @@ namespace device
 				mySession.setAvgHr(avgHR);
 				mySession.setMaxHr(maxHR);
 			}
-			oSessions->insert(SessionsMapElement(id, mySession));
 			LOG_VERBOSE("Kalenji::getSessionsList() session: " << mySession);
 		}
 	}
@@ -167,6 +167,11 @@ namespace device
 		// TODO: Use only one session pointer, one session ID and one find. Only check it's the same at all step to be sure
 		size_t received = 0;
 		unsigned char *responseData;
+		MoreDataReader reader([this](unsigned char **oData, size_t *oLength) { return _dataSource->read_data(0x81, oData, oLength); },
+			[this]() { _dataSource->write_data(0x03, dataMore, lengthDataMore); },
+			_configuration.getUInt("prefetch_depth"));
+		// Calories of the laps of the session read so far
+		uint32_t sum_calories = 0;
 		do
 		{
 			// First response 80 retrieves info concerning the session
@@ -174,7 +179,7 @@ namespace device
 			if(type != Keymaze700Trail)
 			{
 				// TODO: Use more info from this first call (some data global to the session: calories, grams, ascent, descent ...)
-				_dataSource->read_data(0x81, &responseData, &received);
+				reader.next(&responseData, &received);
 				if(responseData[0] == 0x8A) break;
 				if(responseData[0] != 0x80)
 				{
@@ -200,11 +205,10 @@ namespace device
 				uint32_t descent = responseData[72] + (responseData[73] << 8);
 				session->setAscent(ascent);
 				session->setDescent(descent);
-				_dataSource->write_data(0x03, dataMore, lengthDataMore);
 			}
 
 			// Second response 80 retrieves info concerning the laps of the session.
-			_dataSource->read_data(0x81, &responseData, &received);
+			reader.next(&responseData, &received);
 			do
 			{
 				if(responseData[0] == 0x8A) break;
@@ -244,7 +248,6 @@ namespace device
 				for(size_t i = 0; i < nbRecords; ++i)
 				{ // Decoding and addition of the lap
 					unsigned char *line = &responseData[sizeLap*i + sizeRecord+3];
-					static uint32_t sum_calories = 0;
 					// time_t lap_end = lap_start + (line[0] + (line[1] << 8) + (line[2] << 16) + (line[3] << 24)) / 10;
 					double duration = (line[4] + (line[5] << 8) + (line[6] << 16) + (line[7] << 24)) / 10.0;
 					// last_lap_end = lap_end;
@@ -309,12 +312,10 @@ namespace device
 						firstPoint = line[26] + (line[27] << 8);
 						lastPoint = line[28] + (line[29] << 8);
 					}
-					auto lap = new Lap(firstPoint, lastPoint, duration, length, max_speed, avg_speed, max_hr, avg_hr, calories, grams, descent, ascent);
+					auto lap = session->createLap(firstPoint, lastPoint, duration, length, max_speed, avg_speed, max_hr, avg_hr, calories, grams, descent, ascent);
 					lap->setLapNum(i);
-					session->addLap(lap);
 				}
-				_dataSource->write_data(0x03, dataMore, lengthDataMore);
-				_dataSource->read_data(0x81, &responseData, &received);
+				reader.next(&responseData, &received);
 			} while(responseData[25] == 0xaa);
 
 			// Third response 80 retrieves info concerning the points of the session. There can be many.
@@ -393,8 +394,7 @@ namespace device
 							current_time += cumulated_tenth / 100;
 							cumulated_tenth = cumulated_tenth % 100;
 						}
-						auto point = new Point(lat, lon, alt, speed, current_time, cumulated_tenth*100, bpm, fiability);
-						session->addPoint(point);
+						session->createPoint(lat, lon, alt, speed, current_time, cumulated_tenth*100, bpm, fiability);
 					}
 					if(lap != session->getLaps().end() && id_point == (*lap)->getFirstPointId())
 					{
@@ -421,17 +421,18 @@ namespace device
 				keep_going = !session->isComplete();
 				if(keep_going)
 				{
-					_dataSource->write_data(0x03, dataMore, lengthDataMore);
-					if (!_dataSource->read_data(0x81, &responseData, &received)) {
+					if (!reader.next(&responseData, &received)) {
 						std::cerr << "ERROR: Couldn't read more data !" << std::endl;
 						break;
 					}
 				}
 			}
-			if(session) std::cout << "Retrieved session from " << session->getBeginTime() << std::endl;
+			if(session)
+			{
+				std::cout << "Retrieved session from " << session->getBeginTime() << std::endl;
+				if(session->isComplete()) sessionCompleted(session);
+			}
 			if(responseData[0] == 0x8A) break;
-
-			_dataSource->write_data(0x03, dataMore, lengthDataMore);
 		}
 		// Redundant with all the if / break above !
 		while(responseData[0] != 0x8A);
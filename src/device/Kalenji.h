@@ -43,6 +43,7 @@ namespace device
 			 */
 			void getSessionsDetails(SessionsMap *oSessions) override;
 
+			bool canQueueReads() override { return true; };
 			std::string getName() override { return "Kalenji"; };
 			DeviceId getDeviceId() override { return { 0x0483, 0x5740 }; };
 
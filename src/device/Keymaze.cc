@@ -1,4 +1,5 @@
 #include "Keymaze.h"
+#include "MoreDataReader.h"
 #include <cstring>
 #include <iomanip>
 
@@ -230,8 +231,7 @@ namespace device
 				 */
 			uint32_t nb_points = (line[25] << 8) + line[26];
 
-			Session mySession(id, num, time, nb_points, duration, distance, nb_laps);
-			oSessions->insert(SessionsMapElement(id, mySession));
+			oSessions->emplace(id, Session(id, num, time, nb_points, duration, distance, nb_laps));
 		}
 	}
 
@@ -269,7 +269,10 @@ namespace device
 		// TODO: Use only one session pointer, one session ID and one find. Only check it's the same at all step to be sure
 		size_t received = 0;
 		unsigned char *responseData;
-		readMessage(&responseData, &received);
+		MoreDataReader reader([this](unsigned char **oData, size_t *oLength) { readMessage(oData, oLength); return true; },
+			[this]() { _dataSource->write_data(0x02, dataMore, lengthDataMore); },
+			_configuration.getUInt("prefetch_depth"));
+		reader.next(&responseData, &received);
 		do
 		{
 			// First response 80 retrieves info concerning the laps of the session.
@@ -318,13 +321,11 @@ namespace device
 						uint32_t avg_hr = line[17];
 						uint32_t firstPoint = (line[18] << 8)  + line[19];
 						uint32_t lastPoint = (line[20] << 8) + line[21];
-						auto lap = new Lap(firstPoint, lastPoint, duration, length, FieldUndef, FieldUndef, max_hr, avg_hr, calories, FieldUndef, FieldUndef, FieldUndef);
+						auto lap = session->createLap(firstPoint, lastPoint, duration, length, FieldUndef, FieldUndef, max_hr, avg_hr, calories, FieldUndef, FieldUndef, FieldUndef);
 						lap->setLapNum(i);
-						session->addLap(lap);
 					}
 				}
-				_dataSource->write_data(0x02, dataMore, lengthDataMore);
-				readMessage(&responseData, &received);
+				reader.next(&responseData, &received);
 				// TODO: Find a good condition to end the loop
 			} while(responseData[30] == 0xff && responseData[31] == 0xff && responseData[32] == 0xff && responseData[33] == 0xff);
 
@@ -388,8 +389,7 @@ namespace device
 							cumulated_tenth += line[14];
 							current_time += cumulated_tenth / 10;
 							cumulated_tenth = cumulated_tenth % 10;
-							auto point = new Point(lat, lon, alt, speed, current_time, cumulated_tenth*100, bpm, 3);
-							session->addPoint(point);
+							session->createPoint(lat, lon, alt, speed, current_time, cumulated_tenth*100, bpm, 3);
 						}
 						if(lap != session->getLaps().end() && id_point == (*lap)->getFirstPointId())
 						{
@@ -415,17 +415,18 @@ namespace device
 					}
 				}
 				keep_going = session == nullptr || !session->isComplete();
-				_dataSource->write_data(0x02, dataMore, lengthDataMore);
-				readMessage(&responseData, &received);
+				reader.next(&responseData, &received);
 			}
 			if(session != nullptr)
 			{
 				std::cout << "Retrieved session from " << session->getBeginTime() << std::endl;
+				if(session->isComplete()) sessionCompleted(session);
 			}
 			if(responseData[0] == 0x8A) break;
 		}
 		// Redundant with all the if / break above !
 		while(responseData[0] != 0x8A);
+		reader.close();
 		unsigned char data[256] = { 0, 0xE1, 0, 0, 0, 0, 0x8 };
 		DEBUG_CMD(std::cout << "Keymaze::getSessionsDetails() - class interface 1" << std::endl);
 		_dataSource->control_transfer(0x21, 0x22, 0x0000, 0x0, data, 0x0);
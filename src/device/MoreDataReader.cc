@@ -0,0 +1,105 @@
+#include "MoreDataReader.h"
+
+namespace device
+{
+	const unsigned char MoreDataReader::END_MARKER;
+
+	MoreDataReader::MoreDataReader(ReadResponse iReadResponse, RequestMore iRequestMore, size_t iDepth) :
+		_readResponse(std::move(iReadResponse)), _requestMore(std::move(iRequestMore)), _depth(iDepth),
+		_started(false), _ended(false), _finished(false), _stopped(false)
+	{
+		if(_depth > 0)
+		{
+			_thread = std::thread(&MoreDataReader::readResponses, this);
+		}
+	}
+
+	void MoreDataReader::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopped = true;
+		}
+		_spaceAvailable.notify_one();
+		if(_thread.joinable()) _thread.join();
+	}
+
+	bool MoreDataReader::isLast(bool iRead, const unsigned char *iData, size_t iLength)
+	{
+		return !iRead || (iLength > 0 && iData[0] == END_MARKER);
+	}
+
+	bool MoreDataReader::next(unsigned char **oData, size_t *oLength)
+	{
+		if(_depth == 0)
+		{
+			if(_ended) return false;
+			if(_started) _requestMore();
+			_started = true;
+			bool read = _readResponse(oData, oLength);
+			_ended = isLast(read, *oData, *oLength);
+			return read;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_responseAvailable.wait(lock, [this] { return !_responses.empty() || _finished; });
+		if(_responses.empty())
+		{
+			if(_error) std::rethrow_exception(_error);
+			return false;
+		}
+		Response response = std::move(_responses.front());
+		_responses.pop_front();
+		lock.unlock();
+		_spaceAvailable.notify_one();
+
+		if(response.hasData)
+		{
+			_current = std::move(response.data);
+			*oData = _current.data();
+			*oLength = _current.size();
+		}
+		return response.read;
+	}
+
+	void MoreDataReader::readResponses()
+	{
+		try
+		{
+			bool last = false;
+			while(!last)
+			{
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_spaceAvailable.wait(lock, [this] { return _stopped || _responses.size() < _depth; });
+					if(_stopped) break;
+				}
+				unsigned char *data = nullptr;
+				size_t length = 0;
+				Response response;
+				response.read = _readResponse(&data, &length);
+				// A source may give data even when it fails, like File for its last line
+				response.hasData = data != nullptr;
+				if(response.hasData) response.data.assign(data, data + length);
+				last = isLast(response.read, data, length);
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_responses.push_back(std::move(response));
+				}
+				_responseAvailable.notify_one();
+				// The next response is requested right away: it's transferred while this one is decoded
+				if(!last) _requestMore();
+			}
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_error = std::current_exception();
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_finished = true;
+		}
+		_responseAvailable.notify_one();
+	}
+}
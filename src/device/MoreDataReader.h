@@ -0,0 +1,90 @@
+#ifndef _DEVICE_MOREDATAREADER_HPP_
+#define _DEVICE_MOREDATAREADER_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace device
+{
+	/**
+	  Reads the responses of the "more data" protocol of Kalenji and Keymaze devices: once the
+	  sessions are queried, the device sends a response each time it receives the dataMore request,
+	  until the end marker 0x8A.
+	  With a prefetch depth, responses are read by a thread of their own which sends dataMore as
+	  soon as a response is received, so that the next one is transferred while the previous ones
+	  are decoded. The device receives the same requests in the same order either way.
+	  The source must not be used by anything else until the end marker is read or close() is called.
+	 */
+	class MoreDataReader
+	{
+		public:
+			// Read a full response, with the same contract as Source::read_data
+			typedef std::function<bool(unsigned char **oData, size_t *oLength)> ReadResponse;
+			// Send the dataMore request
+			typedef std::function<void()> RequestMore;
+
+			static const unsigned char END_MARKER = 0x8A;
+
+			/**
+			  @param iReadResponse Function reading a response from the device
+			  @param iRequestMore Function sending the dataMore request
+			  @param iDepth Maximum number of responses read in advance, 0 to read each one in next()
+			 */
+			MoreDataReader(ReadResponse iReadResponse, RequestMore iRequestMore, size_t iDepth);
+			~MoreDataReader() { close(); };
+
+			MoreDataReader(const MoreDataReader&) = delete;
+			MoreDataReader& operator=(const MoreDataReader&) = delete;
+
+			/**
+			  Get the next response. Except for the first one, dataMore is sent before it's read.
+			  @param oData Address of a pointer set to the response, valid until the next call
+			  @param oLength Address of a variable set to the size of the response
+			  @return false if the response couldn't be read (oData and oLength are set only if the source gave data anyway),
+			          or if the end marker was already returned (oData and oLength are unchanged)
+			  @throw the exception thrown while reading the response
+			 */
+			bool next(unsigned char **oData, size_t *oLength);
+
+			/**
+			  Stop reading responses in advance, after the one being read if any
+			 */
+			void close();
+
+		private:
+			struct Response
+			{
+				std::vector<unsigned char> data;
+				bool hasData;
+				bool read;
+			};
+
+			static bool isLast(bool iRead, const unsigned char *iData, size_t iLength);
+			void readResponses();
+
+			ReadResponse _readResponse;
+			RequestMore _requestMore;
+			size_t _depth;
+			// Read in next(): a response was already read, the last one was read
+			bool _started;
+			bool _ended;
+			// Read in advance: responses not given by next() yet, the one it gave last
+			std::deque<Response> _responses;
+			std::vector<unsigned char> _current;
+			bool _finished;
+			bool _stopped;
+			std::exception_ptr _error;
+			std::mutex _mutex;
+			std::condition_variable _responseAvailable;
+			std::condition_variable _spaceAvailable;
+			std::thread _thread;
+	};
+}
+
+#endif
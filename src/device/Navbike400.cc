@@ -157,10 +157,9 @@ namespace device
 				LOG_VERBOSE("Session from: " << time.tm_year + 1900 << "-" << time.tm_mon + 1 << "-" << time.tm_mday << " " << time.tm_hour << ":" << time.tm_min << ":" << time.tm_sec);
 				int nb_points = (responseData[14] << 8) + responseData[15];
 				int num_session = responseData[34];
-				SessionId id = SessionId(responseData[34], responseData[34]+1);
+				SessionId id = SessionId(&responseData[34], &responseData[35]);
 				// TODO: Find duration, distance and # laps (watch doesn't support laps ?)
-				Session mySession(id, num_session, time, nb_points, 0, 0, 0);
-				oSessions->insert(SessionsMapElement(id, mySession));
+				oSessions->emplace(id, Session(id, num_session, time, nb_points, 0, 0, 0));
 				//Session *session = &(oSessions->find(id)->second);
 				// Ignore second line (for now ?)
 				READ_MORE_DATA;
@@ -209,14 +208,13 @@ namespace device
 			LOG_VERBOSE("Session from: " << time.tm_year + 1900 << "-" << time.tm_mon + 1 << "-" << time.tm_mday << " " << time.tm_hour << ":" << time.tm_min << ":" << time.tm_sec);
 			int nb_points = (responseData[14] << 8) + responseData[15];
 			int num_session = responseData[34];
-			SessionId id = SessionId(responseData[34], responseData[34]+1);
+			SessionId id = SessionId(&responseData[34], &responseData[35]);
 			// TODO: Find duration, distance and # laps (watch doesn't support laps ?)
-			Session mySession(id, num_session, time, nb_points, 0, 0, 0);
-			oSessions->insert(SessionsMapElement(id, mySession));
+			oSessions->emplace(id, Session(id, num_session, time, nb_points, 0, 0, 0));
 			Session *session = &(oSessions->find(id)->second);
 			time_t current_time = session->getTime();
 			*/
-			SessionId id = SessionId(responseData[34], responseData[34]+1);
+			SessionId id = SessionId(&responseData[34], &responseData[35]);
 			Session *session = &(oSessions->find(id)->second);
 			time_t start_time = session->getTime();
 			READ_MORE_DATA;
@@ -269,8 +267,7 @@ namespace device
 				prevElapsed = elapsed;
 				prevDistance = distance;
 				// TODO: Find out altitude, speed
-				auto myPoint = new Point(latitude, longitude, elevation, speed, start_time+elapsed, 0, FieldUndef, 3);
-				session->addPoint(myPoint);
+				session->createPoint(latitude, longitude, elevation, speed, start_time+elapsed, 0, FieldUndef, 3);
 				READ_MORE_DATA;
 			}
 		}
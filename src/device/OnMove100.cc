@@ -146,7 +146,7 @@ namespace device
 		}
 		READ_MORE_DATA;
 		// First lines to be reverse engineered (sessions global infos ?)
-		SessionsMapElement currentSession;
+		std::pair<SessionId, Session> currentSession;
 		while(received >= 36 && responseData[35] == 0xfd)
 		{
 			try
@@ -172,15 +172,14 @@ namespace device
 					SessionId id = SessionId(&responseData[34], &responseData[35]);
 					LOG_VERBOSE("Session " << (int)id[0] << " from: " << time.tm_year + 1900 << "-" << time.tm_mon + 1 << "-" << time.tm_mday << " " << time.tm_hour << ":" << time.tm_min << ":" << time.tm_sec);
 					// TODO: Find duration, distance and # laps (watch doesn't support laps ?)
-					Session mySession(id, num_session, time, nb_points, 0, 0, 0);
 					currentSession.first = id;
-					currentSession.second = mySession;
+					currentSession.second = Session(id, num_session, time, nb_points, 0, 0, 0);
 				}
 				// Ignore content of second line, but if present session is considered as valid
 				else if(responseData[33] == 1)
 				{
 					LOG_VERBOSE("Session " << (int)currentSession.first[0] << " is valid !");
-					oSessions->insert(currentSession);
+					oSessions->insert(std::move(currentSession));
 				}
 			}
 			catch(std::runtime_error &e)
@@ -212,7 +211,7 @@ namespace device
 			SessionId id = SessionId(&responseData[34], &responseData[35]);
 			// TODO: Find duration, distance and # laps (watch doesn't support laps ?)
 			Session mySession(id, num_session, time, nb_points, 0, 0, 0);
-			oSessions->insert(SessionsMapElement(id, mySession));
+			oSessions->emplace(id, std::move(mySession));
 			Session *session = &(oSessions->find(id)->second);
 			time_t current_time = session->getTime();
 			*/
@@ -250,8 +249,7 @@ namespace device
 				double speed = (distance * 3.6) / elapsed;
 				if(elapsed == 0) speed = 0;
 				// TODO: Find out altitude, speed
-				auto myPoint = new Point(latitude, longitude, FieldUndef, speed, current_time+elapsed, hundredth*10, FieldUndef, 3);
-				session->addPoint(myPoint);
+				session->createPoint(latitude, longitude, FieldUndef, speed, current_time+elapsed, hundredth*10, FieldUndef, 3);
 				READ_MORE_DATA;
 			}
 		}
@@ -2,6 +2,7 @@
 #define _DEVICE_GEONAUTE200_HPP_
 
 #include "Device.h"
+#include "../source/MappedFile.h"
 
 namespace device
 {
@@ -54,8 +55,8 @@ namespace device
 
 			int bytesToInt2(unsigned char b0, unsigned char b1);
 			int bytesToInt4(unsigned char b0, unsigned char b1, unsigned char b2, unsigned char b3);
-			unsigned char* readAllBytes(const std::string& filename, size_t& size);
-			bool fileExists(const std::string& filename);
+			// Map a whole file, throw if it can't be read
+			void openFile(const std::string& filename, source::MappedFile& oFile);
 
 			std::string getName() override { return "OnMove200"; };
 			DeviceId getDeviceId() override { return { 0x283E, 0x0009 }; };
@@ -1,14 +1,16 @@
 #include "OnMove500.h"
+#include "DirectoryIndex.h"
 #include <cstring>
 #include <iomanip>
-#include <set>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
 #include <dirent.h>
-#include <sys/stat.h>
+
+// Size of the header of a session (.OMH file)
+#define ONMOVE500_HEADER_SIZE 60
 
 #ifdef DEBUG
 #define DEBUG_CMD(x) x;
@@ -32,23 +34,12 @@ namespace device
 		return Int;
 	}
 
-	unsigned char* OnMove500::readAllBytes(const std::string& filename, size_t& size)
-	{
-		std::ifstream fl(filename.c_str());
-		fl.seekg( 0, std::ios::end );
-		size_t len = fl.tellg();
-		auto buffer = new char[len];
-		fl.seekg(0, std::ios::beg);
-		fl.read(buffer, len);
-		fl.close();
-		size = len;
-		return (unsigned char*)buffer;
-	}
-
-	bool OnMove500::fileExists(const std::string& filename)
+	void OnMove500::openFile(const std::string& filename, source::MappedFile& oFile)
 	{
-		struct stat fileInfo;
-		return stat(filename.c_str(), &fileInfo) == 0;
+		if(!oFile.open(filename))
+		{
+			THROW_STREAM("Unable to read " << filename);
+		}
 	}
 
 	void OnMove500::dump(unsigned char *data, int length)
@@ -80,57 +71,44 @@ namespace device
 
 	std::string OnMove500::getPath()
 	{
-		return _configuration["path"];
+		return _configuration.get("path");
 	}
 
 	void OnMove500::getSessionsList(SessionsMap *oSessions)
 	{
 		LOG_VERBOSE("OnMove500: Retrieve sessions list from '" << getPath() << "'");
 
-		DIR* folder = nullptr;
-		struct dirent* file = nullptr;
-		folder = opendir(getPath().c_str());
-		if (folder == nullptr)
-		{
-			std::cerr << "Couldn't open dir " << getPath() << std::endl;
-			throw std::exception();
-		}
+		DirectoryIndex index(getPath(), { ".OMD", ".OMH" });
 
-		std::set<std::string> filenamesPrefix;
-
-		while ((file = readdir(folder)) != nullptr)
+		int i = 0;
+		for(const std::string& fileprefix : index.getPrefixes())
 		{
-			std::string fn = std::string(file->d_name);
-			if(strstr(file->d_name,".OMD") || strstr(file->d_name,".OMH"))
+			//check if both files (header and data) exists
+			if(!index.isComplete(fileprefix))
 			{
-				std::string fileprefix = fn.substr(0,fn.length() - 4);
-				std::string filepathprefix = getPath() + std::string("/") + fileprefix;
-				//check if both files (header and data) exists
-				if(fileExists(filepathprefix + ".OMD") && fileExists(filepathprefix + ".OMH"))
-				{
-					filenamesPrefix.insert(fileprefix);
-				}
-				else
-				{
-					std::cout << "Discarding " << fileprefix << std::endl;
-				}
+				std::cout << "Discarding " << fileprefix << std::endl;
+				continue;
+			}
+			const DirectoryIndex::File *omh = index.find(fileprefix, ".OMH");
+			if(omh->size < ONMOVE500_HEADER_SIZE)
+			{
+				std::cout << "Discarding " << fileprefix << ": header is too short" << std::endl;
+				continue;
 			}
-		}
-
-		closedir(folder);
-
-		int i = 0;
-		std::set<std::string>::iterator iter;
-		for (iter=filenamesPrefix.begin(); iter!=filenamesPrefix.end(); ++iter)
-		{
-			std::string fileprefix = *iter;
 
 			DEBUG_CMD(std::cout << "Decode summary of session " << fileprefix << std::endl);
 			// Decoding of basic info about the session
-			std::vector<char> _sessionId(fileprefix.begin(), fileprefix.end());
-			SessionId id = SessionId(_sessionId);
+			SessionId id(fileprefix.begin(), fileprefix.end());
 			uint32_t num = i++; //Just increment by one each time
 
+			// Known from the sizes and modification times of the files: nothing to read if already imported
+			uint64_t fingerprint = index.getFingerprint(fileprefix);
+			if(isImported(id, fingerprint))
+			{
+				std::cout << " session " << num << " already imported" << std::endl;
+				continue;
+			}
+
 			tm time;
 			memset(&time, 0, sizeof(time));
 
@@ -139,38 +117,31 @@ namespace device
 			uint32_t nbLaps = 999;
 
 			Session mySession(id, num, time, 0, duration, distance, nbLaps);
+			mySession.setFingerprint(fingerprint);
 
 			// Properly fill necessary session info (duration, distance, nbLaps)
-			std::string ghtFilename = getPath() + std::string("/") + fileprefix + std::string(".OMH");
-			size_t size = -1;
-			unsigned char* buffer = readAllBytes(ghtFilename, size);
-			// TODO: if(size != 60) error !
-			parseOMHFile(buffer, &mySession);
-			delete buffer;
-
-			oSessions->insert(SessionsMapElement(id, mySession));
+			source::MappedFile file;
+			openFile(omh->path, file);
+			parseOMHFile(file.data(), &mySession);
+
+			oSessions->emplace(id, std::move(mySession));
 		}
 	}
 
 	void OnMove500::getSessionsDetails(SessionsMap *oSessions)
 	{
-		for(auto& sessionPair : *oSessions)
+		decodeSessions(oSessions, [this](Session* session)
 		{
-			Session* session = &(sessionPair.second);
-			SessionId sessionId = sessionPair.second.getId();
+			SessionId sessionId = session->getId();
 			std::string filenamePrefix(sessionId.begin(),sessionId.end());
 			std::cout << "Retrieve session " << filenamePrefix << std::endl;
 
 			filenamePrefix = getPath() + std::string("/") + filenamePrefix;
 
-			unsigned char* buffer;
-			size_t size = -1;
-
-			std::string omdFilename = filenamePrefix + std::string(".OMD");
-			buffer = readAllBytes(omdFilename,size);
-			parseOMDFile(buffer, size, session);
-			delete buffer;
-		}
+			source::MappedFile file;
+			openFile(filenamePrefix + std::string(".OMD"), file);
+			parseOMDFile(file.data(), file.size(), session);
+		});
 	}
 
 	void OnMove500::dumpInt2(std::ostream &oStream, unsigned int iInt)
@@ -271,9 +242,8 @@ namespace device
 			uint16_t p1hr = ((uint16_t) bytesToInt2(chunk[metaoffset + 6], chunk[metaoffset + 7]));
 			//uint32_t p1newLap = static_cast<uint32_t>(bytes[8]);
 			//uint32_t p1endOfTrack = static_cast<uint32_t>(bytes[9]);
-			auto p1 = new Point(p1latitude, p1longitude, p1alt, p1speed, startTime + p1time, 0, p1hr, p1fiability);
+			auto p1 = session->createPoint(p1latitude, p1longitude, p1alt, p1speed, startTime + p1time, 0, p1hr, p1fiability);
 			p1->setDistance(p1distance);
-			session->addPoint(p1);
 			if (twoPoints) {
 				// Coordinate and data of point 2
 				double p2latitude = ((double) bytesToInt4(chunk[20], chunk[21], chunk[22], chunk[23])) / 1000000.;
@@ -290,9 +260,8 @@ namespace device
 				uint16_t p2hr = ((uint16_t) bytesToInt2(chunk[metaoffset + 6], chunk[metaoffset + 7]));
 				//uint32_t p2newLap = static_cast<uint32_t>(bytes[8]);
 				//uint32_t p2endOfTrack = static_cast<uint32_t>(bytes[9]);
-				auto p2 = new Point(p2latitude, p2longitude, p2alt, p2speed, startTime + p2time, 0, p2hr, p2fiability);
+				auto p2 = session->createPoint(p2latitude, p2longitude, p2alt, p2speed, startTime + p2time, 0, p2hr, p2fiability);
 				p2->setDistance(p2distance);
-				session->addPoint(p2);
 			}
 		}
 	}
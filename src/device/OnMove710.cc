@@ -1,7 +1,7 @@
 #include "OnMove710.h"
+#include "DirectoryIndex.h"
 #include <cstring>
 #include <iomanip>
-#include <set>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
@@ -10,6 +10,11 @@
 #include <dirent.h>
 #include <sys/stat.h>
 
+// Sizes of the summary of a session (.GHT file), of a lap (in .GHL file) and of a point (in .GHP file)
+#define ONMOVE710_GHT_SIZE 96
+#define ONMOVE710_LAP_SIZE 48
+#define ONMOVE710_POINT_SIZE 20
+
 #ifdef DEBUG
 #define DEBUG_CMD(x) x;
 #else
@@ -33,17 +38,12 @@ namespace device
 		return Int;
 	}
 
-	unsigned char* OnMove710::readAllBytes(const std::string& filename, size_t& size)
+	void OnMove710::openFile(const std::string& filename, source::MappedFile& oFile)
 	{
-		std::ifstream fl(filename.c_str());
-		fl.seekg( 0, std::ios::end );
-		size_t len = fl.tellg();
-		auto buffer = new char[len];
-		fl.seekg(0, std::ios::beg);
-		fl.read(buffer, len);
-		fl.close();
-		size = len;
-		return (unsigned char*)buffer;
+		if(!oFile.open(filename))
+		{
+			THROW_STREAM("Unable to read " << filename);
+		}
 	}
 
 	bool OnMove710::fileExists(const std::string& filename)
@@ -110,57 +110,44 @@ namespace device
 
 	std::string OnMove710::getPath()
 	{
-		return _configuration["path"];
+		return _configuration.get("path");
 	}
 
 	void OnMove710::getSessionsList(SessionsMap *oSessions)
 	{
 		DEBUG_CMD(std::cout << "OnMove710: Get sessions list !" << std::endl);
 
-		DIR* folder = nullptr;
-		struct dirent* file = nullptr;
-		folder = opendir(getPath().c_str());
-		if (folder == nullptr)
-		{
-			std::cerr << "Couldn't open dir " << getPath() << std::endl;
-			throw std::exception();
-		}
-
-		std::set<std::string> filenamesPrefix;
+		DirectoryIndex index(getPath(), { ".GHP", ".GHT", ".GHL" });
 
-		while ((file = readdir(folder)) != nullptr)
+		int i = 0;
+		for(const std::string& fileprefix : index.getPrefixes())
 		{
-			std::string fn = std::string(file->d_name);
-			if(strstr(file->d_name,".GHP") || strstr(file->d_name,".GHT") || strstr(file->d_name,".GHL"))
+			//check if all 3 files (with the 3 extensions) exists
+			if(!index.isComplete(fileprefix))
 			{
-				std::string fileprefix = fn.substr(0,fn.length() - 4);
-				std::string filepathprefix = getPath() + std::string("/") + fileprefix;
-				//check if all 3 files (with the 3 extensions) exists
-				if(fileExists(filepathprefix + ".GHP") && fileExists(filepathprefix + ".GHT") && fileExists(filepathprefix + ".GHL"))
-				{
-					filenamesPrefix.insert(fileprefix);
-				}
-				else
-				{
-					std::cout << "Discarding " << fileprefix << std::endl;
-				}
+				std::cout << "Discarding " << fileprefix << std::endl;
+				continue;
+			}
+			const DirectoryIndex::File *ght = index.find(fileprefix, ".GHT");
+			if(ght->size < ONMOVE710_GHT_SIZE)
+			{
+				std::cout << "Discarding " << fileprefix << ": summary is too short" << std::endl;
+				continue;
 			}
-		}
-
-		closedir(folder);
-
-		int i = 0;
-		std::set<std::string>::iterator iter;
-		for (iter=filenamesPrefix.begin(); iter!=filenamesPrefix.end(); ++iter)
-		{
-			std::string fileprefix = *iter;
 
 			DEBUG_CMD(std::cout << "Decode summary of session " << fileprefix << std::endl);
 			// Decoding of basic info about the session
-			std::vector<char> _sessionId(fileprefix.begin(), fileprefix.end());
-			SessionId id = SessionId(_sessionId);
+			SessionId id(fileprefix.begin(), fileprefix.end());
 			uint32_t num = i++; //Just increment by one each time
 
+			// Known from the sizes and modification times of the files: nothing to read if already imported
+			uint64_t fingerprint = index.getFingerprint(fileprefix);
+			if(isImported(id, fingerprint))
+			{
+				std::cout << " session " << num << " already imported" << std::endl;
+				continue;
+			}
+
 			tm time = parseFilename(fileprefix);
 
 			double duration = 0;
@@ -168,47 +155,36 @@ namespace device
 			uint32_t nbLaps = 999;
 
 			Session mySession(id, num, time, 0, duration, distance, nbLaps);
+			mySession.setFingerprint(fingerprint);
 
 			// Properly fill necessary session info (duration, distance, nbLaps)
-			std::string ghtFilename = getPath() + std::string("/") + fileprefix + std::string(".GHT");
-			size_t size = -1;
-			unsigned char* buffer = readAllBytes(ghtFilename, size);
-			parseGHTFile(buffer, &mySession);
-			delete buffer;
+			source::MappedFile file;
+			openFile(ght->path, file);
+			parseGHTFile(file.data(), &mySession);
 
-			oSessions->insert(SessionsMapElement(id, mySession));
+			oSessions->emplace(id, std::move(mySession));
 		}
 	}
 
 	void OnMove710::getSessionsDetails(SessionsMap *oSessions)
 	{
-		for(auto& sessionPair : *oSessions)
+		decodeSessions(oSessions, [this](Session* session)
 		{
-			Session* session = &(sessionPair.second);
-			SessionId sessionId = sessionPair.second.getId();
-			std::string filenamePrefix(sessionId.begin(),sessionId.end());	
+			SessionId sessionId = session->getId();
+			std::string filenamePrefix(sessionId.begin(),sessionId.end());
 			std::cout << "Retrieve session " << filenamePrefix << std::endl;
 
 			filenamePrefix = getPath() + std::string("/") + filenamePrefix;
 
-			unsigned char* buffer;
-			size_t size = -1;
+			// The summary (.GHT file) was parsed with the list of sessions
+			// An incomplete lap or point at the end of a file is ignored
+			source::MappedFile file;
+			openFile(filenamePrefix + std::string(".GHL"), file);
+			parseGHLFile(file.data(), file.size() - file.size() % ONMOVE710_LAP_SIZE, session);
 
-			std::string ghtFilename = filenamePrefix + std::string(".GHT");
-			buffer = readAllBytes(ghtFilename,size);
-			parseGHTFile(buffer,session);
-			delete buffer;
-
-			std::string ghlFilename = filenamePrefix + std::string(".GHL");
-			buffer = readAllBytes(ghlFilename,size);
-			parseGHLFile(buffer,size,session);
-			delete buffer;
-
-			std::string ghpFilename = filenamePrefix + std::string(".GHP");
-			buffer = readAllBytes(ghpFilename,size);
-			parseGHPFile(buffer,size,session);
-			delete buffer;
-		}
+			openFile(filenamePrefix + std::string(".GHP"), file);
+			parseGHPFile(file.data(), file.size() - file.size() % ONMOVE710_POINT_SIZE, session);
+		});
 	}
 
 	void OnMove710::dumpInt2(std::ostream &oStream, unsigned int iInt)
@@ -292,7 +268,7 @@ namespace device
 		uint32_t id_point = 0;
 		auto lap = session->getLaps().begin();
 
-		for(int i=0; i<length; i=i+20)
+		for(int i=0; i<length; i=i+ONMOVE710_POINT_SIZE)
 		{
 			chunk = &bytes[i];
 			double latitude = ((double)bytesToInt4(chunk[0],chunk[1],chunk[2],chunk[3])) / 1000000.;//bytesToInt(chunk.slice(0, 4)) / 1000000,
@@ -302,8 +278,7 @@ namespace device
 			uint16_t heartRate = (unsigned char)chunk[12];//bytesToInt(chunk[12]),
 			uint16_t status = chunk[13];//bytesToInt(chunk[13]),
 			//TODO: Don't know what at 14-15
-			auto p = new Point(latitude, longitude, altitude, speed, current_time, cumulated_tenth*100, heartRate, status);
-			session->addPoint(p);
+			session->createPoint(latitude, longitude, altitude, speed, current_time, cumulated_tenth*100, heartRate, status);
 			// cumulated_tenth contains delay before next point
 			cumulated_tenth += bytesToInt4(chunk[16],chunk[17],chunk[18],chunk[19]);//bytesToInt(chunk.slice(16, 20))//[s/10]
 
@@ -337,7 +312,7 @@ namespace device
 	{
 		unsigned char* chunk;
 		DEBUG_CMD(int lapIndex = 0);
-		for(int i=0;i<length;i=i+48)
+		for(int i=0;i<length;i=i+ONMOVE710_LAP_SIZE)
 		{
 			chunk = &bytes[i];
 
@@ -381,9 +356,8 @@ namespace device
 			  uint32_t grams;
 			  uint32_t descent;
 			  uint32_t ascent;*/
-			auto l = new Lap(startPoint, endPoint, totalTime, totalDistance, maxSpeed, averageSpeed, maxHeartRate, averageHeartRate, averageCalory, weightLoss, averageDescent, averageAscent);
+			auto l = session->createLap(startPoint, endPoint, totalTime, totalDistance, maxSpeed, averageSpeed, maxHeartRate, averageHeartRate, averageCalory, weightLoss, averageDescent, averageAscent);
 			l->setLapNum(i);
-			session->addLap(l);
 		}
 	}
 
@@ -2,6 +2,7 @@
 #define _DEVICE_GEONAUTE710_HPP_
 
 #include "Device.h"
+#include "../source/MappedFile.h"
 
 namespace device
 {
@@ -60,7 +61,8 @@ namespace device
 		private:
 			int bytesToInt2(unsigned char b0, unsigned char b1);
 			int bytesToInt4(unsigned char b0, unsigned char b1, unsigned char b2, unsigned char b3);
-			unsigned char* readAllBytes(const std::string& filename, size_t& size);
+			// Map a whole file, throw if it can't be read
+			void openFile(const std::string& filename, source::MappedFile& oFile);
 			bool fileExists(const std::string& filename);
 			tm parseFilename(const std::string& filename);
 
@@ -125,9 +125,9 @@ namespace device
 				first_lap = true;
 				SessionId id = SessionId(line+6, line+8);
 				Session mySession;
-				currentSession = &(oSessions->insert(SessionsMapElement(id, mySession)).first->second);
-				currentSession->setId(id);
-				currentSession->setNum(numSess);
+				mySession.setId(id);
+				mySession.setNum(numSess);
+				currentSession = &(oSessions->emplace(id, std::move(mySession)).first->second);
 				numSess++;
 			}
 			// Header of lap
@@ -162,8 +162,7 @@ namespace device
 				double lat = ((line[0] << 16) + (line[1] << 8) + line[2]) / 60000.0;
 				double lon = - ((line[3] << 16) + (line[4] << 8) + line[5]) / 60000.0;
 				int16_t alt = ((line[7] << 8) + line[6]) - 18384;
-				auto point = new Point(lat, lon, alt, FieldUndef, current_time, 0, 0, 3);
-				currentSession->addPoint(point);
+				currentSession->createPoint(lat, lon, alt, FieldUndef, current_time, 0, 0, 3);
 				current_time += 10;
 			}
 		}
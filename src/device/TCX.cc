@@ -1,200 +1,167 @@
 #include "TCX.h"
+#include "XmlReader.h"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <vector>
 #include "../Utils.h"
 
 namespace device
 {
 	REGISTER_DEVICE(TCX);
 
-	bool TCX::openDoc()
+	namespace
 	{
-		_document = xmlParseDoc(_docAsString);
+		// Times of consecutive points share their date
+		thread_local TimeCodec timeCodec;
 
-		if (_document == nullptr )
+		bool startsWith(const unsigned char *iBegin, const unsigned char *iEnd, const char *iText)
 		{
-			std::cerr << "Document not parsed successfully. \n" << _docAsString << std::endl;
-			return false;
+			size_t length = strlen(iText);
+			return (size_t)(iEnd - iBegin) >= length && memcmp(iBegin, iText, length) == 0;
 		}
 
-		_rootNode = xmlDocGetRootElement(_document);
-
-		if (_rootNode == nullptr)
+		// Position just after the first occurrence of iText, iEnd if there is none
+		const unsigned char *skipPast(const unsigned char *iBegin, const unsigned char *iEnd, const char *iText)
 		{
-			std::cerr << "Empty document\n";
-			xmlFreeDoc(_document);
-			return false;
+			const unsigned char *found = std::search(iBegin, iEnd, iText, iText + strlen(iText));
+			return found == iEnd ? iEnd : found + strlen(iText);
 		}
 
-		if (xmlStrcmp(_rootNode->name, (const xmlChar *) "TrainingCenterDatabase") != 0)
+		// Position of the '>' ending the tag starting at iBegin, iEnd if the tag isn't complete
+		const unsigned char *findTagEnd(const unsigned char *iBegin, const unsigned char *iEnd)
 		{
-			std::cerr << "Document of the wrong type, root node != TrainingCenterDatabase (" << _rootNode->name << ")" << std::endl;
-			xmlFreeDoc(_document);
-			return false;
+			unsigned char quote = 0;
+			for(const unsigned char *current = iBegin; current < iEnd; ++current)
+			{
+				if(quote != 0)
+				{
+					if(*current == quote) quote = 0;
+				}
+				else if(*current == '"' || *current == '\'')
+				{
+					quote = *current;
+				}
+				else if(*current == '>')
+				{
+					return current;
+				}
+			}
+			return iEnd;
 		}
-		return true;
 	}
 
-	void TCX::parseDoc(Session *oSession)
+	void TCX::parseDoc(Session *oSession, xmlTextReaderPtr iReader)
 	{
 		// Ignored data: attributes version and creator
-		xmlNodePtr cur = _rootNode->xmlChildrenNode;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Activities") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "Activities") == 0)
 			{
-				parseActivities(oSession, cur);
+				parseActivities(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in TrainingCenterDatabase not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in TrainingCenterDatabase not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parseActivities(Session *oSession, xmlNodePtr rootNode)
+	void TCX::parseActivities(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		int nbActivities = 0;
-		while(cur != nullptr)
+		// Only the activity of the session is there: see decodeActivity
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Activity") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "Activity") == 0)
 			{
-				if(nbActivities == 0)
-				{
-					parseActivity(oSession, cur);
-				}
-				else
-				{
-					std::cout << "Multiple activities in TCX. This is not supported !!! Decoding only the first one." << std::endl;
-				}
-				nbActivities++;
+				parseActivity(oSession, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Activities not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Activities not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parseActivity(Session *oSession, xmlNodePtr rootNode)
+	void TCX::parseActivity(Session *oSession, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
 		int lapNum = 1;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Id") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "Id") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oSession->setName((const char*)data);
-				if(xmlStrlen(data) >= 20)
+				std::string data = readXmlText(iReader);
+				oSession->setName(data);
+				time_t time;
+				if(timeCodec.parseUtc(data.data(), data.size(), time))
 				{
-					tm time;
-					memset(&time, 0, sizeof(time));
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time.tm_sec  = atoi((char*) data + 17);
-					time.tm_isdst = -1;
-					oSession->setTimeT(mktime_utc(&time));
+					oSession->setTimeT(time);
 				}
 				else
 				{
-					std::cout << "Date is too short: '" << data << "'" << std::endl;
+					std::cout << "Invalid date: '" << data << "'" << std::endl;
 				}
-				xmlFree(data);
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "Lap") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "Lap") == 0)
 			{
-				auto aLap = new Lap();
+				auto aLap = oSession->createLap();
 				aLap->setLapNum(lapNum++);
-				parseLap(oSession, aLap, cur);
-				oSession->addLap(aLap);
+				parseLap(oSession, aLap, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Activity not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Activity not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parseLap(Session *oSession, Lap *oLap, xmlNodePtr rootNode)
+	void TCX::parseLap(Session *oSession, Lap *oLap, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
 		int nbTracks = 0;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
+			const xmlChar *name = children.name();
 			// To handle: AverageHeartRateBpm, MaximumHeartRateBpm, Intensity, TriggerMethod
-			if (xmlStrcmp(cur->name, (const xmlChar *) "StartTime") == 0)
+			if (xmlStrcmp(name, (const xmlChar *) "StartTime") == 0)
 			{
-				/* How to set start time of lap ?
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				if(xmlStrlen(data) >= 20)
-				{
-					tm time;
-					memset(&time, 0, sizeof(time));
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time.tm_sec  = atoi((char*) data + 17);
-					time.tm_isdst = -1;
-					oLap->setTimeT(mktime_utc(&time));
-				}
-				else
-				{
-					std::cout << "Date is too short: '" << data << "'" << std::endl;
-				}
-				 */
+				// How to set start time of lap ?
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "TotalTimeSeconds") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "TotalTimeSeconds") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oLap->setDuration(atoi((char*) data));
-				xmlFree(data);
+				oLap->setDuration(atoi(readXmlText(iReader).c_str()));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "DistanceMeters") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "DistanceMeters") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oLap->setDistance(atoi((char*) data));
-				xmlFree(data);
+				oLap->setDistance(atoi(readXmlText(iReader).c_str()));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "MaximumSpeed") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "MaximumSpeed") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oLap->setMaxSpeed(atof((char*) data));
-				xmlFree(data);
+				oLap->setMaxSpeed(atof(readXmlText(iReader).c_str()));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "Calories") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "Calories") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oLap->setCalories(atoi((char*) data));
-				xmlFree(data);
+				oLap->setCalories(atoi(readXmlText(iReader).c_str()));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "AverageHeartRateBpm") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "AverageHeartRateBpm") == 0)
 			{
-				oLap->setAvgHeartrate(parseValue(cur));
+				oLap->setAvgHeartrate(parseValue(iReader));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "MaximumHeartRateBpm") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "MaximumHeartRateBpm") == 0)
 			{
-				oLap->setMaxHeartrate(parseValue(cur));
+				oLap->setMaxHeartrate(parseValue(iReader));
 			}
-			else if(xmlStrcmp(cur->name, (const xmlChar *) "Track") == 0)
+			else if(xmlStrcmp(name, (const xmlChar *) "Track") == 0)
 			{
 				if(nbTracks == 0)
 				{
-					parseTrack(oSession, oLap, cur);
+					parseTrack(oSession, oLap, iReader);
 				}
 				else
 				{
@@ -202,25 +169,24 @@ namespace device
 				}
 				nbTracks++;
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Lap not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Lap not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parseTrack(Session *oSession, Lap *oLap, xmlNodePtr rootNode)
+	void TCX::parseTrack(Session *oSession, Lap *oLap, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
 		int nbPoints = oSession->getPoints().size();
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Trackpoint") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "Trackpoint") == 0)
 			{
-				auto aPoint = new Point();
-				parseTrackpoint(aPoint, cur);
-				oSession->addPoint(aPoint);
+				auto aPoint = oSession->createPoint();
+				parseTrackpoint(aPoint, iReader);
 				if(oLap->getStartPoint() == nullptr)
 				{
 					oLap->setStartPoint(aPoint);
@@ -230,188 +196,288 @@ namespace device
 				oLap->setEndPoint(aPoint);
 				oLap->setLastPointId(nbPoints);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Track not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Track not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parseTrackpoint(Point *oPoint, xmlNodePtr rootNode)
+	void TCX::parseTrackpoint(Point *oPoint, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
+			const xmlChar *name = children.name();
 			// To handle: HeartRateBpm, Extensions
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Time") == 0)
+			if (xmlStrcmp(name, (const xmlChar *) "Time") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				if(xmlStrlen(data) >= 20)
+				std::string data = readXmlText(iReader);
+				time_t time;
+				if(timeCodec.parseUtc(data.data(), data.size(), time))
 				{
-					tm time;
-					memset(&time, 0, sizeof(time));
-					// In tm, year is year since 1900. GPS returns year since 2000
-					data[4]  = 0; time.tm_year = atoi((char*) data) - 1900;
-					// In tm, month is between 0 and 11.
-					data[7]  = 0; time.tm_mon  = atoi((char*) data + 5) - 1;
-					data[10] = 0; time.tm_mday = atoi((char*) data + 8);
-					data[13] = 0; time.tm_hour = atoi((char*) data + 11);
-					data[16] = 0; time.tm_min  = atoi((char*) data + 14);
-					data[19] = 0; time.tm_sec  = atoi((char*) data + 17);
-					time.tm_isdst = -1;
-					oPoint->setTime(mktime_utc(&time));
+					oPoint->setTime(time);
 				}
 				else
 				{
-					std::cout << "Date is too short: '" << data << "'" << std::endl;
+					std::cout << "Invalid date: '" << data << "'" << std::endl;
 				}
-				xmlFree(data);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "Position") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "Position") == 0)
 			{
-				parsePosition(oPoint, cur);
+				parsePosition(oPoint, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "AltitudeMeters") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "AltitudeMeters") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setAltitude(atoi((char*) data));
-				xmlFree(data);
+				oPoint->setAltitude(atoi(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "DistanceMeters") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "DistanceMeters") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setDistance(static_cast<uint32_t>(atof((char*) data)));
-				xmlFree(data);
+				oPoint->setDistance(static_cast<uint32_t>(atof(readXmlText(iReader).c_str())));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "Extensions") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "Extensions") == 0)
 			{
-				parsePointExtensions(oPoint, cur);
+				parsePointExtensions(oPoint, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Trackpoint not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Trackpoint not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parsePosition(Point *oPoint, xmlNodePtr rootNode)
+	void TCX::parsePosition(Point *oPoint, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "LatitudeDegrees") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "LatitudeDegrees") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setLatitude(atof((char*)data));
-				xmlFree(data);
+				oPoint->setLatitude(atof(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "LongitudeDegrees") == 0)
+			else if (xmlStrcmp(name, (const xmlChar *) "LongitudeDegrees") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setLongitude(atof((char*)data));
-				xmlFree(data);
+				oPoint->setLongitude(atof(readXmlText(iReader).c_str()));
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in Trackpoint/Position not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in Trackpoint/Position not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parsePointExtensions(Point *oPoint, xmlNodePtr rootNode)
+	void TCX::parsePointExtensions(Point *oPoint, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "TPX") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "TPX") == 0)
 			{
-				parsePointTPX(oPoint, cur);
+				parsePointTPX(oPoint, iReader);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in PointExtension not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in PointExtension not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	void TCX::parsePointTPX(Point *oPoint, xmlNodePtr rootNode)
+	void TCX::parsePointTPX(Point *oPoint, xmlTextReaderPtr iReader)
 	{
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Speed") == 0)
+			const xmlChar *name = children.name();
+			if (xmlStrcmp(name, (const xmlChar *) "Speed") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				oPoint->setSpeed(atof((char*)data)*3.6);
-				xmlFree(data);
+				oPoint->setSpeed(atof(readXmlText(iReader).c_str())*3.6);
 			}
-			else if (xmlStrcmp(cur->name, (const xmlChar *) "text") != 0)
+			else
 			{
-				LOG_VERBOSE("Warning: parsing of element '" << cur->name << "' in PointExtension not implemented in device::TCX");
+				LOG_VERBOSE("Warning: parsing of element '" << name << "' in PointExtension not implemented in device::TCX");
 			}
-			cur = cur->next;
 		}
 	}
 
-	double TCX::parseValue(xmlNodePtr rootNode)
+	double TCX::parseValue(xmlTextReaderPtr iReader)
 	{
 		double result = 0;
-		xmlNodePtr cur = rootNode->xmlChildrenNode;
-		xmlChar *data;
-		while(cur != nullptr)
+		XmlChildren children(iReader);
+		while(children.next())
 		{
-			if (xmlStrcmp(cur->name, (const xmlChar *) "Value") == 0)
+			if (xmlStrcmp(children.name(), (const xmlChar *) "Value") == 0)
 			{
-				data = xmlNodeListGetString(_document, cur->xmlChildrenNode, 1);
-				result = atof((char*) data);
-				xmlFree(data);
+				result = atof(readXmlText(iReader).c_str());
 			}
-			cur = cur->next;
 		}
 		return result;
 	}
 
-	void TCX::closeDoc()
-	{
-		xmlFreeDoc(_document);
-	}
-
 	void TCX::init(const DeviceId& deviceId)
 	{
+		// Activities are read from the mapping of the file, in parallel, not chunk by chunk from the source
 		_dataSource->init(deviceId.vendorId, deviceId.productId);
-		std::string fileContent;
-		unsigned char* line;
-		size_t length;
-		while(_dataSource->read_data(0x81, &line, &length))
+		_file = dynamic_cast<const source::File*>(_dataSource);
+		if(_file == nullptr)
 		{
-			fileContent.append((char*)line, length);
+			THROW_STREAM("TCX files can't be read from source " << _dataSource->getName());
 		}
-		_docAsString = new xmlChar[fileContent.size()+2];
-		strncpy((char*)_docAsString, fileContent.c_str(), fileContent.size()+1);
+		if(_file->data() == nullptr)
+		{
+			THROW_STREAM("Unable to read the TCX file");
+		}
+		// libxml2 must be initialized before parsers are used from several threads
+		xmlInitParser();
 	}
 
 	void TCX::getSessionsList(SessionsMap *oSessions)
 	{
-		Session aSession;
-		if (openDoc())
+		// Only tags are looked at, to find the position of activities and their id: they are parsed by getSessionsDetails
+		const unsigned char *end = _file->data() + _file->size();
+		const unsigned char *current = _file->data();
+		// Names of the elements containing the current position, as written in the file (with their namespace prefix)
+		std::vector<std::string> parents;
+		std::string activitiesStartTag;
+		std::string activitiesEndTag;
+		bool inActivities = false;
+		const unsigned char *activityBegin = nullptr;
+		const unsigned char *idBegin = nullptr;
+		std::string id;
+		uint32_t num = 0;
+		_activities.clear();
+		_startTags.clear();
+		_endTags.clear();
+		while(current != nullptr && current < end && (current = (const unsigned char*) memchr(current, '<', end - current)) != nullptr)
+		{
+			// Comments, CDATA, processing instructions and DOCTYPE
+			if(startsWith(current, end, "<!--"))
+			{
+				current = skipPast(current, end, "-->");
+				continue;
+			}
+			if(startsWith(current, end, "<![CDATA["))
+			{
+				current = skipPast(current, end, "]]>");
+				continue;
+			}
+			if(startsWith(current, end, "<?") || startsWith(current, end, "<!"))
+			{
+				current = skipPast(current, end, ">");
+				continue;
+			}
+
+			bool closing = startsWith(current, end, "</");
+			const unsigned char *nameBegin = current + (closing ? 2 : 1);
+			const unsigned char *nameEnd = nameBegin;
+			while(nameEnd < end && !isspace(*nameEnd) && *nameEnd != '/' && *nameEnd != '>') ++nameEnd;
+			const unsigned char *tagEnd = findTagEnd(nameEnd, end);
+			if(tagEnd == end) break;
+			std::string name(nameBegin, nameEnd);
+			// Without namespace prefix
+			std::string localName = name.substr(name.find(':') + 1);
+
+			if(closing)
+			{
+				if(parents.empty()) break;
+				parents.pop_back();
+				if(parents.size() == 1)
+				{
+					inActivities = false;
+				}
+				else if(parents.size() == 3 && idBegin != nullptr)
+				{
+					id.assign(idBegin, current);
+					idBegin = nullptr;
+				}
+			}
+			else if(parents.empty() && localName != "TrainingCenterDatabase")
+			{
+				std::cerr << "Document of the wrong type, root node != TrainingCenterDatabase (" << localName << ")" << std::endl;
+				return;
+			}
+			else if(parents.empty())
+			{
+				_startTags.assign(current, tagEnd + 1);
+				_endTags = "</" + name + ">";
+			}
+			else if(parents.size() == 1 && localName == "Activities")
+			{
+				inActivities = true;
+				activitiesStartTag.assign(current, tagEnd + 1);
+				activitiesEndTag = "</" + name + ">";
+			}
+			else if(parents.size() == 2 && inActivities && localName == "Activity")
+			{
+				activityBegin = current;
+				id.clear();
+			}
+			else if(parents.size() == 3 && activityBegin != nullptr && localName == "Id")
+			{
+				idBegin = tagEnd + 1;
+			}
+			if(!closing && tagEnd[-1] != '/')
+			{
+				parents.push_back(name);
+			}
+			current = tagEnd + 1;
+
+			// End of an activity (or an empty one)
+			if(activityBegin != nullptr && parents.size() == 2)
+			{
+				SessionId sessionId(id.begin(), id.begin() + std::min(id.size(), SessionId::MAX_SIZE));
+				Session session;
+				session.setId(sessionId);
+				session.setNum(num++);
+				session.setName(id);
+				time_t time;
+				if(timeCodec.parseUtc(id.data(), id.size(), time))
+				{
+					session.setTimeT(time);
+				}
+				if(oSessions->emplace(sessionId, std::move(session)).second)
+				{
+					_activities[sessionId] = { activityBegin, (size_t)(current - activityBegin) };
+				}
+				else
+				{
+					std::cerr << "Activity '" << id << "' found twice in TCX, only the first one is read" << std::endl;
+				}
+				activityBegin = nullptr;
+			}
+		}
+
+		if(parents.empty() && _startTags.empty())
+		{
+			std::cerr << "Empty document" << std::endl;
+		}
+		else if(activityBegin != nullptr)
+		{
+			std::cerr << "TCX file is truncated, its last activity is ignored" << std::endl;
+		}
+		_startTags += activitiesStartTag;
+		_endTags = activitiesEndTag + _endTags;
+	}
+
+	void TCX::decodeActivity(Session *oSession)
+	{
+		const Activity &activity = _activities.at(oSession->getId());
+		XmlReader reader({ { (const unsigned char*) _startTags.data(), _startTags.size() },
+		                   { activity.begin, activity.length },
+		                   { (const unsigned char*) _endTags.data(), _endTags.size() } });
+		if(reader.readRoot())
+		{
+			parseDoc(oSession, reader.get());
+		}
+		if(reader.hasFailed())
 		{
-			oSessions->insert(SessionsMapElement(aSession.getId(), aSession));
-			parseDoc(&(*oSessions)[aSession.getId()]);
-			// TODO: Understand why some cores appears when trying to free the document
-			//closeDoc();
+			THROW_STREAM("Activity '" << oSession->getName() << "' of TCX not parsed successfully");
 		}
-		// TODO: else
 	}
 
 	void TCX::getSessionsDetails(SessionsMap *oSessions)
 	{
-		// All work is done in getSessionsList
+		decodeSessions(oSessions, [this](Session *session) { decodeActivity(session); });
 	}
 }
@@ -2,27 +2,32 @@
 #define _DEVICE_TCX_HPP_
 
 #include "Device.h"
-#include <libxml/parser.h>
+#include "../source/File.h"
+#include <libxml/xmlreader.h>
+#include <map>
 
 namespace device
 {
 	/**
 	  The interface for reading TCX files.
+	  Each activity of the file is a session. Listing sessions only locates activities in the file,
+	  they are parsed in parallel when details are read, each one on its own.
 	 */
 	class TCX : public Device
 	{
 		public:
-			TCX() {};
+			TCX() : _file(nullptr) {};
 
 			/**
-			  Initialize the device.
+			  Initialize the device: map the file of its source.
+			  @throw std::runtime_error if the source isn't a source::File or if the file can't be read
 			 */
 			void init(const DeviceId& deviceId) override;
 
 			/**
 			  Release the device.
 			 */
-			void release() override {};
+			void release() override { _activities.clear(); _file = nullptr; };
 
 			/**
 			  Read list of sessions from the device.
@@ -37,8 +42,8 @@ namespace device
 			void exportSession(const Session *iSession) override {};
 
 			/**
-			  Send data to the source.
-			  @param iData A pointer to data to be sent
+			  Parse the activities of the sessions, on as many threads as jobs in the configuration.
+			  @throw std::runtime_error if an activity can't be parsed
 			 */
 			void getSessionsDetails(SessionsMap *oSessions) override;
 
@@ -46,22 +51,34 @@ namespace device
 			DeviceId getDeviceId() override { return { 0x0, 0x0 }; };
 
 		private:
-			bool openDoc();
-			void parseDoc(Session *oSession);
-			void parseActivities(Session *oSession, xmlNodePtr rootNode);
-			void parseActivity(Session *oSession, xmlNodePtr rootNode);
-			void parseLap(Session *oSession, Lap *oLap, xmlNodePtr rootNode);
-			void parseTrack(Session *oSession, Lap *oLap, xmlNodePtr rootNode);
-			void parseTrackpoint(Point *oPoint, xmlNodePtr rootNode);
-			void parsePosition(Point *oPoint, xmlNodePtr rootNode);
-			void parsePointExtensions(Point *oPoint, xmlNodePtr rootNode);
-			void parsePointTPX(Point *oPoint, xmlNodePtr rootNode);
-			double parseValue(xmlNodePtr rootNode);
-			void closeDoc();
+			// Bytes of an activity in the file, from the start of its Activity element to its end
+			struct Activity
+			{
+				const unsigned char *begin;
+				size_t length;
+			};
 
-			xmlChar *_docAsString;
-			xmlDocPtr _document;
-			xmlNodePtr _rootNode;
+			// Each of them parses the current element of the reader and leaves it on the end of this element
+			void parseDoc(Session *oSession, xmlTextReaderPtr iReader);
+			void parseActivities(Session *oSession, xmlTextReaderPtr iReader);
+			void parseActivity(Session *oSession, xmlTextReaderPtr iReader);
+			void parseLap(Session *oSession, Lap *oLap, xmlTextReaderPtr iReader);
+			void parseTrack(Session *oSession, Lap *oLap, xmlTextReaderPtr iReader);
+			void parseTrackpoint(Point *oPoint, xmlTextReaderPtr iReader);
+			void parsePosition(Point *oPoint, xmlTextReaderPtr iReader);
+			void parsePointExtensions(Point *oPoint, xmlTextReaderPtr iReader);
+			void parsePointTPX(Point *oPoint, xmlTextReaderPtr iReader);
+			double parseValue(xmlTextReaderPtr iReader);
+
+			// Parse the activity of a session, wrapped in the start and end tags of its parents
+			void decodeActivity(Session *oSession);
+
+			// Source of the device, read through its mapping
+			const source::File *_file;
+			std::map<SessionId, Activity> _activities;
+			// Start tags of TrainingCenterDatabase and Activities: they hold namespace declarations needed by activities
+			std::string _startTags;
+			std::string _endTags;
 
 			DECLARE_DEVICE(TCX);
 	};
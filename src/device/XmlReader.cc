@@ -0,0 +1,112 @@
+#include "XmlReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace device
+{
+	XmlReader::XmlReader(source::Source *iSource) : _source(iSource), _chunk(nullptr), _chunkLength(0), _moreChunks(true)
+	{
+		open();
+	}
+
+	XmlReader::XmlReader(const std::vector<std::pair<const unsigned char*, size_t>> &iParts) : _source(nullptr), _parts(iParts.begin(), iParts.end()), _chunk(nullptr), _chunkLength(0), _moreChunks(false)
+	{
+		open();
+	}
+
+	void XmlReader::open()
+	{
+		_reader = xmlReaderForIO(readSource, nullptr, this, nullptr, nullptr, 0);
+	}
+
+	XmlReader::~XmlReader()
+	{
+		if(_reader != nullptr) xmlFreeTextReader(_reader);
+	}
+
+	int XmlReader::readSource(void *ioContext, char *oBuffer, int iLength)
+	{
+		XmlReader *reader = static_cast<XmlReader*>(ioContext);
+		while(reader->_chunkLength == 0 && !reader->_parts.empty())
+		{
+			reader->_chunk = reader->_parts.front().first;
+			reader->_chunkLength = reader->_parts.front().second;
+			reader->_parts.pop_front();
+		}
+		while(reader->_chunkLength == 0 && reader->_moreChunks)
+		{
+			unsigned char *chunk;
+			reader->_moreChunks = reader->_source->read_data(0x81, &chunk, &reader->_chunkLength);
+			reader->_chunk = chunk;
+		}
+		size_t length = std::min((size_t)iLength, reader->_chunkLength);
+		memcpy(oBuffer, reader->_chunk, length);
+		reader->_chunk += length;
+		reader->_chunkLength -= length;
+		return length;
+	}
+
+	bool XmlReader::readRoot()
+	{
+		if(_reader == nullptr) return false;
+		while(xmlTextReaderRead(_reader) == 1)
+		{
+			if(xmlTextReaderNodeType(_reader) == XML_READER_TYPE_ELEMENT) return true;
+		}
+		return false;
+	}
+
+	bool XmlReader::hasFailed() const
+	{
+		return _reader == nullptr || xmlTextReaderReadState(_reader) == XML_TEXTREADER_MODE_ERROR;
+	}
+
+	XmlChildren::XmlChildren(xmlTextReaderPtr iReader) : _reader(iReader), _depth(xmlTextReaderDepth(iReader))
+	{
+		// An empty element has no end to wait for
+		_done = xmlTextReaderIsEmptyElement(iReader) == 1;
+	}
+
+	bool XmlChildren::next()
+	{
+		while(!_done && xmlTextReaderRead(_reader) == 1)
+		{
+			int depth = xmlTextReaderDepth(_reader);
+			if(depth <= _depth) break;
+			if(depth == _depth + 1 && xmlTextReaderNodeType(_reader) == XML_READER_TYPE_ELEMENT) return true;
+		}
+		_done = true;
+		return false;
+	}
+
+	std::string readXmlText(xmlTextReaderPtr iReader)
+	{
+		std::string text;
+		if(xmlTextReaderIsEmptyElement(iReader) == 1) return text;
+		int depth = xmlTextReaderDepth(iReader);
+		while(xmlTextReaderRead(iReader) == 1 && xmlTextReaderDepth(iReader) > depth)
+		{
+			int type = xmlTextReaderNodeType(iReader);
+			// Like xmlNodeListGetString, text of child elements isn't included
+			if(xmlTextReaderDepth(iReader) > depth + 1) continue;
+			if(type == XML_READER_TYPE_TEXT || type == XML_READER_TYPE_CDATA ||
+			   type == XML_READER_TYPE_WHITESPACE || type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE)
+			{
+				text += (const char*) xmlTextReaderConstValue(iReader);
+			}
+		}
+		return text;
+	}
+
+	double readXmlAttribute(xmlTextReaderPtr iReader, const char *iName)
+	{
+		double value = 0;
+		if(xmlTextReaderMoveToAttribute(iReader, (const xmlChar*) iName) == 1)
+		{
+			value = atof((const char*) xmlTextReaderConstValue(iReader));
+			xmlTextReaderMoveToElement(iReader);
+		}
+		return value;
+	}
+}
@@ -0,0 +1,96 @@
+#ifndef _DEVICE_XMLREADER_HPP_
+#define _DEVICE_XMLREADER_HPP_
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <libxml/xmlreader.h>
+#include "../source/Source.h"
+
+namespace device
+{
+	/**
+	  A streaming XML parser (libxml2 xmlTextReader) fed by the chunks read from a source or by parts of memory.
+	  Only the current node is kept in memory, so memory doesn't grow with the size of the document.
+	 */
+	class XmlReader
+	{
+		public:
+			/**
+			  @param iSource The source to read, already initialized
+			 */
+			explicit XmlReader(source::Source *iSource);
+
+			/**
+			  Parse parts of memory, one after the other, as a single document
+			  @param iParts Pointer and length of each part, they must stay valid until the reader is destroyed
+			 */
+			explicit XmlReader(const std::vector<std::pair<const unsigned char*, size_t>> &iParts);
+			~XmlReader();
+
+			XmlReader(const XmlReader&) = delete;
+			XmlReader& operator=(const XmlReader&) = delete;
+
+			/**
+			  Move to the root element of the document
+			  @return false if the document is empty or can't be parsed
+			 */
+			bool readRoot();
+
+			/**
+			  @return true if the parser stopped on an error (libxml2 already reported it on stderr)
+			 */
+			bool hasFailed() const;
+
+			xmlTextReaderPtr get() const { return _reader; };
+
+		private:
+			void open();
+			static int readSource(void *ioContext, char *oBuffer, int iLength);
+
+			source::Source *_source;
+			std::deque<std::pair<const unsigned char*, size_t>> _parts;
+			const unsigned char *_chunk;
+			size_t _chunkLength;
+			bool _moreChunks;
+			xmlTextReaderPtr _reader;
+	};
+
+	/**
+	  Iterate over the child elements of the current element of a reader. Text, comments and
+	  descendants of children not read by the caller are skipped.
+	  Once next() returns false, the reader is on the end of the parent element.
+	 */
+	class XmlChildren
+	{
+		public:
+			explicit XmlChildren(xmlTextReaderPtr iReader);
+
+			/**
+			  Move the reader to the next child element
+			  @return false once there are no more children
+			 */
+			bool next();
+
+			// Name of the current child, without namespace prefix
+			const xmlChar *name() const { return xmlTextReaderConstLocalName(_reader); };
+
+		private:
+			xmlTextReaderPtr _reader;
+			int _depth;
+			bool _done;
+	};
+
+	/**
+	  Read the text of the current element and move the reader to its end
+	 */
+	std::string readXmlText(xmlTextReaderPtr iReader);
+
+	/**
+	  @return The value of an attribute of the current element as a number, 0 if it is missing
+	 */
+	double readXmlAttribute(xmlTextReaderPtr iReader, const char *iName);
+}
+
+#endif
@@ -6,26 +6,14 @@ namespace filter
 {
 	REGISTER_FILTER(ComputeInstantSpeed);
 
-	void ComputeInstantSpeed::filter(Session *session, std::map<std::string, std::string> configuration)
+	void ComputeInstantSpeed::filter(Session *session, const Configuration &configuration)
 	{
-		std::vector<Point*> &points = session->getPoints();
-		Point* prevPoint = nullptr;
-
-		auto it = points.begin();
-		double speed = 0;
 		// TODO: Support a moving average
-		while(true)
+		const std::vector<double> &speeds = session->getColumns().getInstantSpeeds();
+		std::vector<Point*> &points = session->getPoints();
+		for(size_t i = 0; i < points.size(); ++i)
 		{
-			prevPoint = *it;
-			++it;
-			if(it == points.end()) break;
-
-			uint32_t distance = distanceEarth(**it, *prevPoint);
-
-			speed = (3.6 * distance) / ((*it)->getTime() - prevPoint->getTime());
-			prevPoint->setSpeed(speed);
+			points[i]->setSpeed(speeds[i]);
 		}
-		// On last point, set same speed as on the previous point
-		prevPoint->setSpeed(speed);
 	}
 }
@@ -8,7 +8,7 @@ namespace filter
 	class ComputeInstantSpeed : public Filter
 	{
 		public:
-			void filter(Session *session, std::map<std::string, std::string> configuration) override;
+			void filter(Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "ComputeInstantSpeed"; };
 
 		private:
@@ -6,38 +6,33 @@ namespace filter
 {
 	REGISTER_FILTER(ComputeSessionStats);
 
-	void ComputeSessionStats::filter(Session *session, std::map<std::string, std::string> configuration)
+	void ComputeSessionStats::filter(Session *session, const Configuration &configuration)
 	{
-		std::vector<Point*> &points = session->getPoints();
+		const PointColumns &points = session->getColumns();
+		const std::vector<time_t> &times = points.getTimes();
+		const std::vector<int16_t> &alts = points.getAltitudes();
+		const std::vector<double> &speeds = points.getInstantSpeeds();
 		uint32_t ascent = 0;
 		uint32_t descent = 0;
-		uint32_t distance = 0;
+		uint32_t distance = points.getCumulativeDistances().back();
 		double maxspeed = 0;
 		double avgspeed = 0;
 		time_t mintime;
 		time_t maxtime;
 		uint32_t duration = 0;
 
-		auto it = points.begin();
-		maxtime = mintime = (*it)->getTime();
-		while(true)
+		maxtime = mintime = times[0];
+		for(size_t i = 1; i < points.size(); ++i)
 		{
-			Point *prevPoint = *it;
-			++it;
-			if(it == points.end()) break;
-
-			distance += distanceEarth(**it, *prevPoint);
-
-			int eleChange = (*it)->getAltitude() - prevPoint->getAltitude();
+			int eleChange = alts[i] - alts[i-1];
 			if(eleChange > 0)
 				ascent += eleChange;
 			else
 				descent -= eleChange;
 
-			if((*it)->getTime() > maxtime) maxtime = (*it)->getTime();
-			if((*it)->getTime() < mintime) mintime = (*it)->getTime();
-			double speed = (3.6 * distance) / ((*it)->getTime() - prevPoint->getTime());
-			if(speed > maxspeed) maxspeed = speed;
+			if(times[i] > maxtime) maxtime = times[i];
+			if(times[i] < mintime) mintime = times[i];
+			if(speeds[i-1] > maxspeed) maxspeed = speeds[i-1];
 		}
 		duration = maxtime - mintime;
 		avgspeed = (3.6 * distance) / duration;
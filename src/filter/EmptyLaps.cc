@@ -4,7 +4,7 @@ namespace filter
 {
 	REGISTER_FILTER(EmptyLaps);
 
-	void EmptyLaps::filter(Session *session, std::map<std::string, std::string> configuration)
+	void EmptyLaps::filter(Session *session, const Configuration &configuration)
 	{
 		std::vector<Lap*> &laps = session->getLaps();
 		for(auto it = laps.begin(); it != laps.end(); )
@@ -2,6 +2,7 @@
 #define _FILTER_FILTER_H
 
 #include "../Registry.h"
+#include "../Configuration.h"
 #include "../bom/Session.h"
 
 #define DECLARE_FILTER(FilterClass) static LayerRegistrer<Filter, FilterClass> _registrer;
@@ -13,7 +14,12 @@ namespace filter
 	{
 		public:
 			virtual ~Filter() = default;
-			virtual void filter(Session *session, std::map<std::string, std::string> configuration) = 0;
+			/**
+			 * Reads the options of the filter. Called once, before the filter is applied to any session.
+			 * @throw std::runtime_error if an option is invalid
+			 */
+			virtual void configure(const Configuration &configuration) { };
+			virtual void filter(Session *session, const Configuration &configuration) = 0;
 			virtual std::string getName() = 0;
 	};
 }
@@ -4,22 +4,48 @@
 #include <cstring>
 #include <list>
 #include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 #include <cstdlib>
-#include <unistd.h>
 
 namespace filter
 {
 	REGISTER_FILTER(FixElevation);
-	std::string FixElevation::HTTPdata;
 
-	size_t FixElevation::copyHTTPData(void *ptr, size_t size, size_t nmemb, FILE *stream)
+	namespace
 	{
-		HTTPdata.append((char*) ptr, size*nmemb);
+		// Limit to 10 queries per second, whatever the number of sessions filtered at the same time:
+		// https://developers.google.com/maps/documentation/elevation/#Limits
+		std::mutex requestMutex;
+		std::chrono::steady_clock::time_point nextRequest;
+
+		void waitForRequestSlot()
+		{
+			std::unique_lock<std::mutex> lock(requestMutex);
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			std::chrono::steady_clock::time_point slot = std::max(now, nextRequest);
+			nextRequest = slot + std::chrono::milliseconds(100);
+			lock.unlock();
+			std::this_thread::sleep_until(slot);
+		}
+	}
+
+	void FixElevation::configure(const Configuration &configuration)
+	{
+		_apiKey = configuration.get("google_api_key");
+		// Not thread safe, so done before sessions are filtered
+		curl_global_init(CURL_GLOBAL_DEFAULT);
+	}
+
+	size_t FixElevation::copyHTTPData(void *ptr, size_t size, size_t nmemb, void *HTTPdata)
+	{
+		static_cast<std::string*>(HTTPdata)->append((char*) ptr, size*nmemb);
 		return size*nmemb;
 	}
 
-	bool FixElevation::parseHTTPData(Session *session, std::vector<Point*>::iterator first, std::vector<Point*>::iterator last)
+	bool FixElevation::parseHTTPData(const std::string &HTTPdata, std::vector<Point*>::iterator first, std::vector<Point*>::iterator last, uint32_t &fixedPoints)
 	{
 		int elevation;
 		std::list<std::string> lines = splitString(HTTPdata, "\n");
@@ -43,7 +69,7 @@ namespace filter
 					elevation = atol(it->c_str());
 					if(!(*first)->getAltitude().isDefined() || elevation != (*first)->getAltitude())
 					{
-						++fixed_points;
+						++fixedPoints;
 						//std::cout << "Moving " << (*first)->getLatitude() << "," << (*first)->getLongitude() << " from " << (*first)->getAltitude();
 						(*first)->setAltitude(elevation);
 						//std::cout << " to " << (*first)->getAltitude() << std::endl;
@@ -78,11 +104,12 @@ namespace filter
 		return true;
 	}
 
-	void FixElevation::filter(Session *session, std::map<std::string, std::string> configuration)
+	void FixElevation::filter(Session *session, const Configuration &configuration)
 	{
 		CURL *curl;
 		CURLcode res;
-		fixed_points = 0;
+		uint32_t fixedPoints = 0;
+		std::string HTTPdata;
 
 		curl = curl_easy_init();
 		if(!curl)
@@ -93,6 +120,7 @@ namespace filter
 
 		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &FixElevation::copyHTTPData);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &HTTPdata);
 
 		std::vector<Point*> &points = session->getPoints();
 		//std::cout << "Retrieving elevation for " << points.size() << " points" << std::endl;
@@ -117,25 +145,26 @@ namespace filter
 				std::stringstream url;
 				std::string api_url = "maps.googleapis.com/maps/api/elevation/json?";
 				std::string api_params = "sensor=true&locations=";
-				if(configuration.find("google_api_key") == configuration.end())
+				if(_apiKey.empty())
 				{
 					url << "http://" << api_url << api_params;
 				}
 				else
 				{
-					url << "https://" << api_url << "key=" << configuration["google_api_key"] << "&" << api_params;
+					url << "https://" << api_url << "key=" << _apiKey << "&" << api_params;
 				}
 				url << urlparams.str();
 				//std::cout << "Doing a GET on " << url.str() << std::endl;
 
 				curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
+				waitForRequestSlot();
 				res = curl_easy_perform(curl);
 				if(res != CURLE_OK)
 				{
 					std::cout << "Error " << res << " when trying to get " << url.str() << std::endl;
 				}
 				request_last = it;
-				if(!parseHTTPData(session, request_first, request_last))
+				if(!parseHTTPData(HTTPdata, request_first, request_last, fixedPoints))
 				{
 					std::cout << "Error when parsing result of " << url.str() << std::endl;
 				}
@@ -144,15 +173,12 @@ namespace filter
 				request_first = it;
 				i = 0;
 				urlparams.str("");
-				// Limit to 10 queries per second:
-				// https://developers.google.com/maps/documentation/elevation/#Limits
-				usleep(100000);
 			}
 		}
 
 		/* always cleanup */
 		curl_easy_cleanup(curl);
-		std::cout << "    Fixed elevation of " << fixed_points << " points." << std::endl;
+		std::cout << "    Fixed elevation of " << fixedPoints << " points." << std::endl;
 	}
 }
 /* To reproduce:
@@ -8,14 +8,17 @@ namespace filter
 	class FixElevation : public Filter
 	{
 		public:
-			static size_t copyHTTPData(void *ptr, size_t size, size_t nmemb, FILE *stream);
-			bool parseHTTPData(Session *session, std::vector<Point*>::iterator first, std::vector<Point*>::iterator last);
-			void filter(Session *session, std::map<std::string, std::string> configuration) override;
+			// Appends the data received to the std::string given as last argument
+			static size_t copyHTTPData(void *ptr, size_t size, size_t nmemb, void *HTTPdata);
+			// Adds to fixedPoints the number of points whose elevation was fixed
+			bool parseHTTPData(const std::string &HTTPdata, std::vector<Point*>::iterator first, std::vector<Point*>::iterator last, uint32_t &fixedPoints);
+			void configure(const Configuration &configuration) override;
+			void filter(Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "FixElevation"; };
 
 		private:
-			static std::string HTTPdata;
-			uint32_t fixed_points;
+			// Empty when no key is configured
+			std::string _apiKey;
 			DECLARE_FILTER(FixElevation);
 	};
 }
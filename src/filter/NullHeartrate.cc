@@ -4,7 +4,7 @@ namespace filter
 {
 	REGISTER_FILTER(NullHeartrate);
 
-	void NullHeartrate::filter(Session *session, std::map<std::string, std::string> configuration)
+	void NullHeartrate::filter(Session *session, const Configuration &configuration)
 	{
 		// TODO: If first heartrates are 0, they will stay 0
 		uint16_t previousHeartrate = 0;
@@ -8,7 +8,7 @@ namespace filter
 	class NullHeartrate : public Filter
 	{
 		public:
-			void filter(Session *session, std::map<std::string, std::string> configuration) override;
+			void filter(Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "NullHeartrate"; };
 
 			DECLARE_FILTER(NullHeartrate);
@@ -1,126 +1,268 @@
 #include "ReducePoints.h"
 #include "../Utils.h"
+#include <algorithm>
 #include <cmath>
-#include <sstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_set>
 
 namespace filter
 {
 	REGISTER_FILTER(ReducePoints);
 
-	std::vector<Point*>::iterator removePoint(Session *session, std::vector<Point*>::iterator itToRemove, Point *previousKept)
+	namespace
 	{
-		Point *point = *itToRemove;
-		// Change lap boundary if it references the point
-		std::vector<Lap*> &laps = session->getLaps();
-		for(auto& lap : laps)
+		const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+		const double LOCKED = std::numeric_limits<double>::infinity();
+
+		// Points of the session linked to their previous and next kept points.
+		// Everything needed about a point is kept in a single node: points are
+		// visited in a random order so this saves many cache misses on long tracks.
+		class Track
 		{
-			if(lap->getStartPoint() == point)
-			{
-				lap->setStartPoint(previousKept);
-			}
-			if(lap->getEndPoint() == point)
-			{
-				lap->setEndPoint(previousKept);
-			}
-		}
+			public:
+				Track(const PointColumns &columns, uint32_t maxDistBetweenPoints);
 
-		// Remove point from list of points of the session
-		std::vector<Point*> &points = session->getPoints();
-		auto it = points.erase(itToRemove);
-		delete (point);
+				size_t size() const                { return _nodes.size(); };
+				size_t getNbKept() const           { return _nbKept; };
+				std::vector<bool> getRemoved() const;
+				void lock(size_t i)                { _nodes[i].locked = true; };
 
-		return it;
-	}
+				// Removes points closer than minDist to the previous kept one
+				void removeClosePoints(uint32_t minDist);
+				// Removes points until there are maxNbPoints left or no point can be removed
+				void simplify(size_t maxNbPoints);
 
-	void ReducePoints::filter(Session *session, std::map<std::string, std::string> configuration)
-	{
-		std::vector<Point*> &points = session->getPoints();
-		uint32_t nbPointsOri = points.size();
-		
-		uint32_t maxNbPoints = str_to_int(configuration["reduce_points_max"]);
-		if(maxNbPoints < 3) maxNbPoints = 3;
-		uint32_t minDistBetweenPoints = str_to_int(configuration["reduce_points_min_dist"]);
-		uint32_t maxDistBetweenPoints = str_to_int(configuration["reduce_points_max_dist"]);
-		// Arbitrary distance of 10k because session->getDistance() can return 0 in some cases
-		if(maxDistBetweenPoints == 0) maxDistBetweenPoints = 10000;
+			private:
+				struct Node
+				{
+					// Position on a plane (equirectangular projection)
+					double x;
+					double y;
+					double lat;
+					double lon;
+					double area;
+					uint32_t previous;
+					uint32_t next;
+					bool locked;
+					bool removed;
+				};
 
-		if(points.size() <= maxNbPoints) return;
+				double computeArea(const Node &node) const;
+				void remove(Node &node)
+				{
+					node.removed = true;
+					_nodes[node.previous].next = node.next;
+					_nodes[node.next].previous = node.previous;
+					--_nbKept;
+				}
 
-		// First pass: remove points that are too close
-		if(minDistBetweenPoints > 0)
+				DistanceEngine _engine;
+				uint32_t _maxDistBetweenPoints;
+				std::vector<Node> _nodes;
+				size_t _nbKept;
+		};
+
+		Track::Track(const PointColumns &columns, uint32_t maxDistBetweenPoints) :
+			_engine(columns.getDistanceEngine()), _maxDistBetweenPoints(maxDistBetweenPoints), _nodes(columns.size()), _nbKept(columns.size())
 		{
-			auto it = points.begin();
-			auto previousKept = it;
-			++it;
-			while(it != points.end())
+			const std::vector<double> &lat = columns.getLatitudes();
+			const std::vector<double> &lon = columns.getLongitudes();
+			double cosReference = cos(_engine.getReferenceLatitude() * DEG_TO_RAD);
+			// Points without position are considered at the position of the previous one
+			const Node *lastPosition = nullptr;
+			for(size_t i = 0; i < _nodes.size(); ++i)
 			{
-				if(distanceEarth(**previousKept, **it) >= minDistBetweenPoints)
+				Node &node = _nodes[i];
+				if(columns.isDefined(i, PointColumns::POSITION))
+				{
+					node.lat = lat[i];
+					node.lon = lon[i];
+					node.y = lat[i];
+					if(lastPosition == nullptr)
+					{
+						node.x = lon[i] * cosReference;
+					}
+					else
+					{
+						// Longitudes are unwrapped so that crossing the antimeridian does not make a jump
+						double longitudeArc = lon[i] - lastPosition->lon;
+						if(longitudeArc > 180) longitudeArc -= 360;
+						if(longitudeArc < -180) longitudeArc += 360;
+						node.x = lastPosition->x + longitudeArc * cosReference;
+					}
+					lastPosition = &node;
+				}
+				else if(lastPosition != nullptr)
 				{
-					previousKept = it;
-					++it;
+					node = *lastPosition;
 				}
 				else
 				{
-					it = removePoint(session, it, *previousKept);
+					node.x = node.y = node.lat = node.lon = 0;
 				}
+				node.area = LOCKED;
+				node.previous = i > 0 ? i - 1 : 0;
+				node.next = i + 1 < _nodes.size() ? i + 1 : i;
+				node.locked = false;
+				node.removed = false;
 			}
+			// First and last points are always kept
+			_nodes.front().locked = true;
+			_nodes.back().locked = true;
 		}
 
-		// Second pass: remove points that are 'nearly' aligned with the previous/next ones
-		uint32_t divider = 64;
-		while(points.size() > maxNbPoints && divider > 4)
+		std::vector<bool> Track::getRemoved() const
 		{
-			auto it = points.begin();
-			auto previousKept = it;
-			// Always keep the first point. Always OK because we verified that points.size() > maxNbPoints > 3
-			++it;
-			auto previousPoint = it;
-			++it;
-
-			// TODO: A method removePoint in Session would be nice !
-			while(it != points.end())
+			std::vector<bool> removed(_nodes.size());
+			for(size_t i = 0; i < _nodes.size(); ++i)
 			{
-				double orientation1 = 0;
-				double orientation2 = 0;
-				double lat1 = (*it)->getLatitude();
-				double lon1 = (*it)->getLongitude();
-				double lat2 = (*previousPoint)->getLatitude();
-				double lon2 = (*previousPoint)->getLongitude();
-				double lat3 = (*previousKept)->getLatitude();
-				double lon3 = (*previousKept)->getLongitude();
-				// TODO: Compare not only (pK, p) with (pP, p) but also (pK, pK+1) with (pK, p)
-				orientation1 = atan2(lat1 - lat2, lon1 - lon2);
-				orientation2 = atan2(lat1 - lat3, lon1 - lon3);
-				double dOrientation = fabs(orientation1 - orientation2);
-				double pi = 3.14159265358979323846;
-				// For cases where orientation1 ~= pi and orientation2 ~= -pi or reverse
-				if(dOrientation > pi) dOrientation -= 2*pi;
-				if(dOrientation < -pi) dOrientation += 2*pi;
-
-				// TODO: Arbitrary limit to determine in a smarter way ?
-				if(dOrientation < (pi / divider)
-				   && !(*previousPoint)->isImportant()
-				   && distanceEarth(**previousKept, **it) <= maxDistBetweenPoints)
+				removed[i] = _nodes[i].removed;
+			}
+			return removed;
+		}
+
+		void Track::removeClosePoints(uint32_t minDist)
+		{
+			const Node *previousKept = &_nodes.front();
+			for(size_t i = 1; i < _nodes.size(); ++i)
+			{
+				Node &node = _nodes[i];
+				if(node.locked || _engine.distance(previousKept->lat, previousKept->lon, node.lat, node.lon) >= minDist)
 				{
-					previousPoint = removePoint(session, previousPoint, *previousKept);
-					it = previousPoint;
+					previousKept = &node;
 				}
 				else
 				{
-					previousKept = previousPoint;
-					previousPoint = it;
+					remove(node);
+				}
+			}
+		}
+
+		/**
+		 * Importance of a point for Visvalingam-Whyatt algorithm: area of the triangle it makes with
+		 * its kept neighbours. Points that must be kept, or whose removal would create a segment longer
+		 * than the maximum distance, get LOCKED.
+		 */
+		double Track::computeArea(const Node &node) const
+		{
+			if(node.locked)
+			{
+				return LOCKED;
+			}
+			const Node &previous = _nodes[node.previous];
+			const Node &next = _nodes[node.next];
+			if(_engine.distance(previous.lat, previous.lon, next.lat, next.lon) > _maxDistBetweenPoints)
+			{
+				return LOCKED;
+			}
+			double cross = (node.x - previous.x) * (next.y - previous.y) - (next.x - previous.x) * (node.y - previous.y);
+			return fabs(cross) / 2;
+		}
+
+		void Track::simplify(size_t maxNbPoints)
+		{
+			// Heap of candidates for removal, smallest area first. Entries whose area is not the
+			// current one of the point (because a neighbour was removed since) are skipped.
+			typedef std::pair<double, uint32_t> Candidate;
+			std::vector<Candidate> candidates;
+			candidates.reserve(_nbKept);
+			for(size_t i = 1; i + 1 < _nodes.size(); ++i)
+			{
+				Node &node = _nodes[i];
+				if(!node.removed && !node.locked)
+				{
+					node.area = computeArea(node);
+					candidates.push_back(Candidate(node.area, i));
+				}
+			}
+			std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > heap(std::greater<Candidate>(), std::move(candidates));
+			while(_nbKept > maxNbPoints && !heap.empty())
+			{
+				Candidate candidate = heap.top();
+				heap.pop();
+				Node &node = _nodes[candidate.second];
+				if(node.removed || candidate.first != node.area)
+				{
+					continue;
+				}
+				if(candidate.first == LOCKED)
+				{
+					break;
+				}
+				remove(node);
+				for(uint32_t neighbour : { node.previous, node.next })
+				{
+					Node &neighbourNode = _nodes[neighbour];
+					if(!neighbourNode.locked)
+					{
+						// A neighbour never becomes less important than the point just removed
+						neighbourNode.area = std::max(computeArea(neighbourNode), candidate.first);
+						heap.push(Candidate(neighbourNode.area, neighbour));
+					}
 				}
-				++it;
 			}
-			divider--;
 		}
-		if(points.size() > maxNbPoints)
+	}
+
+	void ReducePoints::configure(const Configuration &configuration)
+	{
+		_options = Options();
+		_options.maxNbPoints = std::max(configuration.getUInt("reduce_points_max"), _options.maxNbPoints);
+		_options.minDistBetweenPoints = configuration.getUInt("reduce_points_min_dist");
+		// Arbitrary distance of 10k because session->getDistance() can return 0 in some cases
+		uint32_t maxDistBetweenPoints = configuration.getUInt("reduce_points_max_dist");
+		if(maxDistBetweenPoints != 0) _options.maxDistBetweenPoints = maxDistBetweenPoints;
+	}
+
+	void ReducePoints::filter(Session *session, const Configuration &configuration)
+	{
+		uint32_t nbPointsOri = session->getPoints().size();
+		uint32_t maxNbPoints = _options.maxNbPoints;
+		uint32_t minDistBetweenPoints = _options.minDistBetweenPoints;
+		uint32_t maxDistBetweenPoints = _options.maxDistBetweenPoints;
+
+		if(nbPointsOri <= maxNbPoints) return;
+
+		Track track(session->getColumns(), maxDistBetweenPoints);
+
+		// Important points and lap boundaries are always kept
+		std::unordered_set<const Point*> boundaries;
+		for(const auto& lap : session->getLaps())
+		{
+			boundaries.insert(lap->getStartPoint());
+			boundaries.insert(lap->getEndPoint());
+		}
+		const std::vector<Point*> &points = static_cast<const Session*>(session)->getPoints();
+		for(size_t i = 0; i < points.size(); ++i)
+		{
+			if(points[i]->isImportant() || boundaries.count(points[i]) != 0)
+			{
+				track.lock(i);
+			}
+		}
+
+		// First pass: remove points that are too close to the previous kept one
+		if(minDistBetweenPoints > 0)
+		{
+			track.removeClosePoints(minDistBetweenPoints);
+		}
+
+		// Second pass (Visvalingam-Whyatt): remove the point that makes the smallest triangle with
+		// its neighbours until there are maxNbPoints left
+		track.simplify(maxNbPoints);
+
+		// Important points and lap boundaries being locked, laps are left unchanged
+		session->removePoints(track.getRemoved());
+
+		if(track.getNbKept() > maxNbPoints)
 		{
-			std::cout << "Oups ! Tried to reduce the number of points as much as possible but there are still more than " << maxNbPoints << " (" << points.size() << ") !" << std::endl;
+			std::cout << "Oups ! Tried to reduce the number of points as much as possible but there are still more than " << maxNbPoints << " (" << track.getNbKept() << ") !" << std::endl;
 		}
 		else
 		{
-			std::cout << "    Reduced session from " << nbPointsOri << " to " << points.size() << " points (min angle = pi/" << divider << ")." << std::endl;
+			std::cout << "    Reduced session from " << nbPointsOri << " to " << track.getNbKept() << " points." << std::endl;
 		}
 	}
 }
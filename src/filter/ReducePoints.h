@@ -8,10 +8,20 @@ namespace filter
 	class ReducePoints : public Filter
 	{
 		public:
-			void filter(Session *session, std::map<std::string, std::string> configuration) override;
+			void configure(const Configuration &configuration) override;
+			void filter(Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "ReducePoints"; };
 
 		private:
+			struct Options
+			{
+				Options() : maxNbPoints(3), minDistBetweenPoints(0), maxDistBetweenPoints(10000) { };
+				uint32_t maxNbPoints;
+				uint32_t minDistBetweenPoints;
+				uint32_t maxDistBetweenPoints;
+			};
+
+			Options _options;
 			DECLARE_FILTER(ReducePoints);
 	};
 }
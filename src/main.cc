@@ -3,29 +3,37 @@
 #include <cstring>
 #include <ctime>
 #include <map>
+#include <unordered_set>
 #include <vector>
 #include <list>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
 #include <iterator>
+#include <memory>
 #include <unistd.h>
 
 #include "source/Logger.h"
 #include "source/USB.h"
 #include "source/File.h"
 #include "source/HexdumpFile.h"
-#include "bom/Session.h"
+#include "source/Emulator.h"
+#include "source/TransactionLog.h"
+#include "bom/SessionsMap.h"
 #include "device/Device.h"
 #include "filter/Filter.h"
 #include "output/Output.h"
 #include "Registry.h"
+#include "Configuration.h"
+#include "Pipeline.h"
+#include "ThreadPool.h"
+#include "ImportLedger.h"
 #include "Utils.h"
 
 #undef LOG_VERBOSE
-#define LOG_VERBOSE(x) if(configuration["verbose"] == "true") { std::cout << __FILE__ << ":" << __LINE__ << ": " << x << std::endl; };  // NOLINT: parenthesis around 'x' would prevent using << in THROW_STREAM
+#define LOG_VERBOSE(x) if(configuration.isVerbose()) { std::cout << __FILE__ << ":" << __LINE__ << ": " << x << std::endl; };  // NOLINT: parenthesis around 'x' would prevent using << in THROW_STREAM
 
-std::map<std::string, std::string> configuration;
+Configuration configuration;
 
 // TODO: move as much functions as possible in src/Utils or another separated file - unit test them
 bool checkAndCreateDir(const std::string& path)
@@ -38,7 +46,7 @@ bool checkAndCreateDir(const std::string& path)
 
 void usage(char *progname)
 {
-	std::cout << "Usage: " << progname << " [ -h | [ -v ] [ -c <rc_file> ] [ -d <output_directory> ] [ -f <filters> ] [-D <device> ] [ -i <input_file> ] [ -o <outputs> ] [ -t <trigger_type> ] ]" << std::endl;
+	std::cout << "Usage: " << progname << " [ -h | [ -v ] [ -c <rc_file> ] [ -d <output_directory> ] [ -f <filters> ] [-D <device> ] [ -i <input_file> ] [ -j <jobs> ] [ -o <outputs> ] [ -t <trigger_type> ] | -L <log_file> ]" << std::endl;
 	std::cout << "  - h: help:        Show this help message " << std::endl;
 	std::cout << "  - v: verbose:     Print some debug messages " << std::endl;
 	std::cout << "  - c: conf file:   Provide alternate configuration file instead of ~/.kalenji_readerrc" << std::endl;
@@ -47,15 +55,17 @@ void usage(char *progname)
 	std::cout << "  - D: device:      Type of device to use (e.g: GPX, Kalenji, OnMove710)" << std::endl;
 	std::cout << "  - p: path:        Folder path for file-based access device (mass-storage device like OnMove710)" << std::endl;
 	std::cout << "  - i: input file:  Provide input file instead of reading from device" << std::endl;
+	std::cout << "  - j: jobs:        Number of sessions filtered and exported in parallel (0 for one per core)" << std::endl;
 	std::cout << "  - o: outputs:     Comma separated list of output formats to produce for each session." << std::endl;
 	std::cout << "  - t: trigger:     Override the type of trigger (possible values: manual, distance, time, location, hr)" << std::endl;
+	std::cout << "  - L: convert log: Convert a transaction log from binary to text format or from text to binary format, then exit" << std::endl;
 }
 
 std::map<std::string, std::string> readOptions(int argc, char **argv)
 {
 	std::map<std::string, std::string> options;
 	int option;
-	while((option = getopt(argc, argv, ":c:d:f:D:p:i:o:t:vh")) != -1)
+	while((option = getopt(argc, argv, ":c:d:f:D:p:i:j:L:o:t:vh")) != -1)
 	{
 		switch(option)
 		{
@@ -85,6 +95,12 @@ std::map<std::string, std::string> readOptions(int argc, char **argv)
 				options["source"] = "File";
 				options["sourcefile"] = std::string(optarg);
 				break;
+			case 'j':
+				options["jobs"] = std::string(optarg);
+				break;
+			case 'L':
+				options["convert_log"] = std::string(optarg);
+				break;
 			case 'o':
 				options["outputs"] = std::string(optarg);
 				break;
@@ -106,27 +122,39 @@ std::map<std::string, std::string> readOptions(int argc, char **argv)
 	return options;
 }
 
-bool readConf(std::map<std::string, std::string>& options)
+bool readConf(std::map<std::string, std::string>& options, std::map<std::string, std::string>& values)
 {
 	// Default conf
 	#ifdef WINDOWS
-	configuration["directory"] = "c:\\tmp\\kalenji_import";
+	values["directory"] = "c:\\tmp\\kalenji_import";
 	#else
-	configuration["directory"] = "/tmp/kalenji_import";
+	values["directory"] = "/tmp/kalenji_import";
 	#endif
-	configuration["import"] = "new";
-	configuration["trigger"] = "manual";
-	configuration["log_transactions"] = "yes";
-	configuration["source"] = "USB";
-	configuration["device"] = "auto";
-	configuration["filters"] = "UnreliablePoints,EmptyLaps";
-	configuration["outputs"] = "GPX,GoogleMap";
-	configuration["output_name"] = "date";
-	configuration["gpx_extensions"] = "gpxdata";
-	configuration["tcx_sport"] = "Running";
-	configuration["reduce_points_max"] = "200";
-	configuration["verbose"] = "false";
-	configuration["google_map_height"] = "500";
+	values["import"] = "new";
+	values["trigger"] = "manual";
+	values["log_transactions"] = "yes";
+	values["log_transactions_format"] = "text";
+	values["source"] = "USB";
+	values["device"] = "auto";
+	values["filters"] = "UnreliablePoints,EmptyLaps";
+	values["outputs"] = "GPX,GoogleMap";
+	values["output_name"] = "date";
+	values["gpx_extensions"] = "gpxdata";
+	values["tcx_sport"] = "Running";
+	values["reduce_points_max"] = "200";
+	values["distance_method"] = "haversine";
+	values["verbose"] = "false";
+	values["google_map_height"] = "500";
+	values["jobs"] = "0";
+	values["usb_queued_transfers"] = "0";
+	values["prefetch_depth"] = "4";
+	values["gpx_fast_parser"] = "yes";
+	values["emulator"] = "no";
+	values["emulator_timing"] = "none";
+	values["emulator_latency"] = "0";
+	values["emulator_jitter"] = "0";
+	values["emulator_seed"] = "0";
+	values["emulator_strict"] = "no";
 	// Default value for log_transactions_directory is defined later (depends on directory)
 	// TODO: Check that content of file is correct (i.e key is already in the map, except for log_transactions_directory that we define later if given ?)
 
@@ -167,7 +195,7 @@ bool readConf(std::map<std::string, std::string>& options)
 					std::string value = line.substr(cut_place+1);
 					trimString(key);
 					trimString(value);
-					configuration[key] = value;
+					values[key] = value;
 				}
 			}
 			conf_file.close();
@@ -181,7 +209,7 @@ bool readConf(std::map<std::string, std::string>& options)
 	// Now override configuration with options given by the users
 	for(const auto& option : options)
 	{
-		configuration[option.first] = option.second;
+		values[option.first] = option.second;
 	}
 	return true;
 }
@@ -189,31 +217,55 @@ bool readConf(std::map<std::string, std::string>& options)
 bool parseConfAndOptions(int argc, char** argv)
 {
 	std::map<std::string, std::string> options = readOptions(argc, argv);
-	readConf(options);
+	std::map<std::string, std::string> values;
+	readConf(options, values);
 
 	// Some configuration adaptation ...
 	// TODO: Cleaner way to handle it ?
-	if(configuration.count("log_transactions_directory") == 0)
+	if(values.count("log_transactions_directory") == 0)
 	{
-		configuration["log_transactions_directory"] = configuration["directory"] + "/logs";
+		values["log_transactions_directory"] = values["directory"] + "/logs";
 	}
-	if(configuration["source"] == "File")
+	if(values.count("import_ledger") == 0)
+	{
+		values["import_ledger"] = values["directory"] + "/.kalenji_imports";
+	}
+	if(values["source"] == "File")
 	{
 		// When using a file as input, we don't want the user to be prompted as we read everything and ignore all sending
-		configuration["import"] = "all";
+		values["import"] = "all";
+		// Nothing to import incrementally from a one-off conversion, and sessions of GPX files have no id to record
+		values["import_ledger"] = "";
 	}
 	// TODO: Find a better way to handle this (maybe a callback of device ?)
-	if(configuration["source"] == "File" && configuration["device"] != "GPX" && configuration["device"] != "TCX")
+	if(values["source"] == "File" && values["device"] != "GPX" && values["device"] != "TCX")
 	{
-		configuration["source"] = "HexdumpFile";
+		values["source"] = "HexdumpFile";
 	}
+	// Values are converted and checked once for all
+	configuration = Configuration(values);
 	return true;
 }
 
-std::string filterSessionsToImport(SessionsMap *sessions, std::list<std::string> &outputs)
+// Lets the filters and outputs that will be used read their options
+void configureLayers()
+{
+	for(const auto& filterName : splitString(configuration.get("filters")))
+	{
+		filter::Filter *filter = LayerRegistry<filter::Filter>::getInstance()->getObject(filterName);
+		if(filter) filter->configure(configuration);
+	}
+	for(const auto& outputName : splitString(configuration.get("outputs")))
+	{
+		output::Output *output = LayerRegistry<output::Output>::getInstance()->getObject(outputName);
+		if(output) output->configure(configuration);
+	}
+}
+
+std::string filterSessionsToImport(SessionsMap *sessions, std::list<std::string> &outputs, const ImportLedger *ledger, const std::string &deviceName)
 {
 	std::string to_import_string;
-	if(configuration["import"] == "ask")
+	if(configuration.get("import") == "ask")
 	{
 		// Display sessions that can be imported, prompt for list of sessions to import
 		std::cout << "Sessions available for import:" << std::endl;
@@ -232,7 +284,7 @@ std::string filterSessionsToImport(SessionsMap *sessions, std::list<std::string>
 	}
 	else
 	{
-		to_import_string = configuration["import"];
+		to_import_string = configuration.get("import");
 	}
 	if(to_import_string == "new")
 	{
@@ -240,41 +292,49 @@ std::string filterSessionsToImport(SessionsMap *sessions, std::list<std::string>
 		for(const auto& session : *sessions)
 		{
 			bool import = false;
-			for(const auto& outputName : outputs)
+			if(ledger != nullptr && ledger->has(deviceName, session.first))
+			{
+				import = !ledger->isImported(deviceName, session.first, session.second.getFingerprint(), outputs);
+			}
+			else
 			{
-				output::Output *output = LayerRegistry<output::Output>::getInstance()->getObject(outputName);
-				if(output && !output->exists(&(session.second), configuration))
+				// Not in the ledger (imported by an older version, or the ledger is disabled): look for the output files
+				for(const auto& outputName : outputs)
 				{
-					to_import << " " << session.second.getNum();
-					import = true;
-					break;
+					output::Output *output = LayerRegistry<output::Output>::getInstance()->getObject(outputName);
+					if(output && !output->exists(&(session.second), configuration))
+					{
+						import = true;
+						break;
+					}
 				}
 			}
-			if(!import)
+			if(import)
+				to_import << " " << session.second.getNum();
+			else
 				std::cout << " session " << session.second.getNum() << " already imported" << std::endl;
 		}
 		to_import_string = to_import.str();
 	}
 	if(to_import_string != "all")
 	{
-		std::vector<uint32_t> to_import;
+		std::unordered_set<uint32_t> to_import;
 		std::stringstream iss(to_import_string);
-		std::copy(std::istream_iterator<uint32_t>(iss), std::istream_iterator<uint32_t>(), std::back_inserter(to_import));
+		std::copy(std::istream_iterator<uint32_t>(iss), std::istream_iterator<uint32_t>(), std::inserter(to_import, to_import.end()));
 
 		// TODO: Check for error in user entry. Re-ask if there is one !
+		for(uint32_t num : to_import)
+		{
+			if(sessions->findByNum(num) == sessions->end())
+			{
+				std::cerr << "Warning: no session " << num << " to import" << std::endl;
+			}
+		}
 
 		// Remove sessions that are not in the list of selected sessions
 		for(auto it = sessions->begin(); it != sessions->end(); )
 		{
-			bool keep = false;
-			for(uint32_t id : to_import)
-			{
-				if(it->second.getNum() == id)
-				{
-					keep = true;
-				}
-			}
-			if(!keep) sessions->erase(it++);
+			if(to_import.count(it->second.getNum()) == 0) it = sessions->erase(it);
 			else ++it;
 		}
 	}
@@ -287,31 +347,64 @@ int main(int argc, char *argv[])
 	{
 		if(!parseConfAndOptions(argc, argv)) return -1;
 		LOG_VERBOSE("Configuration parsed");
+		if(configuration.has("convert_log"))
+		{
+			std::string converted = source::convertTransactionLog(configuration.get("convert_log"));
+			std::cout << "Converted " << configuration.get("convert_log") << " to " << converted << std::endl;
+			return 0;
+		}
+		configureLayers();
 
 		// First attempt, creating dir if it doesn't exist
-		if(!checkAndCreateDir(configuration["directory"])) return -1;
-		LOG_VERBOSE("Create output directory '" << configuration["directory"] << "'");
+		if(!checkAndCreateDir(configuration.getDirectory())) return -1;
+		LOG_VERBOSE("Create output directory '" << configuration.getDirectory() << "'");
 
 		// TODO: Use registry for source too
 		source::Source *dataSource = nullptr;
-		if(configuration["source"] == "File")
+		// Owned here so that the transactions logged so far are written even if the import fails
+		std::unique_ptr<source::Logger> logger;
+		source::USB *usbSource = nullptr;
+		if(configuration.get("source") == "File")
 		{
 			LOG_VERBOSE("Source is File");
-			dataSource = new source::File(configuration["sourcefile"]);
+			dataSource = new source::File(configuration.get("sourcefile"));
 		}
-		else if(configuration["source"] == "HexdumpFile")
+		else if(configuration.get("source") == "HexdumpFile" && !configuration.getBool("emulator"))
 		{
 			LOG_VERBOSE("Source is HexdumpFile");
-			dataSource = new source::HexdumpFile(configuration["sourcefile"]);
+			dataSource = new source::HexdumpFile(configuration.get("sourcefile"));
+		}
+		else if(configuration.get("source") == "HexdumpFile")
+		{
+			LOG_VERBOSE("Source is Emulator");
+			source::EmulatorTiming timing;
+			const std::string& timingMode = configuration.get("emulator_timing");
+			if(timingMode == "none") timing.mode = source::EMULATOR_TIMING_NONE;
+			else if(timingMode == "fixed") timing.mode = source::EMULATOR_TIMING_FIXED;
+			else if(timingMode == "recorded") timing.mode = source::EMULATOR_TIMING_RECORDED;
+			else
+			{
+				THROW_STREAM("Unknown emulator_timing '" << timingMode << "', expected none, fixed or recorded");
+			}
+			timing.latency = configuration.getUInt("emulator_latency");
+			timing.jitter = configuration.getUInt("emulator_jitter");
+			timing.seed = configuration.getUInt("emulator_seed");
+			dataSource = new source::Emulator(configuration.get("sourcefile"), timing, configuration.getBool("emulator_strict"));
 		}
-		else if(configuration["source"] == "USB")
+		else if(configuration.get("source") == "USB")
 		{
 			LOG_VERBOSE("Source is USB");
-			dataSource = new source::USB();
-			if(configuration["log_transactions"] == "yes")
+			usbSource = new source::USB();
+			dataSource = usbSource;
+			if(configuration.getBool("log_transactions"))
 			{
 				LOG_VERBOSE("With transaction logger");
-				if(!checkAndCreateDir(configuration["log_transactions_directory"])) return -1;
+				const std::string& logFormat = configuration.get("log_transactions_format");
+				if(logFormat != "binary" && logFormat != "text")
+				{
+					THROW_STREAM("Unknown log_transactions_format '" << logFormat << "', expected binary or text");
+				}
+				if(!checkAndCreateDir(configuration.get("log_transactions_directory"))) return -1;
 
 				// Create log file name
 				// TODO: Improve ?
@@ -319,16 +412,18 @@ int main(int argc, char *argv[])
 				time_t t = time(nullptr);
 				strftime(buffer, 256, "%Y%m%d_%H%M%S", localtime(&t));
 				std::stringstream log_filename;
-				log_filename << configuration["log_transactions_directory"] << "/" << "kalenji_reader_" << buffer << ".log";
+				log_filename << configuration.get("log_transactions_directory") << "/" << "kalenji_reader_" << buffer << (logFormat == "binary" ? ".klog" : ".log");
 
-				dataSource = new source::Logger(dataSource, log_filename.str());
+				logger.reset(new source::Logger(dataSource, log_filename.str(), logFormat == "binary" ? source::LOG_BINARY : source::LOG_TEXT));
+				dataSource = logger.get();
 			}
 		}
 
 		// Auto detection of device
-		if(configuration["device"] == "auto")
+		std::string deviceName = configuration.get("device");
+		if(deviceName == "auto")
 		{
-			if(configuration["source"] == "USB")
+			if(configuration.get("source") == "USB")
 			{
 				LOG_VERBOSE("Auto-detecting device");
 				libusb_context *myUSBContext;
@@ -350,16 +445,16 @@ int main(int argc, char *argv[])
 						auto deviceId = device.second->getDeviceId();
 						if(deviceId.vendorId == deviceDescriptor.idVendor && deviceId.productId == deviceDescriptor.idProduct)
 						{
-							configuration["device"] = device.second->getName();
+							deviceName = device.second->getName();
 						}
 					}
 				}
-				if(configuration["device"] == "auto")
+				if(deviceName == "auto")
 				{
 					std::cerr << "No known USB device found." << std::endl;
 					return 1;
 				}
-				LOG_VERBOSE("Auto-detected " << configuration["device"]);
+				LOG_VERBOSE("Auto-detected " << deviceName);
 			}
 			else
 			{
@@ -369,27 +464,61 @@ int main(int argc, char *argv[])
 		}
 
 		LOG_VERBOSE("Registering device");
-		device::Device *myDevice = LayerRegistry<device::Device>::getInstance()->getObject(configuration["device"]);
+		device::Device *myDevice = LayerRegistry<device::Device>::getInstance()->getObject(deviceName);
 		if(myDevice == nullptr)
 		{
-			std::cerr << "Error trying to register device " << configuration["device"] << ": Unknown device" << std::endl;
+			std::cerr << "Error trying to register device " << deviceName << ": Unknown device" << std::endl;
 			throw std::exception();
 		}
 		LOG_VERBOSE("Attaching source to device");
 		myDevice->setSource(dataSource);
 		myDevice->setConfiguration(configuration);
+		// Shared by the device and the pipeline: decoding, filtering and exporting sessions keep at most jobs threads busy
+		ThreadPool pool(configuration.getJobs());
+		myDevice->setThreadPool(&pool);
+		std::unique_ptr<ImportLedger> ledger;
+		if(!configuration.get("import_ledger").empty())
+		{
+			ledger.reset(new ImportLedger(configuration.get("import_ledger")));
+			if(configuration.get("import") == "new")
+			{
+				myDevice->setImportLedger(ledger.get());
+			}
+		}
+		if(usbSource != nullptr && myDevice->canQueueReads())
+		{
+			usbSource->setQueuedReads(configuration.getUInt("usb_queued_transfers"));
+		}
 		LOG_VERBOSE("Initializing device");
 		myDevice->init(myDevice->getDeviceId());
 		LOG_VERBOSE("Device initialized");
 		SessionsMap sessions;
 		LOG_VERBOSE("Get sessions list");
 		myDevice->getSessionsList(&sessions);
+		for(auto& session : sessions)
+		{
+			// Taken before the details are read and the session is filtered
+			if(session.second.getFingerprint() == 0)
+			{
+				session.second.setFingerprint(ImportLedger::summaryFingerprint(session.second));
+			}
+		}
 
 		// If import = ask, prompt the user for sessions to import.
 		// TODO: also prompt here for trigger type (and other info not found in the watch ?). This means at session level instead of global but could also be at lap level !
-		std::list<std::string> outputs = splitString(configuration["outputs"]);
+		std::list<std::string> outputs = splitString(configuration.get("outputs"));
 		LOG_VERBOSE("Filter out sessions");
-		std::string to_import = filterSessionsToImport(&sessions, outputs);
+		std::string to_import = filterSessionsToImport(&sessions, outputs, ledger.get(), deviceName);
+
+		// Sessions are filtered and exported as soon as the device has read them
+		std::list<std::string> filters = splitString(configuration.get("filters"));
+		DistanceMethod distanceMethod = configuration.getDistanceMethod();
+		Pipeline pipeline(configuration, filters, outputs, pool);
+		myDevice->setSessionListener([&pipeline, distanceMethod](Session *session)
+		{
+			session->setDistanceMethod(distanceMethod);
+			pipeline.add(session);
+		});
 
 		LOG_VERBOSE("Get sessions details");
 		myDevice->getSessionsDetails(&sessions);
@@ -401,56 +530,34 @@ int main(int argc, char *argv[])
 		{
 			LOG_VERBOSE("Release datasource");
 			dataSource->release();
-			delete dataSource;
+			if(dataSource != logger.get()) delete dataSource;
 		}
+		logger.reset();
 
-		// TODO: Cleaner, modular way to include it ?
-		// Remove empty sessions, most likely they were not imported when using a file so we don't want to export them
-		for(auto it = sessions.begin(); it != sessions.end(); )
-		{
-			if(it->second.getPoints().empty())
-				sessions.erase(it++);
-			else ++it;
-		}
-
-		std::list<std::string> filters = splitString(configuration["filters"]);
-
+		// Sessions the device didn't give to the pipeline while reading them
 		for(auto& session : sessions)
 		{
-			for(const auto& filterName : filters)
+			if(!pipeline.contains(&(session.second)))
 			{
-				filter::Filter *filter = LayerRegistry<filter::Filter>::getInstance()->getObject(filterName);
-				if(filter)
-				{
-					std::cout << "  Applying filter " << filterName << std::endl;
-					filter->filter(&(session.second), configuration);
-				}
-				else
-				{
-					std::cout << "Filter does not exist: " << filterName << std::endl;
-				}
+				session.second.setDistanceMethod(distanceMethod);
+				pipeline.add(&(session.second));
 			}
-			for(const auto& outputName : outputs)
+		}
+		pipeline.finish();
+
+		if(ledger)
+		{
+			for(const auto& session : sessions)
 			{
-				output::Output *output = LayerRegistry<output::Output>::getInstance()->getObject(outputName);
-				if(output)
-				{
-					try
-					{
-						output->dump(&(session.second), configuration);
-					}
-					catch(std::exception &e)
-					{
-						std::cerr << "Error: couldn't export to output " << outputName << ":" << e.what() << std::endl;
-					}
-				}
-				else
+				// Only the outputs that succeeded are recorded, so that the others are retried next time.
+				// Sessions without id can't be told apart.
+				const std::list<std::string> &exported = pipeline.getExported(&(session.second));
+				if(!exported.empty() && !session.first.empty())
 				{
-					std::cout << "Output does not exist: " << outputName << std::endl;
+					ledger->record(deviceName, session.first, session.second.getFingerprint(), exported);
 				}
 			}
 		}
-
 		sessions.clear();
 
 		return 0;
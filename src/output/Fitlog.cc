@@ -8,59 +8,57 @@ namespace output
 {
 	REGISTER_OUTPUT(Fitlog);
 
-	void Fitlog::dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration)
+	void Fitlog::dumpContent(Writer &out, const Session *session, const Configuration &configuration)
 	{
 		// Latitude and longitude retrieved from the GPS has 6 decimals and can habe 2 digits before decimal point
 		out.precision(8);
-		out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
-		out << "<FitnessWorkbook xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns=\"http://www.zonefivesoftware.com/xmlschemas/FitnessLogbook/v2\">" << std::endl;
-		out << " <AthleteLog>" << std::endl;
-		out << "  <Athlete />" << std::endl;
-		out << "  <Activity StartTime=\"" << session->getBeginTime() << "\">" << std::endl;
-		out << "   <Duration TotalSeconds=\"" << session->getDuration() << "\" />" << std::endl;
-		out << "   <Distance TotalMeters=\"" << session->getDistance() << "\" />" << std::endl;
+		out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+		out << "<FitnessWorkbook xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns=\"http://www.zonefivesoftware.com/xmlschemas/FitnessLogbook/v2\">\n";
+		out << " <AthleteLog>\n";
+		out << "  <Athlete />\n";
+		out << "  <Activity StartTime=\"" << session->getBeginTime() << "\">\n";
+		out << "   <Duration TotalSeconds=\"" << session->getDuration() << "\" />\n";
+		out << "   <Distance TotalMeters=\"" << session->getDistance() << "\" />\n";
 		if(session->getAvgHeartrate().isDefined() || session->getMaxHeartrate().isDefined())
 		{
 			out << "   <HeartRate ";
-			out << session->getAvgHeartrate().toStream("AverageBPM=\"", "\" ");
-			out << session->getMaxHeartrate().toStream("MaximumBPM=\"", "\" ");
-			out << "/>" << std::endl;
+			out << ifDefined(session->getAvgHeartrate(), "AverageBPM=\"", "\" ");
+			out << ifDefined(session->getMaxHeartrate(), "MaximumBPM=\"", "\" ");
+			out << "/>\n";
 		}
-		out << "   <Laps>" << std::endl;
+		out << "   <Laps>\n";
 		std::vector<Lap*> laps = session->getLaps();
+		TimeCodec timeCodec;
+		char time[TimeCodec::FORMAT_BUFFER_SIZE];
 		for(const auto& lap : laps)
 		{
-			out << "    <Lap StartTime=\"" << lap->getStartPoint()->getTimeAsString() << "\" DurationSeconds=\"" << lap->getDuration() << "\" >" << std::endl;
-			out << "     <Distance TotalMeters=\"" << lap->getDistance() << "\" />" << std::endl;
-			out << lap->getAvgHeartrate().toStream("     <HeartRate AverageBPM=\"", "\" />\n");
-			out << lap->getCalories().toStream("     <Calories TotalCal=\"", "\" />\n");
-			out << "    </Lap>" << std::endl;
+			timeCodec.format(lap->getStartPoint()->getTime(), lap->getStartPoint()->getMillis(), time);
+			out << "    <Lap StartTime=\"" << time << "\" DurationSeconds=\"" << lap->getDuration() << "\" >\n";
+			out << "     <Distance TotalMeters=\"" << lap->getDistance() << "\" />\n";
+			out << ifDefined(lap->getAvgHeartrate(), "     <HeartRate AverageBPM=\"", "\" />\n");
+			out << ifDefined(lap->getCalories(), "     <Calories TotalCal=\"", "\" />\n");
+			out << "    </Lap>\n";
 		}
-		out << "   </Laps>" << std::endl;
+		out << "   </Laps>\n";
 
 		// TODO: Verify the format !
-		out << "   <Track StartTime=\"" << session->getBeginTime() << "\">" << std::endl;
-		std::vector<Point*> points = session->getPoints();
-		time_t prev_time = (*points.begin())->getTime();
-		time_t first_time = (*points.begin())->getTime();
-		double total_dist = 0;
+		out << "   <Track StartTime=\"" << session->getBeginTime() << "\">\n";
+		const PointColumns &points = session->getColumns();
+		const std::vector<double> &distances = points.getCumulativeDistances();
+		const std::vector<double> &elapsed = points.getElapsedSeconds();
 		for(const auto& point : points)
 		{
-			double tm = difftime(point->getTime(), first_time);
-			double delta_tm = difftime(point->getTime(), prev_time);
-			total_dist += delta_tm * point->getSpeed() / 3.6;
-			out << "    <pt tm=\"" << (int) tm << "\" dist=\"" << total_dist << "\" ";
-			out << point->getHeartRate().toStream("hr=\"", "\" ");
-			out << point->getLatitude().toStream("lat=\"", "\" ");
-			out << point->getLongitude().toStream("lon=\"", "\" ");
-			out << point->getAltitude().toStream("ele=\"", "\" ");
-			out << "/>" << std::endl;
-			prev_time = point->getTime();
+			out << "    <pt tm=\"" << (int) elapsed[point.getIndex()] << "\" dist=\"" << distances[point.getIndex()] << "\" ";
+			out << ifDefined(point.getHeartRate(), "hr=\"", "\" ");
+			out << ifDefined(point.getLatitude(), "lat=\"", "\" ");
+			out << ifDefined(point.getLongitude(), "lon=\"", "\" ");
+			out << ifDefined(point.getAltitude(), "ele=\"", "\" ");
+			out << "/>\n";
 		}
-		out << "   </Track>" << std::endl;
-		out << "  </Activity>" << std::endl;
-		out << " </AthleteLog>" << std::endl;
-		out << "</FitnessWorkbook>" << std::endl;
+		out << "   </Track>\n";
+		out << "  </Activity>\n";
+		out << " </AthleteLog>\n";
+		out << "</FitnessWorkbook>\n";
 		// TODO: footer
 	}
 }
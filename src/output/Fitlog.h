@@ -1,5 +1,5 @@
-#ifndef _OUTPUT_GPX_HPP_
-#define _OUTPUT_GPX_HPP_
+#ifndef _OUTPUT_FITLOG_HPP_
+#define _OUTPUT_FITLOG_HPP_
 
 #include "../bom/Session.h"
 #include "Output.h"
@@ -9,7 +9,7 @@ namespace output
 	class Fitlog : public FileOutput
 	{
 		public:
-			void dumpContent(std::ostream &out, const Session *session, std::map<std::string, std::string> &configuration) override;
+			void dumpContent(Writer &out, const Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "Fitlog"; };
 			std::string getExt() override { return "fit"; };
 
@@ -9,11 +9,15 @@ namespace output
 	class GPX : public FileOutput
 	{
 		public:
-			void dumpContent(std::ostream &out, const Session *session, std::map<std::string, std::string> &configuration) override;
+			GPX() : _gpxdataExtensions(false), _gpxtpxExtensions(false) { };
+			void configure(const Configuration &configuration) override;
+			void dumpContent(Writer &out, const Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "GPX"; };
 			std::string getExt() override { return "gpx"; };
 
 		private:
+			bool _gpxdataExtensions;
+			bool _gpxtpxExtensions;
 			DECLARE_OUTPUT(GPX);
 	};
 }
@@ -15,55 +15,60 @@ namespace output
 {
 	REGISTER_OUTPUT(GoogleMap);
 
-	void GoogleMap::dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration)
+	void GoogleMap::configure(const Configuration &configuration)
 	{
-		if(configuration.find("google_api_key") == configuration.end()) {
+		_apiKey = configuration.get("google_api_key");
+		_mapHeight = configuration.getUInt("google_map_height", DEFAULT_MAP_HEIGHT);
+	}
+
+	void GoogleMap::dumpContent(Writer &out, const Session *session, const Configuration &configuration)
+	{
+		if(_apiKey.empty()) {
 			std::cerr << "Using GoogleMap output requires a Google API Key. You can get one from https://developers.google.com/maps/documentation/javascript/get-api-key" << std::endl;
 			return;
 		}
-		const_cast<Session*>(session)->ensurePointDistanceAreOk();
-
 		// Latitude and longitude retrieved from the GPS has 6 decimals and can have 2 digits before decimal point
 		out.precision(8);
-		out << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">" << std::endl;
-		out << "<html xmlns=\"http://www.w3.org/1999/xhtml\"  xmlns:v=\"urn:schemas-microsoft-com:vml\">" << std::endl;
-		out << "<head>" << std::endl;
-		out << "<meta http-equiv=\"content-type\" content=\"text/html; charset=utf-8\"/>" << std::endl;
-		out << "<title>Session from " << session->getBeginTime() << "</title>" << std::endl;
+		out << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">\n";
+		out << "<html xmlns=\"http://www.w3.org/1999/xhtml\"  xmlns:v=\"urn:schemas-microsoft-com:vml\">\n";
+		out << "<head>\n";
+		out << "<meta http-equiv=\"content-type\" content=\"text/html; charset=utf-8\"/>\n";
+		out << "<title>Session from " << session->getBeginTime() << "</title>\n";
 
-		out << "<style media='screen' type='text/css'>" << std::endl;
-		out << ".dygraph-legend {" << std::endl;
-		out << "    width: 100px;" << std::endl;
-		out << "    background-color: transparent !important;" << std::endl;
-		out << "    left: 75px !important;" << std::endl;
-		out << "    top: 5px !important;" << std::endl;
-		out << "    width: 400px !important;" << std::endl;
-		out << "    " << std::endl;
-		out << "}" << std::endl;
-		out << "</style>" << std::endl;
+		out << "<style media='screen' type='text/css'>\n";
+		out << ".dygraph-legend {\n";
+		out << "    width: 100px;\n";
+		out << "    background-color: transparent !important;\n";
+		out << "    left: 75px !important;\n";
+		out << "    top: 5px !important;\n";
+		out << "    width: 400px !important;\n";
+		out << "    \n";
+		out << "}\n";
+		out << "</style>\n";
 
-		out << "<script type=\"text/javascript\" src=\"http://maps.google.com/maps/api/js?key=" << configuration["google_api_key"] << "&sensor=false\"></script>" << std::endl;
-		out << "<script type=\"text/javascript\">" << std::endl;
-		out << "popupGlobal = null;" << std::endl;
-		out << "highlightedPoint = null;" << std::endl;
+		out << "<script type=\"text/javascript\" src=\"http://maps.google.com/maps/api/js?key=" << _apiKey << "&sensor=false\"></script>\n";
+		out << "<script type=\"text/javascript\">\n";
+		out << "popupGlobal = null;\n";
+		out << "highlightedPoint = null;\n";
 
-		out << "function lap_popup_callback(event, dataLapPoint)" << std::endl;
-		out << "{" << std::endl;
-		out << "    var popup = new google.maps.InfoWindow({position: event.latLng, content: dataLapPoint.infos});" << std::endl;
-		out << "    popup.open(map);" << std::endl;
-		out << "    return popup;" << std::endl;
-		out << "}" << std::endl;
+		out << "function lap_popup_callback(event, dataLapPoint)\n";
+		out << "{\n";
+		out << "    var popup = new google.maps.InfoWindow({position: event.latLng, content: dataLapPoint.infos});\n";
+		out << "    popup.open(map);\n";
+		out << "    return popup;\n";
+		out << "}\n";
 
-		out << "function point_popup_callback(event,dataPoint)" << std::endl;
-		out << "{" << std::endl;
-		out << "    var popup = new google.maps.InfoWindow({position: event.latLng, " << std::endl;
-		out << "                                            content: \"<b>Time:</b> \" + dataPoint.time + \"<br /><b>Elapsed:</b> \" + dataPoint.duration +\"<br /><b>Speed:</b> \" + dataPoint.speed + \" km/h<br /><b>Heartrate:</b> \" + dataPoint.heartrate +\" bpm<br/><b>Elevation:</b> \"+ dataPoint.altitude + \" m\"});" << std::endl;
-		out << "    popup.open(map);" << std::endl;
-		out << "    return popup;" << std::endl;
-		out << "}" << std::endl;
+		out << "function point_popup_callback(event,dataPoint)\n";
+		out << "{\n";
+		out << "    var popup = new google.maps.InfoWindow({position: event.latLng, \n";
+		out << "                                            content: \"<b>Time:</b> \" + dataPoint.time + \"<br /><b>Elapsed:</b> \" + dataPoint.duration +\"<br /><b>Speed:</b> \" + dataPoint.speed + \" km/h<br /><b>Heartrate:</b> \" + dataPoint.heartrate +\" bpm<br/><b>Elevation:</b> \"+ dataPoint.altitude + \" m\"});\n";
+		out << "    popup.open(map);\n";
+		out << "    return popup;\n";
+		out << "}\n";
 
-		out << "pointsList = Array(" << std::endl;
-		std::vector<Point*> points = session->getPoints();
+		out << "pointsList = Array(\n";
+		const std::vector<Point*> &points = session->getPoints();
+		const std::vector<double> &distances = session->getColumns().getCumulativeDistances();
 		uint32_t point = 0;
 		// Average speed is green
 		// speed above replace green by red
@@ -90,6 +95,8 @@ namespace output
 		}
 		double max_speed_factor = (double)0xFF / (max_speed - avg_speed);
 		double min_speed_factor = (double)0xFF / (avg_speed - min_speed);
+		TimeCodec timeCodec;
+		char time[TimeCodec::FORMAT_BUFFER_SIZE];
 		for(auto it = points.begin(); it != points.end(); ++it)
 		{
 			// Point is latitude, longitude, color
@@ -99,7 +106,7 @@ namespace output
 			}
 			out <<  "{";
 			out << "lat:" << (*it)->getLatitude() << ", long:" << (*it)->getLongitude() << ", ";
-			out << "distance:" << (*it)->getDistance() << ", ";
+			out << "distance:" << (uint32_t) distances[point] << ", ";
 			out << "color: \"#";
 			double speed = (*it)->getSpeed();
 			if(std::isnan(speed) || !(*it)->getSpeed().isDefined()) speed = 0;
@@ -116,13 +123,14 @@ namespace output
 			color = (256-isp) << 8; /* green part */;
 			color += isp << (speed > avg_speed ? 16   /* red part if above avg */
 			                                   :  0); /* blue part if below avg*/
-			out << std::hex << std::setw(6) << std::setfill('0') << color;
-			out << "\"" << std::dec << std::setw(0) << std::setfill(' ');
+			out.hex(color, 6);
+			out << "\"";
 			// TODO: Use max hr and min hr to determine the width range
 
 			uint32_t elapsed = ((*it)->getTime() - session->getTime()) * 1000; // in ms
 			out << ", elapsed: " << elapsed;
-			out << ", time: \"" << (*it)->getTimeAsString(true, true) << "\""; //TODO
+			timeCodec.format((*it)->getTime(), (*it)->getMillis(), time, true, true);
+			out << ", time: \"" << time << "\""; //TODO
 			out << ", duration: \"" << durationAsString((*it)->getTime() - session->getTime()) << "\"";
 			out << ", speed: " << speed;
 			out << ", heartrate: ";
@@ -135,13 +143,13 @@ namespace output
 				out << (*it)->getAltitude();
 			else
 				out << 0;
-			out << "}" << std::endl;
+			out << "}\n";
 
 			++point;
 		}
-		out << ");" << std::endl;
+		out << ");\n";
 
-		std::vector<Lap*> laps = session->getLaps();
+		const std::vector<Lap*> &laps = session->getLaps();
 		uint32_t nbLap = 0;
 		bool addComa = false;
 		out << "waypointsList = Array (";
@@ -149,7 +157,7 @@ namespace output
 		{
 			if(lap->getEndPoint() != nullptr)
 			{
-			       out << std::endl;
+			       out << '\n';
 
 			       if(addComa)
 			       {
@@ -163,90 +171,89 @@ namespace output
 				out << "<h3 style=\\\"padding:0; margin:0\\\">Lap " << lap->getLapNum() + 1 << "</h3>";
 				out << "<b>Distance:</b> " << lap->getDistance()/1000.0 << " km<br/>";
 				out << "<b>Time:</b> " << durationAsString(lap->getDuration()) << "<br/>";
-				out << lap->getAvgSpeed().toStream("<b>Average speed:</b> ", " km/h<br/>");
-				out << lap->getMaxSpeed().toStream("<b>Maximum speed:</b> ", " km/h<br/>");
-				out << lap->getAvgHeartrate().toStream("<b>Average heartrate:</b> ", " bpm<br/>");
-				out << lap->getMaxHeartrate().toStream("<b>Maximum heartrate:</b> ", " bpm<br/>");
+				out << ifDefined(lap->getAvgSpeed(), "<b>Average speed:</b> ", " km/h<br/>");
+				out << ifDefined(lap->getMaxSpeed(), "<b>Maximum speed:</b> ", " km/h<br/>");
+				out << ifDefined(lap->getAvgHeartrate(), "<b>Average heartrate:</b> ", " bpm<br/>");
+				out << ifDefined(lap->getMaxHeartrate(), "<b>Maximum heartrate:</b> ", " bpm<br/>");
 				out << "\"";
 				out << "}";
 			}
 			++nbLap;
 		}
-		out << ");" << std::endl << std::endl;
+		out << ");\n\n";
 
-		out << "var graph;" << std::endl;
-		out << "var XValueToPointId = {};" << std::endl;
-		out << "var PointIdToXValue = {};" << std::endl;
-		out << "var xAxisAttribute = \"elapsed\";" << std::endl;
+		out << "var graph;\n";
+		out << "var XValueToPointId = {};\n";
+		out << "var PointIdToXValue = {};\n";
+		out << "var xAxisAttribute = \"elapsed\";\n";
 
-		out << "function loadMap() " << std::endl;
-		out << "{" << std::endl;
-		out << "	var centerLatLng = new google.maps.LatLng(pointsList[0].lat, pointsList[0].long);" << std::endl;
-		out << "	var myOptions = {" << std::endl;
-		out << "	      zoom: 14," << std::endl;
-		out << "	      center: centerLatLng," << std::endl;
-		out << "	      scaleControl: true," << std::endl;
-		out << "	      mapTypeId: google.maps.MapTypeId.HYBRID" << std::endl;
-		out << "	};" << std::endl << std::endl;
-		out << "	map = new google.maps.Map(document.getElementById(\"map\"), myOptions);" << std::endl;
-		out << "   highlightedPoint = new google.maps.Marker({position: centerLatLng, map: map, zIndex: 1});" << std::endl;
-		out << "	var image_size = new google.maps.Size(32, 32);" << std::endl;
-		out << "	var image_origin = new google.maps.Point(0, 0);" << std::endl;
-		out << "	var image_anchor = new google.maps.Point(3, 25);" << std::endl;
-		out << "	for (i=0; i<waypointsList.length; i++)" << std::endl;
-		out << "	{" << std::endl;
-		out << "	        var dataLapPoint = waypointsList[i];" << std::endl;
-		out << "		var point = new google.maps.LatLng(dataLapPoint.lat, dataLapPoint.long);" << std::endl;
+		out << "function loadMap() \n";
+		out << "{\n";
+		out << "	var centerLatLng = new google.maps.LatLng(pointsList[0].lat, pointsList[0].long);\n";
+		out << "	var myOptions = {\n";
+		out << "	      zoom: 14,\n";
+		out << "	      center: centerLatLng,\n";
+		out << "	      scaleControl: true,\n";
+		out << "	      mapTypeId: google.maps.MapTypeId.HYBRID\n";
+		out << "	};\n\n";
+		out << "	map = new google.maps.Map(document.getElementById(\"map\"), myOptions);\n";
+		out << "   highlightedPoint = new google.maps.Marker({position: centerLatLng, map: map, zIndex: 1});\n";
+		out << "	var image_size = new google.maps.Size(32, 32);\n";
+		out << "	var image_origin = new google.maps.Point(0, 0);\n";
+		out << "	var image_anchor = new google.maps.Point(3, 25);\n";
+		out << "	for (i=0; i<waypointsList.length; i++)\n";
+		out << "	{\n";
+		out << "	        var dataLapPoint = waypointsList[i];\n";
+		out << "		var point = new google.maps.LatLng(dataLapPoint.lat, dataLapPoint.long);\n";
 		// TODO: Use something else for the icon of lap ending
-		out << "		var markerImage = new google.maps.MarkerImage(\"http://www.icone-gif.com/icone/isometrique/32x32/green-flag.png\", image_size, image_origin, image_anchor);" << std::endl;
-		out << "		var markerOptions = {" << std::endl;
-		out << "			icon: markerImage," << std::endl;
-		out << "			position: point}" << std::endl;
-		out << "		var markerD = new google.maps.Marker(markerOptions); " << std::endl;
-		out << "		markerD.setMap(map);" << std::endl;
-		out << "		attachLapPopupHandler(markerD, dataLapPoint);" << std::endl;
-		out << "	}" << std::endl << std::endl;
-		out << "	for (i=0; i<pointsList.length; i++)" << std::endl;
-		out << "	{" << std::endl;
-		out << "		if(i > 0)" << std::endl;
-		out << "		{" << std::endl;
-		out << "			var previousDataPoint = pointsList[i-1];" << std::endl;
-		out << "			var currentDataPoint = pointsList[i];" << std::endl;
-		out << "			var startPoint = new google.maps.LatLng(previousDataPoint.lat, previousDataPoint.long);" << std::endl;
-		out << "			var endPoint = new google.maps.LatLng(currentDataPoint.lat, currentDataPoint.long);" << std::endl;
-		out << "			var pathArray = Array(startPoint, endPoint);" << std::endl;
-		out << "			var polyline = new google.maps.Polyline({path: pathArray," << std::endl;
-		out << "					strokeColor: currentDataPoint.color," << std::endl;
-		out << "					strokeOpacity: 0.9," << std::endl;
-		out << "					strokeWeight: 5," << std::endl;
-		out << "					});" << std::endl;
-		out << "			polyline.setMap(map);" << std::endl;
-		out << "			attachPopupHandler(polyline, currentDataPoint);" << std::endl;
-		out << "		        attachMouseOverHandler(polyline, i);" << std::endl;
-		out << "		}" << std::endl;
-		out << "	}" << std::endl;
-		out << "}" << std::endl;
+		out << "		var markerImage = new google.maps.MarkerImage(\"http://www.icone-gif.com/icone/isometrique/32x32/green-flag.png\", image_size, image_origin, image_anchor);\n";
+		out << "		var markerOptions = {\n";
+		out << "			icon: markerImage,\n";
+		out << "			position: point}\n";
+		out << "		var markerD = new google.maps.Marker(markerOptions); \n";
+		out << "		markerD.setMap(map);\n";
+		out << "		attachLapPopupHandler(markerD, dataLapPoint);\n";
+		out << "	}\n\n";
+		out << "	for (i=0; i<pointsList.length; i++)\n";
+		out << "	{\n";
+		out << "		if(i > 0)\n";
+		out << "		{\n";
+		out << "			var previousDataPoint = pointsList[i-1];\n";
+		out << "			var currentDataPoint = pointsList[i];\n";
+		out << "			var startPoint = new google.maps.LatLng(previousDataPoint.lat, previousDataPoint.long);\n";
+		out << "			var endPoint = new google.maps.LatLng(currentDataPoint.lat, currentDataPoint.long);\n";
+		out << "			var pathArray = Array(startPoint, endPoint);\n";
+		out << "			var polyline = new google.maps.Polyline({path: pathArray,\n";
+		out << "					strokeColor: currentDataPoint.color,\n";
+		out << "					strokeOpacity: 0.9,\n";
+		out << "					strokeWeight: 5,\n";
+		out << "					});\n";
+		out << "			polyline.setMap(map);\n";
+		out << "			attachPopupHandler(polyline, currentDataPoint);\n";
+		out << "		        attachMouseOverHandler(polyline, i);\n";
+		out << "		}\n";
+		out << "	}\n";
+		out << "}\n";
 
 
-		out << "function attachLapPopupHandler(mapElement, dataLapPoint) {" << std::endl;
-		out << "     google.maps.event.addListener(mapElement, 'click', function(evt) {lap_popup_callback(evt,dataLapPoint);});" << std::endl;
-		out << "}" << std::endl;
+		out << "function attachLapPopupHandler(mapElement, dataLapPoint) {\n";
+		out << "     google.maps.event.addListener(mapElement, 'click', function(evt) {lap_popup_callback(evt,dataLapPoint);});\n";
+		out << "}\n";
 
-		out << "function attachPopupHandler(mapElement, dataPoint) {" << std::endl;
-		out << "     google.maps.event.addListener(mapElement, 'click', function(evt) {point_popup_callback(evt,dataPoint);});" << std::endl;
-		out << "}" << std::endl;
+		out << "function attachPopupHandler(mapElement, dataPoint) {\n";
+		out << "     google.maps.event.addListener(mapElement, 'click', function(evt) {point_popup_callback(evt,dataPoint);});\n";
+		out << "}\n";
 
-		out << "function attachMouseOverHandler(mapElement, point) {" << std::endl;
-		out << "     google.maps.event.addListener(mapElement, 'mouseover', function() {graph.setSelection(point);});" << std::endl;
-		out << "}" << std::endl;
-		out << "//]]>" << std::endl;
-		out << "</script>" << std::endl;
-		out << "<script type=\"text/javascript\" src=\"http://dygraphs.com/1.0.1/dygraph-combined.js\"></script>" << std::endl;
-		out << "<script type=\"text/javascript\">" << std::endl;
-		out << "// point ID, elapsed time (ms), speed (km/h), heartrate (bpm), elevation (m)" << std::endl;
+		out << "function attachMouseOverHandler(mapElement, point) {\n";
+		out << "     google.maps.event.addListener(mapElement, 'mouseover', function() {graph.setSelection(point);});\n";
+		out << "}\n";
+		out << "//]]>\n";
+		out << "</script>\n";
+		out << "<script type=\"text/javascript\" src=\"http://dygraphs.com/1.0.1/dygraph-combined.js\"></script>\n";
+		out << "<script type=\"text/javascript\">\n";
+		out << "// point ID, elapsed time (ms), speed (km/h), heartrate (bpm), elevation (m)\n";
 		
 		int i = 0;
-		laps = session->getLaps();
 		auto itLaps = laps.begin();
 		std::list<uint32_t> lapsList;
 		for(const auto& point : points)
@@ -271,154 +278,154 @@ namespace output
 			}
 			out << *it;
 		}
-		out << "];" << std::endl;
-		out << "var displayData = [true, true, true];" << std::endl;
-		out << "var labelsData = [\"Speed\", \"Heart Rate\", \"Altitude\"];" << std::endl;
+		out << "];\n";
+		out << "var displayData = [true, true, true];\n";
+		out << "var labelsData = [\"Speed\", \"Heart Rate\", \"Altitude\"];\n";
 
 		
-		out << "var XAxisValueFormater = {" << std::endl;
-		out << "    \"elapsed\": function(ms,multiline) {" << std::endl;
-		out << "	     var h = Math.floor(ms / (61 * 60 * 1000));" << std::endl;
-		out << "	     ms = ms - h * (60 * 60 * 1000);" << std::endl;
-		out << "	     var m = Math.floor(ms / (60 * 1000));" << std::endl;
-		out << "	     ms = ms - m * (60 * 1000);" << std::endl;
-		out << "	     var s = Math.floor(ms / 1000);" << std::endl;
-		out << "	     ms = ms - (s * 1000);" << std::endl;
-		out << "	     ths = Math.floor(ms / 10);" << std::endl;
-		out << "	     var r = \"\";" << std::endl;
-		out << "	     if(h!==0) {r = r + h +\"h\"; if(multiline) {r = r +\"<br/>\"}}" << std::endl;
-		out << "	     r = r + m + \"mn\"; if(multiline) {r = r +\"<br/>\"}" << std::endl;
-		out << "	     r = r + s + \".\" + ths +\"s\";" << std::endl;
-		out << "	     return r;" << std::endl;
-		out << "    }," << std::endl;
-		out << "    \"distance\": function(dInMeter,multiline) {" << std::endl;
-		out << "	     var tm = Math.floor(dInMeter / 100);" << std::endl;
-		out << "	     var r = \"\" + (tm / 10.);" << std::endl;
-		out << "	     if(multiline) {r = r +\"<br/>\"};" << std::endl;
-		out << "	     r = r + \"Km\";" << std::endl;
-		out << "	     return r;" << std::endl;
-		out << "    }" << std::endl;
-		out << "}" << std::endl;
+		out << "var XAxisValueFormater = {\n";
+		out << "    \"elapsed\": function(ms,multiline) {\n";
+		out << "	     var h = Math.floor(ms / (61 * 60 * 1000));\n";
+		out << "	     ms = ms - h * (60 * 60 * 1000);\n";
+		out << "	     var m = Math.floor(ms / (60 * 1000));\n";
+		out << "	     ms = ms - m * (60 * 1000);\n";
+		out << "	     var s = Math.floor(ms / 1000);\n";
+		out << "	     ms = ms - (s * 1000);\n";
+		out << "	     ths = Math.floor(ms / 10);\n";
+		out << "	     var r = \"\";\n";
+		out << "	     if(h!==0) {r = r + h +\"h\"; if(multiline) {r = r +\"<br/>\"}}\n";
+		out << "	     r = r + m + \"mn\"; if(multiline) {r = r +\"<br/>\"}\n";
+		out << "	     r = r + s + \".\" + ths +\"s\";\n";
+		out << "	     return r;\n";
+		out << "    },\n";
+		out << "    \"distance\": function(dInMeter,multiline) {\n";
+		out << "	     var tm = Math.floor(dInMeter / 100);\n";
+		out << "	     var r = \"\" + (tm / 10.);\n";
+		out << "	     if(multiline) {r = r +\"<br/>\"};\n";
+		out << "	     r = r + \"Km\";\n";
+		out << "	     return r;\n";
+		out << "    }\n";
+		out << "}\n";
 
-		out << "function loadGraph() " << std::endl;
-		out << "{" << std::endl;
-		out << "        if(document.getElementById(\"xAxisAttributeDistance\").checked) {" << std::endl;
-		out << "           xAxisAttribute = \"distance\";" << std::endl;
-		out << "        }" << std::endl;
-		out << "        else {" << std::endl;
-		out << "           xAxisAttribute = \"elapsed\";" << std::endl;
-		out << "        }" << std::endl;
+		out << "function loadGraph() \n";
+		out << "{\n";
+		out << "        if(document.getElementById(\"xAxisAttributeDistance\").checked) {\n";
+		out << "           xAxisAttribute = \"distance\";\n";
+		out << "        }\n";
+		out << "        else {\n";
+		out << "           xAxisAttribute = \"elapsed\";\n";
+		out << "        }\n";
 
-		out << "   var lapsXValues = [];" << std::endl;
-		out << "	var graphDatas=[];" << std::endl;
-		out << "	var labels=[];" << std::endl;
-		out << "	var iLaps = 0;" << std::endl;
-		out << "	for(var i = 0; i < pointsList.length; i++)" << std::endl;
-		out << "	{" << std::endl;
-		out << "		var col = 0;" << std::endl;
-		out << "		graphDatas[i] = [];" << std::endl;
-		out << "		labels[col] = \"Point ID\";" << std::endl;
-		out << "		var xValue = pointsList[i][xAxisAttribute];" << std::endl;		
-		out << "		graphDatas[i][col++] = xValue;" << std::endl;
-		out << "		XValueToPointId[xValue] = i;" << std::endl;
-		out << "		PointIdToXValue[i] = xValue;" << std::endl;
-		out << "		labels[col] = \"Laps\";" << std::endl;
-		out << "		graphDatas[i][col++] = null;" << std::endl;
-		out << "		if(displayData[0]) { //speed" << std::endl;
-		out << "		    labels[col] = labelsData[0];" << std::endl;
-		out << "		    graphDatas[i][col++] = pointsList[i].speed;" << std::endl;
-		out << "	        }" << std::endl;
-		out << "		if(displayData[1]) { //heartrate" << std::endl;
-		out << "		    labels[col] = labelsData[1];" << std::endl;
-		out << "		    graphDatas[i][col++] = pointsList[i].heartrate;" << std::endl;
-		out << "	        }" << std::endl;
-		out << "		if(displayData[2]) { //altitude" << std::endl;
-		out << "		    labels[col] = labelsData[2];" << std::endl;
-		out << "		    graphDatas[i][col++] = pointsList[i].altitude;" << std::endl;
-		out << "	        }" << std::endl;
-		out << "	        " << std::endl;
-		out << "	        if(i === laps[iLaps]) {" << std::endl;
-		out << "	            lapsXValues.push(xValue);" << std::endl;
-		out << "	            iLaps = iLaps + 1;" << std::endl;
-		out << "	        }" << std::endl;
-		out << "	}" << std::endl;
-		out << "	graph = new Dygraph(" << std::endl;
-		out << "	document.getElementById(\"graph\")" << std::endl;
-		out << "	,graphDatas" << std::endl;
-		out << "	,{" << std::endl;
-		out << "	labels: labels," << std::endl;
-		out << "	'Speed': { axis: {includeZero:true}}," << std::endl;
-		out << "   colors: [\"#000000\", \"#0000FF\", \"#00AA00\", \"#FF0000\"]," << std::endl;
-		out << "	axes: { " << std::endl;
-		out << "	x: {" << std::endl;
-		out << "	 valueFormatter: function(xValue) {return XAxisValueFormater[xAxisAttribute](xValue,false);}" << std::endl;
-		out << "	 ,axisLabelFormatter: function(xValue) {return XAxisValueFormater[xAxisAttribute](xValue,true);}" << std::endl;
-		out << "	}" << std::endl;
-		out << "	}" << std::endl;
-		out << "	,ylabel: 'Altitude (m) / Heart rate (bpm)'" << std::endl;
-		out << "	,y2label: 'Speed (km/h)'" << std::endl;
-		out << "	}" << std::endl;
-		out << "	);" << std::endl;
-		out << "	graph.updateOptions({clickCallback : function(e, x, points) { if(popupGlobal) popupGlobal.close(); e.latLng = new google.maps.LatLng(pointsList[XValueToPointId[x]].lat, pointsList[XValueToPointId[x]].long); popupGlobal = point_popup_callback(e,pointsList[XValueToPointId[x]]); } });" << std::endl;
-		out << "	graph.updateOptions({highlightCallback : function(e, x, points) { center = new google.maps.LatLng(pointsList[XValueToPointId[x]].lat, pointsList[XValueToPointId[x]].long); map.setCenter(center); highlightedPoint.setPosition(center); } });" << std::endl;
-		out << "	graph.updateOptions({annotationClickHandler : function(ann, pt, dg, e) { if(popupGlobal) popupGlobal.close(); e.latLng = new google.maps.LatLng(pointsList[XValueToPointId[ann.xval]].lat, pointsList[XValueToPointId[ann.xval]].long); popupGlobal = lap_popup_callback(e,waypointsList[ann.shortText-1]); } });" << std::endl;
-		out << "	graph.updateOptions({underlayCallback: function(canvas, area, g) {" << std::endl;
-		out << "			for(var i = 0; i+1 < lapsXValues.length; i+=2)" << std::endl;
-		out << "			{" << std::endl;
-		out << "              var left = graph.toDomCoords(lapsXValues[i], 0)[0];" << std::endl;
-		out << "              var right = graph.toDomCoords(lapsXValues[i+1], 0)[0];" << std::endl;
-		out << "              canvas.fillStyle = \"rgba(220, 220, 220, 1.0)\";" << std::endl;
-		out << "              canvas.fillRect(left, area.y, right - left, area.h);" << std::endl;
-		out << "			}" << std::endl;
-		out << "		}});" << std::endl;
-		out << "	annotations = [];" << std::endl;
-		out << "	for(var i = 0; i < lapsXValues.length; ++i)" << std::endl;
-		out << "	{" << std::endl;
-		out << "		annotations.push({" << std::endl;
-		out << "			series: 'Laps'," << std::endl;
-		out << "			xval: lapsXValues[i]," << std::endl;
-		out << "			attachAtBottom: true," << std::endl;
-		out << "			shortText: (i+1)," << std::endl;
-		out << "			text: 'Lap ' + (i+1)" << std::endl;
-		out << "		});" << std::endl;
-		out << "	}" << std::endl;
-		out << "	graph.setAnnotations(annotations);" << std::endl;
-		out << "}" << std::endl;
-		out << "function toggleDisplay(i)" << std::endl;
-		out << "{" << std::endl;
-		out << "	displayData[i] = !displayData[i];" << std::endl;
-		out << "	loadGraph();" << std::endl;
-		out << "}" << std::endl;
-		out << "function load()" << std::endl;
-		out << "{" << std::endl;
-		out << "	loadGraph();" << std::endl;
-		out << "	loadMap();" << std::endl;
-		out << "}" << std::endl;
-		out << "</script>" << std::endl;
-		out << "</head>" << std::endl;
-		out << "<body onload=\"load()\" style=\"cursor:crosshair\" border=\"0\">" << std::endl;
-		out << "<div id=\"map\" style=\"width: 100%; height: " << configuration["google_map_height"] << "px; top: 0px; left: 0px\"></div>" << std::endl;
-		out << "<div id=\"graph\" style=\"width: 100%; height: 300px; top: 0px; left: 0px\"></div>" << std::endl;
-		out << "<div id=\"spacer\" style=\"height: 25px\"></div>" << std::endl;
-		out << "<div id=\"controls\" style=\"width: 100%; text-align:center\"><input type=\"checkbox\" name=\"Speed\" onchange=\"toggleDisplay(0)\" checked=\"checked\">Speed</input><input type=\"checkbox\" name=\"Heartrate\" onchange=\"toggleDisplay(1)\" checked=\"checked\">Heartrate</input><input type=\"checkbox\" name=\"Elevation\" onchange=\"toggleDisplay(2)\" checked=\"checked\">Elevation</input>" << std::endl;
+		out << "   var lapsXValues = [];\n";
+		out << "	var graphDatas=[];\n";
+		out << "	var labels=[];\n";
+		out << "	var iLaps = 0;\n";
+		out << "	for(var i = 0; i < pointsList.length; i++)\n";
+		out << "	{\n";
+		out << "		var col = 0;\n";
+		out << "		graphDatas[i] = [];\n";
+		out << "		labels[col] = \"Point ID\";\n";
+		out << "		var xValue = pointsList[i][xAxisAttribute];\n";		
+		out << "		graphDatas[i][col++] = xValue;\n";
+		out << "		XValueToPointId[xValue] = i;\n";
+		out << "		PointIdToXValue[i] = xValue;\n";
+		out << "		labels[col] = \"Laps\";\n";
+		out << "		graphDatas[i][col++] = null;\n";
+		out << "		if(displayData[0]) { //speed\n";
+		out << "		    labels[col] = labelsData[0];\n";
+		out << "		    graphDatas[i][col++] = pointsList[i].speed;\n";
+		out << "	        }\n";
+		out << "		if(displayData[1]) { //heartrate\n";
+		out << "		    labels[col] = labelsData[1];\n";
+		out << "		    graphDatas[i][col++] = pointsList[i].heartrate;\n";
+		out << "	        }\n";
+		out << "		if(displayData[2]) { //altitude\n";
+		out << "		    labels[col] = labelsData[2];\n";
+		out << "		    graphDatas[i][col++] = pointsList[i].altitude;\n";
+		out << "	        }\n";
+		out << "	        \n";
+		out << "	        if(i === laps[iLaps]) {\n";
+		out << "	            lapsXValues.push(xValue);\n";
+		out << "	            iLaps = iLaps + 1;\n";
+		out << "	        }\n";
+		out << "	}\n";
+		out << "	graph = new Dygraph(\n";
+		out << "	document.getElementById(\"graph\")\n";
+		out << "	,graphDatas\n";
+		out << "	,{\n";
+		out << "	labels: labels,\n";
+		out << "	'Speed': { axis: {includeZero:true}},\n";
+		out << "   colors: [\"#000000\", \"#0000FF\", \"#00AA00\", \"#FF0000\"],\n";
+		out << "	axes: { \n";
+		out << "	x: {\n";
+		out << "	 valueFormatter: function(xValue) {return XAxisValueFormater[xAxisAttribute](xValue,false);}\n";
+		out << "	 ,axisLabelFormatter: function(xValue) {return XAxisValueFormater[xAxisAttribute](xValue,true);}\n";
+		out << "	}\n";
+		out << "	}\n";
+		out << "	,ylabel: 'Altitude (m) / Heart rate (bpm)'\n";
+		out << "	,y2label: 'Speed (km/h)'\n";
+		out << "	}\n";
+		out << "	);\n";
+		out << "	graph.updateOptions({clickCallback : function(e, x, points) { if(popupGlobal) popupGlobal.close(); e.latLng = new google.maps.LatLng(pointsList[XValueToPointId[x]].lat, pointsList[XValueToPointId[x]].long); popupGlobal = point_popup_callback(e,pointsList[XValueToPointId[x]]); } });\n";
+		out << "	graph.updateOptions({highlightCallback : function(e, x, points) { center = new google.maps.LatLng(pointsList[XValueToPointId[x]].lat, pointsList[XValueToPointId[x]].long); map.setCenter(center); highlightedPoint.setPosition(center); } });\n";
+		out << "	graph.updateOptions({annotationClickHandler : function(ann, pt, dg, e) { if(popupGlobal) popupGlobal.close(); e.latLng = new google.maps.LatLng(pointsList[XValueToPointId[ann.xval]].lat, pointsList[XValueToPointId[ann.xval]].long); popupGlobal = lap_popup_callback(e,waypointsList[ann.shortText-1]); } });\n";
+		out << "	graph.updateOptions({underlayCallback: function(canvas, area, g) {\n";
+		out << "			for(var i = 0; i+1 < lapsXValues.length; i+=2)\n";
+		out << "			{\n";
+		out << "              var left = graph.toDomCoords(lapsXValues[i], 0)[0];\n";
+		out << "              var right = graph.toDomCoords(lapsXValues[i+1], 0)[0];\n";
+		out << "              canvas.fillStyle = \"rgba(220, 220, 220, 1.0)\";\n";
+		out << "              canvas.fillRect(left, area.y, right - left, area.h);\n";
+		out << "			}\n";
+		out << "		}});\n";
+		out << "	annotations = [];\n";
+		out << "	for(var i = 0; i < lapsXValues.length; ++i)\n";
+		out << "	{\n";
+		out << "		annotations.push({\n";
+		out << "			series: 'Laps',\n";
+		out << "			xval: lapsXValues[i],\n";
+		out << "			attachAtBottom: true,\n";
+		out << "			shortText: (i+1),\n";
+		out << "			text: 'Lap ' + (i+1)\n";
+		out << "		});\n";
+		out << "	}\n";
+		out << "	graph.setAnnotations(annotations);\n";
+		out << "}\n";
+		out << "function toggleDisplay(i)\n";
+		out << "{\n";
+		out << "	displayData[i] = !displayData[i];\n";
+		out << "	loadGraph();\n";
+		out << "}\n";
+		out << "function load()\n";
+		out << "{\n";
+		out << "	loadGraph();\n";
+		out << "	loadMap();\n";
+		out << "}\n";
+		out << "</script>\n";
+		out << "</head>\n";
+		out << "<body onload=\"load()\" style=\"cursor:crosshair\" border=\"0\">\n";
+		out << "<div id=\"map\" style=\"width: 100%; height: " << _mapHeight << "px; top: 0px; left: 0px\"></div>\n";
+		out << "<div id=\"graph\" style=\"width: 100%; height: 300px; top: 0px; left: 0px\"></div>\n";
+		out << "<div id=\"spacer\" style=\"height: 25px\"></div>\n";
+		out << "<div id=\"controls\" style=\"width: 100%; text-align:center\"><input type=\"checkbox\" name=\"Speed\" onchange=\"toggleDisplay(0)\" checked=\"checked\">Speed</input><input type=\"checkbox\" name=\"Heartrate\" onchange=\"toggleDisplay(1)\" checked=\"checked\">Heartrate</input><input type=\"checkbox\" name=\"Elevation\" onchange=\"toggleDisplay(2)\" checked=\"checked\">Elevation</input>\n";
 
-		out << "  <div id=\"xAxisOptions\">" << std::endl;
-		out << "  <span>X Axis:</span>&nbsp;" << std::endl;
-		out << "    <input id=\"xAxisAttributeTime\" type=\"radio\" name=\"group1\" value=\"elapsed\" checked onChange=\"loadGraph();\">Time</input>" << std::endl;
-		out << "    <input id=\"xAxisAttributeDistance\" type=\"radio\" name=\"group1\" value=\"distance\" onChange=\"loadGraph();\">Distance</input>" << std::endl;
-		out << "  </div>" << std::endl;
+		out << "  <div id=\"xAxisOptions\">\n";
+		out << "  <span>X Axis:</span>&nbsp;\n";
+		out << "    <input id=\"xAxisAttributeTime\" type=\"radio\" name=\"group1\" value=\"elapsed\" checked onChange=\"loadGraph();\">Time</input>\n";
+		out << "    <input id=\"xAxisAttributeDistance\" type=\"radio\" name=\"group1\" value=\"distance\" onChange=\"loadGraph();\">Distance</input>\n";
+		out << "  </div>\n";
 
 		dumpSessionSummary(out, session);
 
-		out << "</div>" << std::endl;
-		out << "</body>" << std::endl;
-		out << "</html>" << std::endl;
+		out << "</div>\n";
+		out << "</body>\n";
+		out << "</html>\n";
 	}
 
 	template <typename T>
-	void GoogleMap::displayOptionalValue(std::ostream &out, Field<T> f, int width, const std::string& units) const
+	void GoogleMap::displayOptionalValue(Writer &out, Field<T> f, int width, const std::string& units) const
 	{
-		out << "<td>" << std::setw(width);
+		out << "<td>" << padded(width);
 		if (f.isDefined()) {
 			out << f << " " << units;
 		} else {
@@ -427,32 +434,32 @@ namespace output
 		out << "</td>";
 	}
 
-	void GoogleMap::dumpSessionSummary(std::ostream &out, const Session* session)
+	void GoogleMap::dumpSessionSummary(Writer &out, const Session* session)
 	{
-		out << "<div id=\"summary\" style=\"width: 100% ; text-align:left\">" << std::endl;
-		out << "<b>Session summary:</b><br>" << std::endl;
+		out << "<div id=\"summary\" style=\"width: 100% ; text-align:left\">\n";
+		out << "<b>Session summary:</b><br>\n";
 		out << "Time: " << durationAsString(session->getDuration()) << ", ";
 		out << "Distance: " << session->getDistance()/1000.0 << " km";
-		out << session->getMaxSpeed().toStream(", MaxSpeed: ", " km/h");
-		out << session->getAvgSpeed().toStream(", AvgSpeed: ", " km/h");
-		out << ".</div>" << std::endl;
+		out << ifDefined(session->getMaxSpeed(), ", MaxSpeed: ", " km/h");
+		out << ifDefined(session->getAvgSpeed(), ", AvgSpeed: ", " km/h");
+		out << ".</div>\n";
 		auto laps = session->getLaps();
 		if (laps.size() > 0)
 		{
-			out << "<div id=\"lap_info\" style=\"width: 100% ; text-align:left\">" << std::endl;
-			out << "<b>Lap details:</b><br>" << std::endl;
-			out << "<table border='1'><tr><th>lap</th><th>time</th><th>distance</th><th>average speed</th><th>max speed</th><th>average heartrate</th><th>max heartrate</th></tr>" << std::endl;
+			out << "<div id=\"lap_info\" style=\"width: 100% ; text-align:left\">\n";
+			out << "<b>Lap details:</b><br>\n";
+			out << "<table border='1'><tr><th>lap</th><th>time</th><th>distance</th><th>average speed</th><th>max speed</th><th>average heartrate</th><th>max heartrate</th></tr>\n";
 			for(const auto& lap : laps)
 			{
 				out << "<tr>";
-				out << "<td>" << std::setw(3)  << lap->getLapNum() + 1                 << "</td>";
-				out << "<td>" << std::setw(10) << durationAsString(lap->getDuration()) << "</td>";
-				out << "<td>" << std::setw(4)  << lap->getDistance()/1000.0            << " km</td>";
+				out << "<td>" << padded(3)  << lap->getLapNum() + 1                 << "</td>";
+				out << "<td>" << padded(10) << durationAsString(lap->getDuration()) << "</td>";
+				out << "<td>" << padded(4)  << lap->getDistance()/1000.0            << " km</td>";
 				displayOptionalValue(out, lap->getAvgSpeed(), 6, "km/h");
 				displayOptionalValue(out, lap->getMaxSpeed(), 6, "km/h");
 				displayOptionalValue(out, lap->getAvgHeartrate(), 4, "bpm");
 				displayOptionalValue(out, lap->getMaxHeartrate(), 4, "bpm");
-				out << "</tr>" << std::endl;
+				out << "</tr>\n";
 			}
 			out << "</table></div>";
 		}
@@ -9,16 +9,22 @@ namespace output
 	class GoogleMap : public FileOutput
 	{
 		public:
-			void dumpContent(std::ostream &out, const Session *session, std::map<std::string, std::string> &configuration) override;
+			GoogleMap() : _mapHeight(DEFAULT_MAP_HEIGHT) { };
+			void configure(const Configuration &configuration) override;
+			void dumpContent(Writer &out, const Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "GoogleMap"; };
 			std::string getExt() override { return "html"; };
 
-			void dumpSessionSummary(std::ostream &out, const Session *session);
+			void dumpSessionSummary(Writer &out, const Session *session);
 
 			template <typename T>
-			void displayOptionalValue(std::ostream &out, Field<T> f, int width, const std::string& units) const;
+			void displayOptionalValue(Writer &out, Field<T> f, int width, const std::string& units) const;
 
 		private:
+			static const uint32_t DEFAULT_MAP_HEIGHT = 500;
+			// Empty when no key is configured
+			std::string _apiKey;
+			uint32_t _mapHeight;
 			DECLARE_OUTPUT(GoogleMap);
 	};
 }
@@ -8,7 +8,7 @@ namespace output
 {
 	REGISTER_OUTPUT(GoogleStaticMap);
 
-	void GoogleStaticMap::dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration)
+	void GoogleStaticMap::dumpContent(Writer &out, const Session *session, const Configuration &configuration)
 	{
 		// Latitude and longitude retrieved from the GPS has 6 decimals and can habe 2 digits before decimal point
 		out.precision(8);
@@ -18,8 +18,8 @@ namespace output
 		// So we have to filter points so that 22 * lap + 107 + 22 * remaining_points < 2048 (hoping we don't have too much laps !)
 		// i.e. remaining_points < 89 - lap
 		// and remaining_points = points / filter => filter = points / (89 - lap) (plus one for rounding)
-		std::vector<Point*> points = session->getPoints();
-		std::vector<Lap*> laps = session->getLaps();
+		const std::vector<Point*> &points = session->getPoints();
+		const std::vector<Lap*> &laps = session->getLaps();
 		uint32_t filter = 1 + points.size() / (89 - laps.size());
 		uint32_t filter_index = 0;
 		for(const auto& point : points)
@@ -40,6 +40,6 @@ namespace output
 				std::cerr << "Start point of lap is nullptr - This deserves a bug report !" << std::endl;
 			}
 		}
-		out << std::endl;
+		out << '\n';
 	}
 }
@@ -9,51 +9,51 @@ namespace output
 {
 	REGISTER_OUTPUT(KML);
 
-	void KML::dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration)
+	void KML::dumpContent(Writer &out, const Session *session, const Configuration &configuration)
 	{
 		// Latitude and longitude retrieved from the GPS has 6 decimals and can habe 2 digits before decimal point
 		out.precision(8);
 
 		// TODO: Whole KML support !
-		out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
-		out << "<kml xmlns=\"http://www.opengis.net/kml/2.2\" xmlns:gx=\"http://www.google.com/kml/ext/2.2\" xmlns:kml=\"http://www.opengis.net/kml/2.2\" xmlns:atom=\"http://www.w3.org/2005/Atom\">" << std::endl;
-		out << "<Document>" << std::endl;
-		out << "<name>" << session->getName() << "</name>" << std::endl;
-		out << "<open>1</open>" << std::endl;
+		out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+		out << "<kml xmlns=\"http://www.opengis.net/kml/2.2\" xmlns:gx=\"http://www.google.com/kml/ext/2.2\" xmlns:kml=\"http://www.opengis.net/kml/2.2\" xmlns:atom=\"http://www.w3.org/2005/Atom\">\n";
+		out << "<Document>\n";
+		out << "<name>" << escaped(session->getName()) << "</name>\n";
+		out << "<open>1</open>\n";
 
-		out << "<Style id=\"kalenji_lap\">" << std::endl;
-		out << "<IconStyle>" << std::endl;
-		out << "<color>ff00ffff</color>" << std::endl;
-		out << "<scale>0.7</scale>" << std::endl;
-		out << "<Icon>" << std::endl;
-		out << "<href>http://maps.google.com/mapfiles/kml/pal4/icon28.png</href>" << std::endl;
-		out << "</Icon>" << std::endl;
-		out << "</IconStyle>" << std::endl;
-		out << "</Style>" << std::endl;
+		out << "<Style id=\"kalenji_lap\">\n";
+		out << "<IconStyle>\n";
+		out << "<color>ff00ffff</color>\n";
+		out << "<scale>0.7</scale>\n";
+		out << "<Icon>\n";
+		out << "<href>http://maps.google.com/mapfiles/kml/pal4/icon28.png</href>\n";
+		out << "</Icon>\n";
+		out << "</IconStyle>\n";
+		out << "</Style>\n";
 
-		out << "<Style id=\"kalenji_runner\">" << std::endl;
-		out << "<IconStyle>" << std::endl;
-		out << "<color>ff0000ff</color>" << std::endl;
-		out << "<scale>1.0</scale>" << std::endl;
-		out << "<Icon>" << std::endl;
-		out << "<href>http://maps.google.com/mapfiles/kml/pal2/icon57.png</href>" << std::endl;
-		out << "</Icon>" << std::endl;
-		out << "</IconStyle>" << std::endl;
-		out << "</Style>" << std::endl;
+		out << "<Style id=\"kalenji_runner\">\n";
+		out << "<IconStyle>\n";
+		out << "<color>ff0000ff</color>\n";
+		out << "<scale>1.0</scale>\n";
+		out << "<Icon>\n";
+		out << "<href>http://maps.google.com/mapfiles/kml/pal2/icon57.png</href>\n";
+		out << "</Icon>\n";
+		out << "</IconStyle>\n";
+		out << "</Style>\n";
 
-		out << "<Style id=\"kalenji_trajet\">" << std::endl;
-		out << "<IconStyle>" << std::endl;
-		out << "<scale>1.1</scale>" << std::endl;
-		out << "<Icon>" << std::endl;
-		out << "<href>http://maps.google.com/mapfiles/kml/pushpin/ylw-pushpin.png</href>" << std::endl;
-		out << "</Icon>" << std::endl;
-		out << "<hotSpot x=\"20\" y=\"2\" xunits=\"pixels\" yunits=\"pixels\"/>" << std::endl;
-		out << "</IconStyle>" << std::endl;
-		out << "<LineStyle>" << std::endl;
-		out << "<color>ff00ffff</color>" << std::endl;
-		out << "<width>3</width>" << std::endl;
-		out << "</LineStyle>" << std::endl;
-		out << "</Style>" << std::endl;
+		out << "<Style id=\"kalenji_trajet\">\n";
+		out << "<IconStyle>\n";
+		out << "<scale>1.1</scale>\n";
+		out << "<Icon>\n";
+		out << "<href>http://maps.google.com/mapfiles/kml/pushpin/ylw-pushpin.png</href>\n";
+		out << "</Icon>\n";
+		out << "<hotSpot x=\"20\" y=\"2\" xunits=\"pixels\" yunits=\"pixels\"/>\n";
+		out << "</IconStyle>\n";
+		out << "<LineStyle>\n";
+		out << "<color>ff00ffff</color>\n";
+		out << "<width>3</width>\n";
+		out << "</LineStyle>\n";
+		out << "</Style>\n";
 
 		std::vector<Lap*> laps = session->getLaps();
 		uint32_t i = 0;
@@ -62,75 +62,74 @@ namespace output
 			++i;
 			if(lap->getEndPoint() != nullptr)
 			{
-				out << "<Placemark>" << std::endl;
-				out << "<name>Lap " << i << "</name>" << std::endl;
-				out << "<styleUrl>kalenji_lap</styleUrl>" << std::endl;
-				out << "<description>" << std::endl;
+				out << "<Placemark>\n";
+				out << "<name>Lap " << i << "</name>\n";
+				out << "<styleUrl>kalenji_lap</styleUrl>\n";
+				out << "<description>\n";
 				out << "<b>Distance:</b> " << lap->getDistance()/1000.0 << " km<br/>";
 				out << "<b>Time:</b> " << durationAsString(lap->getDuration()) << "<br/>";
-				out << lap->getAvgSpeed().toStream("<b>Average speed:</b> ", " km/h<br/>");
-				out << lap->getMaxSpeed().toStream("<b>Maximum speed:</b> ", " km/h<br/>");
-				out << lap->getAvgHeartrate().toStream("<b>Average heartrate:</b> ", " bpm<br/>");
-				out << lap->getMaxHeartrate().toStream("<b>Maximum heartrate:</b> ", " bpm<br/>");
-				out << "</description>" << std::endl;
-				out << "<Point>" << std::endl;
-				out << "<coordinates>" << lap->getEndPoint()->getLongitude() << "," << lap->getEndPoint()->getLatitude() << "," << lap->getEndPoint()->getAltitude() << "</coordinates>" << std::endl;
-				out << "</Point>" << std::endl;
-				out << "</Placemark>" << std::endl;
+				out << ifDefined(lap->getAvgSpeed(), "<b>Average speed:</b> ", " km/h<br/>");
+				out << ifDefined(lap->getMaxSpeed(), "<b>Maximum speed:</b> ", " km/h<br/>");
+				out << ifDefined(lap->getAvgHeartrate(), "<b>Average heartrate:</b> ", " bpm<br/>");
+				out << ifDefined(lap->getMaxHeartrate(), "<b>Maximum heartrate:</b> ", " bpm<br/>");
+				out << "</description>\n";
+				out << "<Point>\n";
+				out << "<coordinates>" << lap->getEndPoint()->getLongitude() << "," << lap->getEndPoint()->getLatitude() << "," << lap->getEndPoint()->getAltitude() << "</coordinates>\n";
+				out << "</Point>\n";
+				out << "</Placemark>\n";
 			}
 		}
 
-		out << "<Placemark>" << std::endl;
-		out << "<name>Trajet</name>" << std::endl;
-		out << "<styleUrl>#kalenji_trajet</styleUrl>" << std::endl;
-		out << "<LineString>" << std::endl;
-		out << "<tessellate>1</tessellate>" << std::endl;
-		out << "<coordinates>" << std::endl;
-		std::vector<Point*> points = session->getPoints();
+		out << "<Placemark>\n";
+		out << "<name>Trajet</name>\n";
+		out << "<styleUrl>#kalenji_trajet</styleUrl>\n";
+		out << "<LineString>\n";
+		out << "<tessellate>1</tessellate>\n";
+		out << "<coordinates>\n";
+		const PointColumns &points = session->getColumns();
 		for(const auto& point : points)
 		{
-			out << point->getLongitude() << "," << point->getLatitude() << "," << point->getAltitude() << " ";
+			out << point.getLongitude() << "," << point.getLatitude() << "," << point.getAltitude() << " ";
 		}
-		out << "</coordinates>" << std::endl;
-		out << "</LineString>" << std::endl;
-		out << "</Placemark>" << std::endl;
+		out << "</coordinates>\n";
+		out << "</LineString>\n";
+		out << "</Placemark>\n";
 
-		out << "<Placemark>" << std::endl;
-		out << "<name>Runner</name>" << std::endl;
-		out << "<styleUrl>kalenji_runner</styleUrl>" << std::endl;
-		out << "<Point id=\"runner\">" << std::endl;
-		auto it = points.begin();
-		out << "<coordinates>" << (*it)->getLongitude() << "," << (*it)->getLatitude() << "," << (*it)->getAltitude() << "</coordinates>" << std::endl;
-		out << "</Point>" << std::endl;
-		out << "</Placemark>" << std::endl << std::endl;
+		out << "<Placemark>\n";
+		out << "<name>Runner</name>\n";
+		out << "<styleUrl>kalenji_runner</styleUrl>\n";
+		out << "<Point id=\"runner\">\n";
+		out << "<coordinates>" << points[0].getLongitude() << "," << points[0].getLatitude() << "," << points[0].getAltitude() << "</coordinates>\n";
+		out << "</Point>\n";
+		out << "</Placemark>\n\n";
 
-		out << "<gx:Tour>" << std::endl;
-		out << "<name>Animation</name>" << std::endl;
-		out << "<gx:Playlist>" << std::endl;
+		out << "<gx:Tour>\n";
+		out << "<name>Animation</name>\n";
+		out << "<gx:Playlist>\n";
 		for(const auto& point : points)
 		{
 			double duration = 0.1;
-			out << "<gx:AnimatedUpdate>" << std::endl;
-			out << "<gx:duration>" << duration << "</gx:duration>" << std::endl;
-			out << "<Update>" << std::endl;
-			out << "<targetHref></targetHref>" << std::endl;
-			out << "<Change>" << std::endl;
-			out << "<Point targetId=\"runner\"> " << std::endl;
-			out << "<coordinates>" << point->getLongitude() << "," << point->getLatitude() << "," << point->getAltitude() << "</coordinates> " << std::endl;
-			out << "</Point>" << std::endl;
-			out << "</Change> " << std::endl;
-			out << "</Update>" << std::endl;
-			out << "<gx:delayedStart>0</gx:delayedStart>" << std::endl;
-			out << "</gx:AnimatedUpdate>" << std::endl << std::endl;
+			out << "<gx:AnimatedUpdate>\n";
+			out << "<gx:duration>" << duration << "</gx:duration>\n";
+			out << "<Update>\n";
+			out << "<targetHref></targetHref>\n";
+			out << "<Change>\n";
+			out << "<Point targetId=\"runner\"> \n";
+			out << "<coordinates>" << point.getLongitude() << "," << point.getLatitude() << "," << point.getAltitude() << "</coordinates> \n";
+			out << "</Point>\n";
+			out << "</Change> \n";
+			out << "</Update>\n";
+			out << "<gx:delayedStart>0</gx:delayedStart>\n";
+			out << "</gx:AnimatedUpdate>\n\n";
 
-			out << "<gx:Wait>" << std::endl;
-			out << "<gx:duration>" << duration << "</gx:duration>" << std::endl;
-			out << "</gx:Wait>" << std::endl;
+			out << "<gx:Wait>\n";
+			out << "<gx:duration>" << duration << "</gx:duration>\n";
+			out << "</gx:Wait>\n";
 		}
-		out << "</gx:Playlist>" << std::endl;
-		out << "</gx:Tour>" << std::endl;
+		out << "</gx:Playlist>\n";
+		out << "</gx:Tour>\n";
 
-		out << "</Document>" << std::endl;
-		out << "</kml>" << std::endl;
+		out << "</Document>\n";
+		out << "</kml>\n";
 	}
 }
@@ -9,7 +9,7 @@ namespace output
 	class KML : public FileOutput
 	{
 		public:
-			void dumpContent(std::ostream &out, const Session *session, std::map<std::string, std::string> &configuration) override;
+			void dumpContent(Writer &out, const Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "KML"; };
 			std::string getExt() override { return "kml"; }
 
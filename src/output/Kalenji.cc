@@ -11,7 +11,7 @@ namespace output
 {
 	REGISTER_OUTPUT(Kalenji);
 
-	void Kalenji::dump(const Session *session, std::map<std::string, std::string> &configuration)
+	void Kalenji::dump(const Session *session, const Configuration &configuration)
 	{
 		source::Source *dataSource = new source::USB();
 		device::Device *dev = new device::Kalenji();
@@ -26,7 +26,7 @@ namespace output
 	{
 		// TODO: Send the content to USB instead of a file
 		std::stringstream filename;
-		filename << configuration["directory"] << "/";
+		filename << configuration.getDirectory() << "/";
 		filename << session->getYear() << std::setw(2) << std::setfill('0') << session->getMonth() << std::setw(2) << std::setfill('0') << session->getDay() << "_";
 		filename << std::setw(2) << std::setfill('0') << session->getHour() << std::setw(2) << std::setfill('0') << session->getMinutes() << std::setw(2) << std::setfill('0') << session->getSeconds() << ".data";
 		std::cout << "Creating " << filename.str() << std::endl;
@@ -1,4 +1,5 @@
 #include "Output.h"
+#include "../Utils.h"
 #include <sstream>
 #include <iomanip>
 #include <fstream>
@@ -7,11 +8,11 @@
 
 namespace output
 {
-	std::string FileOutput::getFileName(const Session *session, std::map<std::string, std::string> &configuration)
+	std::string FileOutput::getFileName(const Session *session, const Configuration &configuration)
 	{
 		std::ostringstream filename;
-		filename << configuration["directory"] << "/";
-		if(configuration["output_name"] == "name")
+		filename << configuration.getDirectory() << "/";
+		if(configuration.getOutputName() == Configuration::OUTPUT_NAME_SESSION_NAME)
 		{
 			filename << session->getName();
 		}
@@ -28,16 +29,22 @@ namespace output
 		return filename.str();
 	}
 
-	void FileOutput::dump(const Session *session, std::map<std::string, std::string> &configuration)
+	void FileOutput::dump(const Session *session, const Configuration &configuration)
 	{
 		std::string filename(getFileName(session, configuration));
 		std::ofstream mystream(filename.c_str());
 		std::cout << "Creating " << filename << std::endl;
-		dumpContent(mystream, session, configuration);
+		Writer writer(mystream);
+		dumpContent(writer, session, configuration);
+		writer.flush();
 		mystream.close();
+		if(mystream.fail())
+		{
+			THROW_STREAM("Unable to write " << filename);
+		}
 	}
 
-	bool FileOutput::exists(const Session *session, std::map<std::string, std::string> &configuration)
+	bool FileOutput::exists(const Session *session, const Configuration &configuration)
 	{
 		return access(getFileName(session, configuration).c_str(), F_OK) == 0;
 	}
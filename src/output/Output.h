@@ -2,8 +2,9 @@
 #define _OUTPUT_OUTPUT_HPP_
 
 #include "../Registry.h"
+#include "../Configuration.h"
 #include "../bom/Session.h"
-#include <ostream>
+#include "Writer.h"
 
 #define DECLARE_OUTPUT(OutputClass) static LayerRegistrer<Output, OutputClass> _registrer;
 #define REGISTER_OUTPUT(OutputClass) LayerRegistrer<Output, OutputClass> OutputClass::_registrer;
@@ -14,19 +15,23 @@ namespace output
 	{
 		public:
 			virtual ~Output() = default;
-			// TODO: I don't really like giving the configuration this way. Better way to configure each output ?
-			virtual void dump(const Session *session, std::map<std::string, std::string> &configuration) = 0;
-			virtual bool exists(const Session *session, std::map<std::string, std::string> &configuration) { return false; }
+			/**
+			 * Reads the options of the output. Called once, before any session is dumped.
+			 * @throw std::runtime_error if an option is invalid
+			 */
+			virtual void configure(const Configuration &configuration) { };
+			virtual void dump(const Session *session, const Configuration &configuration) = 0;
+			virtual bool exists(const Session *session, const Configuration &configuration) { return false; }
 			virtual std::string getName() = 0;
 	};
 
 	class FileOutput: public Output
 	{
 		public:
-			std::string getFileName(const Session *session, std::map<std::string, std::string> &configuration);
-			void dump(const Session *session, std::map<std::string, std::string> &configuration) override;
-			virtual void dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration) = 0;
-			bool exists(const Session *session, std::map<std::string, std::string> &configuration) override;
+			std::string getFileName(const Session *session, const Configuration &configuration);
+			void dump(const Session *session, const Configuration &configuration) override;
+			virtual void dumpContent(Writer &out, const Session *session, const Configuration &configuration) = 0;
+			bool exists(const Session *session, const Configuration &configuration) override;
 			virtual std::string getExt() = 0;
 	};
 }
@@ -3,102 +3,99 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
 
 namespace output
 {
 	REGISTER_OUTPUT(TCX);
 
-	void TCX::dumpContent(std::ostream& out, const Session *session, std::map<std::string, std::string> &configuration)
+	void TCX::dumpContent(Writer &out, const Session *session, const Configuration &configuration)
 	{
 		// Latitude and longitude retrieved from the GPS has 6 decimals and can habe 2 digits before decimal point
 		out.precision(12);
-		out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
+		out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
 		out << "<TrainingCenterDatabase xmlns=\"http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2\""
 				" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:schemaLocation="
 				"\"http://www.garmin.com/xmlschemas/ActivityExtension/v2 "
 				"http://www.garmin.com/xmlschemas/ActivityExtensionv2.xsd "
 				"http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2 "
-				"http://www.garmin.com/xmlschemas/TrainingCenterDatabasev2.xsd\">" << std::endl;
-		out << " <Activities>" << std::endl;
-		out << "  <Activity Sport=\"" << configuration["tcx_sport"] << "\">" << std::endl;
-		out << "   <Id>" << session->getBeginTime() << "</Id>" << std::endl;
+				"http://www.garmin.com/xmlschemas/TrainingCenterDatabasev2.xsd\">\n";
+		out << " <Activities>\n";
+		out << "  <Activity Sport=\"" << escaped(_sport) << "\">\n";
+		out << "   <Id>" << session->getBeginTime() << "</Id>\n";
 		std::vector<Lap*> laps = session->getLaps();
-		std::vector<Point*> points = session->getPoints();
-		auto pit = points.begin();
+		const PointColumns &points = session->getColumns();
+		const std::vector<double> &distances = points.getCumulativeDistances();
 		uint32_t point_id = 0;
+		TimeCodec timeCodec;
+		char time[TimeCodec::FORMAT_BUFFER_SIZE];
 		for(const auto& lap : laps)
 		{
 			if(lap->getStartPoint() != nullptr)
 			{
-				out << "   <Lap StartTime=\"" << lap->getStartPoint()->getTimeAsString() << "\">" << std::endl;
+				timeCodec.format(lap->getStartPoint()->getTime(), lap->getStartPoint()->getMillis(), time);
+				out << "   <Lap StartTime=\"" << time << "\">\n";
 			}
 			else
 			{
-				out << "   <Lap>" << std::endl;
+				out << "   <Lap>\n";
 			}
-			out << "    <TotalTimeSeconds>" << lap->getDuration() << "</TotalTimeSeconds>" << std::endl;
-			out << "    <DistanceMeters>" << lap->getDistance() << "</DistanceMeters>" << std::endl;
-			out << "    <MaximumSpeed>" << lap->getMaxSpeed() << "</MaximumSpeed>" << std::endl;
-			out << "    <Calories>" << lap->getCalories() << "</Calories>" << std::endl;
+			out << "    <TotalTimeSeconds>" << lap->getDuration() << "</TotalTimeSeconds>\n";
+			out << "    <DistanceMeters>" << lap->getDistance() << "</DistanceMeters>\n";
+			out << "    <MaximumSpeed>" << lap->getMaxSpeed() << "</MaximumSpeed>\n";
+			out << "    <Calories>" << lap->getCalories() << "</Calories>\n";
 			out << "    <AverageHeartRateBpm xsi:type=\"HeartRateInBeatsPerMinute_t\"><Value>"
-				<< lap->getAvgHeartrate() << "</Value></AverageHeartRateBpm>" << std::endl;
+				<< lap->getAvgHeartrate() << "</Value></AverageHeartRateBpm>\n";
 			out << "    <MaximumHeartRateBpm xsi:type=\"HeartRateInBeatsPerMinute_t\"><Value>"
-				<< lap->getMaxHeartrate() << "</Value></MaximumHeartRateBpm>" << std::endl;
-			out << "    <Intensity>Active</Intensity>" << std::endl;
-			out << "    <TriggerMethod>Distance</TriggerMethod>" << std::endl;
+				<< lap->getMaxHeartrate() << "</Value></MaximumHeartRateBpm>\n";
+			out << "    <Intensity>Active</Intensity>\n";
+			out << "    <TriggerMethod>Distance</TriggerMethod>\n";
 
 			// goto first point of this lap
-			while (point_id < lap->getFirstPointId()) {
-				if (pit == points.end())
-					break;
-				++point_id;
-				++pit;
-			}
+			if (point_id < lap->getFirstPointId())
+				point_id = std::min<size_t>(lap->getFirstPointId(), points.size());
 
-			out << "    <Track>" << std::endl;
-			double total_dist = 0;
-			time_t prev_time = (*points.begin())->getTime();
-			for(; pit != points.end(); ++pit, ++point_id)
+			out << "    <Track>\n";
+			for(; point_id < points.size(); ++point_id)
 			{
-				double delta_tm = difftime((*pit)->getTime(), prev_time);
-				total_dist += delta_tm * (*pit)->getSpeed() / 3.6;
-				out << "     <Trackpoint>" << std::endl;
-				out << "      <Time>" << (*pit)->getTimeAsString() << "</Time>" << std::endl;
-				if ((*pit)->getLatitude().isDefined() && (*pit)->getLongitude().isDefined())
+				PointRef point = points[point_id];
+				out << "     <Trackpoint>\n";
+				timeCodec.format(point.getTime(), point.getMillis(), time);
+				out << "      <Time>" << time << "</Time>\n";
+				if (point.getLatitude().isDefined() && point.getLongitude().isDefined())
 				{
 					out << "      <Position>"
-						<< (*pit)->getLatitude().toStream("<LatitudeDegrees>", "</LatitudeDegrees>")
-						<< (*pit)->getLongitude().toStream("<LongitudeDegrees>", "</LongitudeDegrees>")
-						<< "</Position>" << std::endl;
+						<< ifDefined(point.getLatitude(), "<LatitudeDegrees>", "</LatitudeDegrees>")
+						<< ifDefined(point.getLongitude(), "<LongitudeDegrees>", "</LongitudeDegrees>")
+						<< "</Position>\n";
 				}
-				out << "      <AltitudeMeters>" << (*pit)->getAltitude().toStream() << "</AltitudeMeters>" << std::endl;
-				out << "      <DistanceMeters>" << total_dist << "</DistanceMeters>" << std::endl;
-				out << (*pit)->getHeartRate().toStream(
+				out << "      <AltitudeMeters>" << ifDefined(point.getAltitude()) << "</AltitudeMeters>\n";
+				out << "      <DistanceMeters>" << distances[point_id] << "</DistanceMeters>\n";
+				out << ifDefined(point.getHeartRate(),
 					"      <HeartRateBpm xsi:type=\"HeartRateInBeatsPerMinute_t\"><Value>",
-				    "</Value></HeartRateBpm>") << std::endl;
-				out << "      <Extensions>" << std::endl;
-				out << "       <TPX xmlns=\"http://www.garmin.com/xmlschemas/ActivityExtension/v2\" CadenceSensor=\"Footpod\">" << std::endl;
-				if((*pit)->getSpeed().isDefined())
+				    "</Value></HeartRateBpm>") << '\n';
+				out << "      <Extensions>\n";
+				out << "       <TPX xmlns=\"http://www.garmin.com/xmlschemas/ActivityExtension/v2\" CadenceSensor=\"Footpod\">\n";
+				if(point.getSpeed().isDefined())
 				{
-					out << "         <Speed>" << (*pit)->getSpeed() / 3.6 << "</Speed>" << std::endl;
+					out << "         <Speed>" << point.getSpeed() / 3.6 << "</Speed>\n";
 				}
-				out << "       </TPX>" << std::endl;
-				out << "      </Extensions>" << std::endl;
-				out << "     </Trackpoint>" << std::endl;
+				out << "       </TPX>\n";
+				out << "      </Extensions>\n";
+				out << "     </Trackpoint>\n";
 
-				prev_time = (*pit)->getTime();
 				if (point_id == lap->getLastPointId())
 					break;
 			}
-			out << "    </Track>" << std::endl;
-			out << "   </Lap>" << std::endl;
+			out << "    </Track>\n";
+			out << "   </Lap>\n";
 		}
 
 		// TODO: creator
-		out << "  </Activity>" << std::endl;
-		out << " </Activities>" << std::endl;
+		out << "  </Activity>\n";
+		out << " </Activities>\n";
 
 		// TODO: author
-		out << "</TrainingCenterDatabase>" << std::endl;
+		out << "</TrainingCenterDatabase>\n";
 	}
 }
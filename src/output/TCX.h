@@ -1,5 +1,5 @@
-#ifndef _OUTPUT_GPX_HPP_
-#define _OUTPUT_GPX_HPP_
+#ifndef _OUTPUT_TCX_HPP_
+#define _OUTPUT_TCX_HPP_
 
 #include "../bom/Session.h"
 #include "Output.h"
@@ -9,11 +9,13 @@ namespace output
 	class TCX : public FileOutput
 	{
 		public:
-			void dumpContent(std::ostream &out, const Session *session, std::map<std::string, std::string> &configuration) override;
+			void configure(const Configuration &configuration) override { _sport = configuration.get("tcx_sport"); };
+			void dumpContent(Writer &out, const Session *session, const Configuration &configuration) override;
 			std::string getName() override { return "TCX"; };
 			std::string getExt() override { return "tcx"; }
 
 		private:
+			std::string _sport;
 			DECLARE_OUTPUT(TCX);
 	};
 }
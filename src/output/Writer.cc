@@ -0,0 +1,131 @@
+#include "Writer.h"
+#include <cstdio>
+
+namespace output
+{
+	Writer::Writer(std::ostream &oStream, size_t iCapacity) : _stream(oStream), _buffer(new char[iCapacity]), _capacity(iCapacity), _size(0), _precision(6), _width(0)
+	{
+	}
+
+	Writer::~Writer()
+	{
+		flush();
+	}
+
+	void Writer::flush()
+	{
+		_stream.write(_buffer.get(), _size);
+		_size = 0;
+	}
+
+	Writer& Writer::writeLong(const char *iText, size_t iSize)
+	{
+		if(_width != 0)
+		{
+			size_t width = _width;
+			_width = 0;
+			for(; width > iSize; --width)
+			{
+				*this << ' ';
+			}
+		}
+		if(iSize > _capacity - _size)
+		{
+			flush();
+			if(iSize > _capacity)
+			{
+				_stream.write(iText, iSize);
+				return *this;
+			}
+		}
+		return write(iText, iSize);
+	}
+
+	Writer& Writer::writeSigned(long long iValue)
+	{
+		if(iValue >= 0) return writeUnsigned(iValue);
+		char text[NUMBER_SIZE];
+		char *begin = text + NUMBER_SIZE;
+		// Negated as unsigned so that the smallest value doesn't overflow
+		unsigned long long value = 0ULL - (unsigned long long) iValue;
+		do
+		{
+			*--begin = '0' + value % 10;
+			value /= 10;
+		}
+		while(value != 0);
+		*--begin = '-';
+		return write(begin, text + NUMBER_SIZE - begin);
+	}
+
+	Writer& Writer::writeUnsigned(unsigned long long iValue)
+	{
+		char text[NUMBER_SIZE];
+		char *begin = text + NUMBER_SIZE;
+		do
+		{
+			*--begin = '0' + iValue % 10;
+			iValue /= 10;
+		}
+		while(iValue != 0);
+		return write(begin, text + NUMBER_SIZE - begin);
+	}
+
+	Writer& Writer::writeDouble(double iValue, int iPrecision)
+	{
+		// What std::ostream does with the default float field
+		char text[NUMBER_SIZE];
+		int size = snprintf(text, NUMBER_SIZE, "%.*g", iPrecision, iValue);
+		if(size < 0) return *this;
+		if((size_t)size >= NUMBER_SIZE)
+		{
+			// Only with a precision of more than 20 digits
+			std::unique_ptr<char[]> longText(new char[size + 1]);
+			snprintf(longText.get(), size + 1, "%.*g", iPrecision, iValue);
+			return write(longText.get(), size);
+		}
+		return write(text, size);
+	}
+
+	Writer& Writer::hex(uint32_t iValue, int iWidth)
+	{
+		static const char digits[] = "0123456789abcdef";
+		char text[NUMBER_SIZE];
+		char *begin = text + NUMBER_SIZE;
+		do
+		{
+			*--begin = digits[iValue & 0xF];
+			iValue >>= 4;
+		}
+		while(iValue != 0);
+		while(text + NUMBER_SIZE - begin < iWidth && begin > text)
+		{
+			*--begin = '0';
+		}
+		return write(begin, text + NUMBER_SIZE - begin);
+	}
+
+	Writer& Writer::operator<<(const EscapedText &iText)
+	{
+		const char *text = iText.text.data();
+		const char *end = text + iText.text.size();
+		const char *unchanged = text;
+		for(; text < end; ++text)
+		{
+			const char *entity;
+			switch(*text)
+			{
+				case '&':  entity = "&amp;";  break;
+				case '<':  entity = "&lt;";   break;
+				case '>':  entity = "&gt;";   break;
+				case '"':  entity = "&quot;"; break;
+				case '\'': entity = "&apos;"; break;
+				default: continue;
+			}
+			write(unchanged, text - unchanged);
+			*this << entity;
+			unchanged = text + 1;
+		}
+		return write(unchanged, end - unchanged);
+	}
+}
@@ -0,0 +1,144 @@
+#ifndef _OUTPUT_WRITER_HPP_
+#define _OUTPUT_WRITER_HPP_
+
+#include "../bom/Field.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Size of the buffer of a Writer: written to its stream when full
+#define WRITER_BUFFER_SIZE (1 << 20)
+
+namespace output
+{
+	template<typename T>
+	struct DefinedField
+	{
+		const Field<T> &field;
+		const char *before;
+		const char *after;
+	};
+
+	/**
+	  Writes a field surrounded by before and after, only if it is defined, with 8 significant digits
+	  whatever the precision of the writer: out << ifDefined(point.getAltitude(), "<ele>", "</ele>");
+	 */
+	template<typename T>
+	DefinedField<T> ifDefined(const Field<T> &iField, const char *iBefore = "", const char *iAfter = "")
+	{
+		return DefinedField<T> { iField, iBefore, iAfter };
+	}
+
+	struct Padding
+	{
+		int width;
+	};
+
+	// Minimal width of the next value written, padded with spaces on the left as with std::setw
+	inline Padding padded(int iWidth)
+	{
+		return Padding { iWidth };
+	}
+
+	struct EscapedText
+	{
+		const std::string &text;
+	};
+
+	// Text written with the characters reserved in XML replaced by entities
+	inline EscapedText escaped(const std::string &iText)
+	{
+		return EscapedText { iText };
+	}
+
+	/**
+	  Writes the content of an output file in a large buffer, given to the stream only when it is full
+	  or when the writer is flushed or destroyed. Text and numbers are written with << as they would be in
+	  a std::ostream (numbers are formatted the same way, with the same precision) but without any
+	  temporary string and without flushing the stream on each line.
+	 */
+	class Writer
+	{
+		public:
+			explicit Writer(std::ostream &oStream, size_t iCapacity = WRITER_BUFFER_SIZE);
+			~Writer();
+			Writer(const Writer&) = delete;
+			Writer& operator=(const Writer&) = delete;
+
+			// Gives what has been written to the stream
+			void flush();
+
+			// Significant digits of floating point numbers, as std::ostream::precision
+			void precision(int iPrecision) { _precision = iPrecision; };
+			// Writes a number in hexadecimal on at least iWidth digits, padded with 0
+			Writer& hex(uint32_t iValue, int iWidth = 0);
+
+			Writer& operator<<(char iChar)                     { return write(&iChar, 1); };
+			// strlen of a literal is computed at compile time
+			Writer& operator<<(const char *iText)              { return write(iText, strlen(iText)); };
+			Writer& operator<<(const std::string &iText)       { return write(iText.data(), iText.size()); };
+			Writer& operator<<(short iValue)                   { return writeSigned(iValue); };
+			Writer& operator<<(int iValue)                     { return writeSigned(iValue); };
+			Writer& operator<<(long iValue)                    { return writeSigned(iValue); };
+			Writer& operator<<(long long iValue)               { return writeSigned(iValue); };
+			Writer& operator<<(unsigned short iValue)          { return writeUnsigned(iValue); };
+			Writer& operator<<(unsigned int iValue)            { return writeUnsigned(iValue); };
+			Writer& operator<<(unsigned long iValue)           { return writeUnsigned(iValue); };
+			Writer& operator<<(unsigned long long iValue)      { return writeUnsigned(iValue); };
+			Writer& operator<<(double iValue)                  { return writeDouble(iValue, _precision); };
+			Writer& operator<<(const Padding &iPadding)        { _width = iPadding.width; return *this; };
+			Writer& operator<<(const EscapedText &iText);
+
+			// As with a std::ostream, the value of a field is written even if it isn't defined
+			template<typename T>
+			Writer& operator<<(const Field<T> &iField)         { return *this << iField.getValue(); };
+
+			template<typename T>
+			Writer& operator<<(const DefinedField<T> &iField)
+			{
+				if(iField.field.isDefined())
+				{
+					*this << iField.before;
+					int precision = _precision;
+					_precision = FIELD_PRECISION;
+					*this << iField.field.getValue();
+					_precision = precision;
+					*this << iField.after;
+				}
+				return *this;
+			};
+
+		private:
+			static const int FIELD_PRECISION = 8;
+			// Longest number written: a double with %g
+			static const size_t NUMBER_SIZE = 32;
+
+			Writer& write(const char *iText, size_t iSize)
+			{
+				if(_width == 0 && iSize <= _capacity - _size)
+				{
+					memcpy(_buffer.get() + _size, iText, iSize);
+					_size += iSize;
+					return *this;
+				}
+				return writeLong(iText, iSize);
+			};
+			// Write of a padded value or of a value that doesn't fit in the buffer
+			Writer& writeLong(const char *iText, size_t iSize);
+			Writer& writeSigned(long long iValue);
+			Writer& writeUnsigned(unsigned long long iValue);
+			Writer& writeDouble(double iValue, int iPrecision);
+
+			std::ostream &_stream;
+			std::unique_ptr<char[]> _buffer;
+			size_t _capacity;
+			size_t _size;
+			int _precision;
+			int _width;
+	};
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "Emulator.h"
+#include "../Utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace source
+{
+	namespace
+	{
+		// Bytes shown when a write differs from the log
+		const size_t MAX_DUMPED_BYTES = 16;
+
+		std::string dump(const unsigned char *iData, size_t iLength)
+		{
+			std::ostringstream oss;
+			oss << std::hex << std::setfill('0');
+			for(size_t i = 0; i < iLength && i < MAX_DUMPED_BYTES; ++i)
+			{
+				oss << std::setw(2) << (int)iData[i] << " ";
+			}
+			if(iLength > MAX_DUMPED_BYTES) oss << "...";
+			return oss.str();
+		}
+	}
+
+	Emulator::Emulator(std::string filename, const EmulatorTiming &iTiming, bool iStrict) : _filename(std::move(filename)), _timing(iTiming), _strict(iStrict), _index(0), _random(iTiming.seed), _report()
+	{
+	}
+
+	void Emulator::init(uint32_t vendorId, uint32_t productId)
+	{
+		_transactions = readTransactionLog(_filename);
+		_index = 0;
+		_report = EmulatorReport();
+		if(_timing.mode == EMULATOR_TIMING_RECORDED && !isBinaryTransactionLog(_filename))
+		{
+			std::cerr << "Warning: " << _filename << " has no times, responses of the emulator won't be delayed" << std::endl;
+		}
+		_start = _lastTransfer = std::chrono::steady_clock::now();
+	}
+
+	void Emulator::release()
+	{
+		std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start);
+		std::cout << "Emulator: " << _report.reads << " reads, " << _report.writes << " writes, "
+		          << _report.mismatches << " mismatches, " << _report.unread << " unread responses, "
+		          << _report.stalls << " stalls, " << _report.waited.count() / 1000 << " ms waiting for responses out of "
+		          << elapsed.count() / 1000 << " ms" << std::endl;
+	}
+
+	std::chrono::microseconds Emulator::responseDelay()
+	{
+		switch(_timing.mode)
+		{
+			case EMULATOR_TIMING_FIXED:
+			{
+				int64_t delay = _timing.latency;
+				if(_timing.jitter > 0)
+				{
+					std::uniform_int_distribution<int64_t> jitter(-(int64_t)_timing.jitter, _timing.jitter);
+					delay = std::max<int64_t>(0, delay + jitter(_random));
+				}
+				return std::chrono::microseconds(delay);
+			}
+			case EMULATOR_TIMING_RECORDED:
+				// Time between the response and the transfer before it
+				if(_index > 0 && _transactions[_index].time > _transactions[_index - 1].time)
+				{
+					return std::chrono::microseconds((_transactions[_index].time - _transactions[_index - 1].time) / 1000);
+				}
+				return std::chrono::microseconds(0);
+			default:
+				return std::chrono::microseconds(0);
+		}
+	}
+
+	bool Emulator::read_data(unsigned char iEndPoint, unsigned char **oData, size_t *oLength)
+	{
+		if(_index >= _transactions.size() || _transactions[_index].direction != TRANSACTION_READ)
+		{
+			++_report.stalls;
+			THROW_STREAM("Emulator stalled on read " << _report.reads + 1 << ": " << (_index >= _transactions.size() ? "the log is over" : "the watch waits for a write"));
+		}
+		// The watch prepares its response while the host does something else
+		std::chrono::steady_clock::time_point due = _lastTransfer + responseDelay();
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if(due > now)
+		{
+			std::this_thread::sleep_until(due);
+			_report.waited += std::chrono::duration_cast<std::chrono::microseconds>(due - now);
+		}
+		Transaction &response = _transactions[_index++];
+		*oData = reinterpret_cast<unsigned char*>(&response.data[0]);
+		*oLength = response.data.size();
+		++_report.reads;
+		_lastTransfer = std::chrono::steady_clock::now();
+		return true;
+	}
+
+	void Emulator::write_data(unsigned char iEndPoint, unsigned char *iData, size_t iLength)
+	{
+		++_report.writes;
+		_lastTransfer = std::chrono::steady_clock::now();
+		// Responses the host didn't read are lost, as they would be with the watch
+		while(_index < _transactions.size() && _transactions[_index].direction == TRANSACTION_READ)
+		{
+			++_report.unread;
+			++_index;
+		}
+		if(_index >= _transactions.size())
+		{
+			reportMismatch(Formatter() << "write " << _report.writes << " is not in the log: " << dump(iData, iLength));
+			return;
+		}
+		const std::string &expected = _transactions[_index++].data;
+		if(expected.size() != iLength || memcmp(expected.data(), iData, iLength) != 0)
+		{
+			reportMismatch(Formatter() << "write " << _report.writes << " differs from the log: " << dump(iData, iLength)
+			               << "instead of " << dump(reinterpret_cast<const unsigned char*>(expected.data()), expected.size()));
+		}
+	}
+
+	void Emulator::reportMismatch(const std::string &iMessage)
+	{
+		++_report.mismatches;
+		if(_strict)
+		{
+			THROW_STREAM("Emulator: " << iMessage);
+		}
+		std::cerr << "Emulator: " << iMessage << std::endl;
+	}
+}
@@ -0,0 +1,118 @@
+#ifndef _SOURCE_EMULATOR_HPP_
+#define _SOURCE_EMULATOR_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Source.h"
+#include "TransactionLog.h"
+
+namespace source
+{
+	enum EmulatorTimingMode
+	{
+		// Responses are available at once
+		EMULATOR_TIMING_NONE,
+		// Each response takes latency +/- jitter
+		EMULATOR_TIMING_FIXED,
+		// Each response takes the time it took in the log (binary logs only, text ones have no times)
+		EMULATOR_TIMING_RECORDED
+	};
+
+	struct EmulatorTiming
+	{
+		EmulatorTimingMode mode;
+		// Microseconds
+		uint32_t latency;
+		uint32_t jitter;
+		// Jitter is pseudo random: the same seed gives the same delays
+		uint32_t seed;
+	};
+
+	// What happened during an emulation, printed on release
+	struct EmulatorReport
+	{
+		size_t reads;
+		size_t writes;
+		// Writes that differ from the log, or that it doesn't have
+		size_t mismatches;
+		// Responses of the log skipped because the host wrote before reading them
+		size_t unread;
+		// Reads the watch would never answer: it waits for a write, or the log is over
+		size_t stalls;
+		// Time spent waiting for responses
+		std::chrono::microseconds waited;
+	};
+
+	/**
+	  A watch emulated from a transaction log (see TransactionLog.h), to test and benchmark devices
+	  without the watch. Unlike HexdumpFile, the log is followed in order: each write of the host is
+	  checked against the next one of the log, and each read returns the response that follows it,
+	  after the configured delay. A read the watch wouldn't answer fails like a USB timeout.
+	 */
+	class Emulator : public Source
+	{
+		public:
+			/**
+			  @param iStrict Throw on the first write that differs from the log instead of reporting it
+			 */
+			Emulator(std::string filename, const EmulatorTiming &iTiming, bool iStrict);
+			/**
+			  Read the whole log.
+			  @throw std::runtime_error if the log can't be read
+			 */
+			void init(uint32_t vendorId, uint32_t productId) override;
+
+			/**
+			  Print the report.
+			 */
+			void release() override;
+
+			/**
+			  Retrieve the next response of the log, once it's due. Data stays valid until the source is destroyed.
+			  @param iEndPoint Ignored
+			  @param oData Address of a pointer that will be set to point to read data after the call
+			  @param oLength Address of a variable that will contain the size of the data after the call
+			  @throw std::runtime_error on a stall
+			 */
+			bool read_data(unsigned char iEndPoint, unsigned char **oData, size_t *oLength) override;
+
+			/**
+			  Check data against the next write of the log.
+			  @param iEndPoint Ignored
+			  @param iData A pointer to data to be sent
+			  @param iLength Size of the data to be sent
+			  @throw std::runtime_error on a mismatch in strict mode
+			 */
+			void write_data(unsigned char iEndPoint, unsigned char *iData, size_t iLength) override;
+			/**
+			  Ignored: transaction logs don't have control transfers.
+			 */
+			void control_transfer(unsigned char iRequestType, unsigned char iRequest, unsigned short iValue, unsigned short iIndex, unsigned char *iData, unsigned short iLength) override {};
+
+			std::string getName() override { return "Emulator"; };
+
+			const EmulatorReport& getReport() const { return _report; };
+
+		private:
+			// Delay of the response at _index
+			std::chrono::microseconds responseDelay();
+			void reportMismatch(const std::string &iMessage);
+
+			std::string _filename;
+			EmulatorTiming _timing;
+			bool _strict;
+			std::vector<Transaction> _transactions;
+			// Next transaction of the log
+			size_t _index;
+			std::mt19937 _random;
+			// End of the last transfer: responses are due a delay after it
+			std::chrono::steady_clock::time_point _lastTransfer;
+			std::chrono::steady_clock::time_point _start;
+			EmulatorReport _report;
+	};
+}
+
+#endif
@@ -2,33 +2,38 @@
 #define _SOURCE_FILE_HPP_
 
 #include <string>
-#include <vector>
 #include "Source.h"
+#include "MappedFile.h"
+
+#define FILE_CHUNK_SIZE (1 << 20)
 
 namespace source
 {
 	/**
-	  A class to handle input from a file instead of from USB device
+	  A class to handle input from a file instead of from USB device.
+	  The file is mapped in memory, not copied: its content is read as the reader goes through it.
 	 */
 	class File : public Source
 	{
 		public:
-			File(std::string filename) : _filename(std::move(filename)), _index(0) {};
+			File(std::string filename) : _filename(std::move(filename)), _position(0) {};
 			/**
-			  Read the whole file.
+			  Map the whole file.
 			 */
 			void init(uint32_t vendorId, uint32_t productId) override;
 
 			/**
-			  Do nothing for file.
+			  Unmap the file.
 			 */
-			void release() override {};
+			void release() override { _file.close(); };
 
 			/**
-			  Each call retrieve next line from the file.
+			  Each call retrieve next chunk of the file, at most FILE_CHUNK_SIZE bytes.
+			  Data stays valid until the source is released.
 			  @param iEndPoint Unused
 			  @param oData Address of a pointer that will be set to point to read data after the call
 			  @param oLength Address of a variable that will contain the size of the data after the call
+			  @return true if there is more data to read after this chunk
 			 */
 			bool read_data(unsigned char iEndPoint, unsigned char **oData, size_t *oLength) override;
 
@@ -53,10 +58,17 @@ namespace source
 
 			std::string getName() override { return "File"; };
 
+			/**
+			  Whole content of the file, mapped by init: lets devices parse it in one go instead of
+			  chunk by chunk. Stays valid until the source is released.
+			 */
+			const unsigned char *data() const { return _file.data(); };
+			size_t size() const               { return _file.size(); };
+
 		protected:
 			std::string _filename;
-			std::vector<std::string> _inputStream;
-			size_t _index;
+			MappedFile _file;
+			size_t _position;
 	};
 }
 
@@ -1,57 +1,97 @@
 #include "HexdumpFile.h"
-#include <string>
-#include <fstream>
-#include <sstream>
+#include "TransactionLog.h"
+#include <cstring>
 #include <iostream>
-#include <iterator>
 #include <unistd.h>
 
 namespace source
 {
 	void HexdumpFile::init(uint32_t vendorId, uint32_t productId)
 	{
-		if(access(_filename.c_str(), R_OK) == 0)
+		if(access(_filename.c_str(), R_OK) != 0)
 		{
-			std::string line;
-			std::ifstream inputfile(_filename.c_str());
-			if (inputfile.is_open())
-			{
-				while ( inputfile.good() )
-				{
-					std::string thisLine;
-					getline(inputfile, line);
-					if(line.substr(0, 4) == " <= " && line.size() > 4)
-					{
-						line = line.substr(4);
-						std::stringstream iss(line);
-						iss >> std::hex;
-						std::copy(std::istream_iterator<unsigned int>(iss), std::istream_iterator<unsigned int>(), std::back_inserter(thisLine));
-						_inputStream.push_back(thisLine);
-					}
-				}
-				inputfile.close();
-			}
-			else
+			std::cerr << "Unable to access " << _filename;
+			// TODO: Throw an exception
+			return;
+		}
+		if(!_file.open(_filename))
+		{
+			std::cerr << "Unable to open " << _filename;
+			// TODO: Throw an exception
+			return;
+		}
+		_binary = _file.size() >= TRANSACTION_LOG_MAGIC_SIZE && memcmp(_file.data(), TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_SIZE) == 0;
+		if(_binary)
+		{
+			_position = TRANSACTION_LOG_MAGIC_SIZE;
+		}
+		else
+		{
+			// Each byte takes at least 2 characters in the text. Pages are only used once written.
+			_decoded.reset(new unsigned char[_file.size() / 2 + 1]);
+		}
+		_hasNext = findNextPacket();
+	}
+
+	bool HexdumpFile::findNextPacket()
+	{
+		return _binary ? findNextBinaryPacket() : findNextTextPacket();
+	}
+
+	bool HexdumpFile::findNextBinaryPacket()
+	{
+		while(_position + TRANSACTION_HEADER_SIZE <= _file.size())
+		{
+			Transaction transaction;
+			uint32_t length = decodeTransactionHeader(_file.data() + _position, transaction);
+			size_t offset = _position + TRANSACTION_HEADER_SIZE;
+			if(length > _file.size() - offset) break;
+			_position = offset + length;
+			if(transaction.direction == TRANSACTION_READ)
 			{
-				std::cerr << "Unable to open " << _filename;
-				// TODO: Throw an exception
+				// Read directly in the mapping
+				_next = _file.data() + offset;
+				_nextLength = length;
+				return true;
 			}
 		}
-		else
+		if(_position != _file.size())
 		{
-			std::cerr << "Unable to access " << _filename;
-			// TODO: Throw an exception
+			std::cerr << "Truncated transaction log " << _filename << ": last transaction ignored" << std::endl;
+			_position = _file.size();
+		}
+		return false;
+	}
+
+	bool HexdumpFile::findNextTextPacket()
+	{
+		const char *text = reinterpret_cast<const char*>(_file.data());
+		while(_position < _file.size())
+		{
+			const char *line = text + _position;
+			const char *lineEnd = static_cast<const char*>(memchr(line, '\n', _file.size() - _position));
+			if(lineEnd == nullptr) lineEnd = text + _file.size();
+			_position = lineEnd - text + 1;
+			if(lineEnd - line > 4 && memcmp(line, " <= ", 4) == 0)
+			{
+				// Decoded after the previous packets: they stay valid
+				_next = _decoded.get() + _decodedSize;
+				_nextLength = decodeHexBytes(line + 4, lineEnd, _next);
+				_decodedSize += _nextLength;
+				return true;
+			}
 		}
+		return false;
 	}
 
 	bool HexdumpFile::read_data(unsigned char iEndPoint, unsigned char **oData, size_t *oLength)
 	{
-		if(_index < _inputStream.size())
+		if(_hasNext)
 		{
-			*oLength = _inputStream[_index].length();
-			*oData = (unsigned char*) _inputStream[_index].c_str();
-			_index++;
+			*oLength = _nextLength;
+			*oData = _next;
+			_hasNext = findNextPacket();
 		}
-		return _index < _inputStream.size();
+		return _hasNext;
 	}
 }
@@ -1,21 +1,24 @@
 #ifndef _SOURCE_HEXDUMPFILE_HPP_
 #define _SOURCE_HEXDUMPFILE_HPP_
 
+#include <memory>
 #include <string>
-#include <vector>
+#include "MappedFile.h"
 #include "Source.h"
 
 namespace source
 {
 	/**
-	  A class to handle input from a file instead of from USB device
+	  A class to handle input from a file instead of from USB device.
+	  The log is mapped in memory and read as packets are asked for: packets of a binary log are
+	  read directly in the mapping, those of a text log are decoded one after the other in a buffer.
 	 */
 	class HexdumpFile : public Source
 	{
 		public:
-			HexdumpFile(std::string filename) : _filename(std::move(filename)), _index(0) {};
+			HexdumpFile(std::string filename) : _filename(std::move(filename)), _binary(false), _position(0), _decodedSize(0), _hasNext(false), _next(nullptr), _nextLength(0) {};
 			/**
-			  Read the whole file.
+			  Read the whole file: a transaction log in text or binary format (see TransactionLog.h).
 			 */
 			void init(uint32_t vendorId, uint32_t productId) override;
 
@@ -25,7 +28,7 @@ namespace source
 			void release() override {};
 
 			/**
-			  Each call retrieve next line from the file.
+			  Each call retrieve the next data read from the device in the log. Data stays valid until the source is destroyed.
 			  @param Ignored
 			  @param oData Address of a pointer that will be set to point to read data after the call
 			  @param oLength Address of a variable that will contain the size of the data after the call
@@ -54,9 +57,23 @@ namespace source
 			std::string getName() override { return "HexdumpFile"; };
 
 		protected:
+			// Find the packet after the current one, tell if there is one
+			bool findNextPacket();
+			bool findNextBinaryPacket();
+			bool findNextTextPacket();
+
 			std::string _filename;
-			std::vector<std::string> _inputStream;
-			size_t _index;
+			MappedFile _file;
+			bool _binary;
+			// Where to look for the next packet in the file
+			size_t _position;
+			// Text log: packets decoded so far
+			std::unique_ptr<unsigned char[]> _decoded;
+			size_t _decodedSize;
+			// Packet returned by the next read: read_data tells if there is one after the packet it returns
+			bool _hasNext;
+			unsigned char *_next;
+			size_t _nextLength;
 	};
 }
 
@@ -1,19 +1,22 @@
 #ifndef _SOURCE_LOGGER_HPP_
 #define _SOURCE_LOGGER_HPP_
 
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include "Source.h"
+#include "TransactionLogWriter.h"
 
 namespace source
 {
 	/**
-	  A class to handle transparent logging of another source
+	  A class to handle transparent logging of another source.
+	  Transactions are written by a TransactionLogWriter: the log file is created by the first one.
 	 */
 	class Logger : public Source
 	{
 		public:
-			Logger(Source *source, std::string logfilename) : _logfilename(std::move(logfilename)), _truesource(source)
+			Logger(Source *source, std::string logfilename, LogFormat format = LOG_BINARY) : _logfilename(std::move(logfilename)), _format(format), _truesource(source)
 			{
 				if(_truesource == nullptr) throw std::invalid_argument("Source passed to Logger is NULL");
 			};
@@ -57,8 +60,12 @@ namespace source
 			std::string getName() override { return "Logger"; };
 
 		protected:
+			TransactionLogWriter& getWriter();
+
 			std::string _logfilename;
+			LogFormat _format;
 			Source *_truesource;
+			std::unique_ptr<TransactionLogWriter> _writer;
 	};
 }
 
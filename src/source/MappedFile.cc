@@ -0,0 +1,70 @@
+#include "MappedFile.h"
+
+#ifdef WINDOWS
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace source
+{
+	#ifdef WINDOWS
+	bool MappedFile::open(const std::string &iFilename)
+	{
+		close();
+		std::ifstream file(iFilename.c_str(), std::ios_base::in | std::ios_base::binary);
+		if(!file.is_open()) return false;
+		_content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		_data = reinterpret_cast<unsigned char*>(&_content[0]);
+		_size = _content.size();
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		_content.clear();
+		_data = nullptr;
+		_size = 0;
+	}
+	#else
+	bool MappedFile::open(const std::string &iFilename)
+	{
+		close();
+		int fd = ::open(iFilename.c_str(), O_RDONLY);
+		if(fd < 0) return false;
+		struct stat status;
+		if(fstat(fd, &status) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+		// Nothing to map in an empty file: data() stays null
+		if(status.st_size > 0)
+		{
+			void *mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if(mapping == MAP_FAILED)
+			{
+				::close(fd);
+				return false;
+			}
+			madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+			_data = static_cast<unsigned char*>(mapping);
+			_size = status.st_size;
+		}
+		// The mapping stays valid once the file is closed
+		::close(fd);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if(_data != nullptr) munmap(_data, _size);
+		_data = nullptr;
+		_size = 0;
+	}
+	#endif
+}
@@ -0,0 +1,41 @@
+#ifndef _SOURCE_MAPPEDFILE_HPP_
+#define _SOURCE_MAPPEDFILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace source
+{
+	/**
+	  The content of a file, mapped in memory. Pages are private: writing to them
+	  doesn't modify the file. On Windows, the file is read in memory instead.
+	 */
+	class MappedFile
+	{
+		public:
+			MappedFile() : _data(nullptr), _size(0) {};
+			~MappedFile() { close(); };
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			/**
+			  Map a whole file, unmapping the previous one
+			  @return false if the file can't be opened or mapped
+			 */
+			bool open(const std::string &iFilename);
+			void close();
+
+			unsigned char *data() const { return _data; };
+			size_t size() const         { return _size; };
+
+		private:
+			unsigned char *_data;
+			size_t _size;
+			#ifdef WINDOWS
+			std::string _content;
+			#endif
+	};
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "TransactionLog.h"
+#include "../Utils.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace source
+{
+	const char TRANSACTION_LOG_MAGIC[TRANSACTION_LOG_MAGIC_SIZE] = { 'K', 'R', 'L', 'O', 'G', 0, 0, 1 };
+
+	namespace
+	{
+		const char hexDigits[] = "0123456789abcdef";
+
+		// Value of each character as an hexadecimal digit, -1 if it isn't one
+		struct HexTable
+		{
+			HexTable()
+			{
+				for(int c = 0; c < 256; ++c)
+				{
+					values[c] = -1;
+					if(c >= '0' && c <= '9') values[c] = c - '0';
+					if(c >= 'a' && c <= 'f') values[c] = c - 'a' + 10;
+					if(c >= 'A' && c <= 'F') values[c] = c - 'A' + 10;
+				}
+			}
+			signed char values[256];
+		};
+		const HexTable hexTable;
+
+		void readBinaryLog(const std::string &content, std::vector<Transaction> &oTransactions)
+		{
+			size_t offset = TRANSACTION_LOG_MAGIC_SIZE;
+			while(offset < content.size())
+			{
+				if(offset + TRANSACTION_HEADER_SIZE > content.size())
+				{
+					THROW_STREAM("Truncated transaction header at offset " << offset);
+				}
+				Transaction transaction;
+				uint32_t length = decodeTransactionHeader(reinterpret_cast<const unsigned char*>(content.data()) + offset, transaction);
+				offset += TRANSACTION_HEADER_SIZE;
+				if(length > content.size() - offset)
+				{
+					THROW_STREAM("Truncated transaction data at offset " << offset);
+				}
+				transaction.data.assign(content, offset, length);
+				offset += length;
+				oTransactions.push_back(std::move(transaction));
+			}
+		}
+
+		void readTextLog(const std::string &content, std::vector<Transaction> &oTransactions)
+		{
+			size_t lineStart = 0;
+			while(lineStart < content.size())
+			{
+				size_t lineEnd = content.find('\n', lineStart);
+				if(lineEnd == std::string::npos) lineEnd = content.size();
+				bool read = content.compare(lineStart, 4, " <= ") == 0;
+				bool written = content.compare(lineStart, 4, " => ") == 0;
+				if(read || written)
+				{
+					Transaction transaction { 0, read ? TRANSACTION_READ : TRANSACTION_WRITE, 0, std::string() };
+					const char *begin = content.data() + lineStart + 4;
+					const char *end = content.data() + lineEnd;
+					transaction.data.resize((end - begin + 1) / 2);
+					transaction.data.resize(decodeHexBytes(begin, end, reinterpret_cast<unsigned char*>(&transaction.data[0])));
+					oTransactions.push_back(std::move(transaction));
+				}
+				lineStart = lineEnd + 1;
+			}
+		}
+	}
+
+	void encodeTransactionHeader(unsigned char *oHeader, uint64_t iTime, TransactionDirection iDirection, unsigned char iEndPoint, uint32_t iLength)
+	{
+		for(int i = 0; i < 8; ++i)
+		{
+			oHeader[i] = (iTime >> (8 * i)) & 0xFF;
+		}
+		oHeader[8] = iDirection;
+		oHeader[9] = iEndPoint;
+		for(int i = 0; i < 4; ++i)
+		{
+			oHeader[10 + i] = (iLength >> (8 * i)) & 0xFF;
+		}
+	}
+
+	uint32_t decodeTransactionHeader(const unsigned char *iHeader, Transaction &oTransaction)
+	{
+		oTransaction.time = 0;
+		for(int i = 7; i >= 0; --i)
+		{
+			oTransaction.time = (oTransaction.time << 8) + iHeader[i];
+		}
+		oTransaction.direction = iHeader[8] == TRANSACTION_WRITE ? TRANSACTION_WRITE : TRANSACTION_READ;
+		oTransaction.endPoint = iHeader[9];
+		return iHeader[10] + (iHeader[11] << 8) + (iHeader[12] << 16) + ((uint32_t)iHeader[13] << 24);
+	}
+
+	void appendTextTransaction(std::string &oText, TransactionDirection iDirection, const unsigned char *iData, size_t iLength)
+	{
+		oText += iDirection == TRANSACTION_READ ? " <= " : " => ";
+		for(size_t i = 0; i < iLength; ++i)
+		{
+			oText += hexDigits[iData[i] >> 4];
+			oText += hexDigits[iData[i] & 0x0F];
+			oText += ' ';
+		}
+		oText += '\n';
+	}
+
+	size_t decodeHexBytes(const char *iBegin, const char *iEnd, unsigned char *oBytes)
+	{
+		const signed char *values = hexTable.values;
+		unsigned char *bytes = oBytes;
+		const char *c = iBegin;
+		while(c < iEnd)
+		{
+			// Usual case: two digits and a separator
+			if(iEnd - c >= 3)
+			{
+				int high = values[(unsigned char)c[0]];
+				int low = values[(unsigned char)c[1]];
+				if((high | low) >= 0 && values[(unsigned char)c[2]] < 0)
+				{
+					*bytes++ = (high << 4) | low;
+					c += 3;
+					continue;
+				}
+			}
+			// Any other number of digits: the lowest byte of the number is kept
+			if(values[(unsigned char)*c] < 0)
+			{
+				++c;
+				continue;
+			}
+			unsigned int value = 0;
+			for(; c < iEnd && values[(unsigned char)*c] >= 0; ++c)
+			{
+				value = (value << 4) | values[(unsigned char)*c];
+			}
+			*bytes++ = value & 0xFF;
+		}
+		return bytes - oBytes;
+	}
+
+	bool isBinaryTransactionLog(const std::string &iFilename)
+	{
+		char magic[TRANSACTION_LOG_MAGIC_SIZE];
+		std::ifstream file(iFilename.c_str(), std::ios_base::in | std::ios_base::binary);
+		return file.read(magic, TRANSACTION_LOG_MAGIC_SIZE) && memcmp(magic, TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_SIZE) == 0;
+	}
+
+	std::vector<Transaction> readTransactionLog(const std::string &iFilename)
+	{
+		std::ifstream file(iFilename.c_str(), std::ios_base::in | std::ios_base::binary);
+		if(!file.is_open())
+		{
+			THROW_STREAM("Unable to open transaction log " << iFilename);
+		}
+		std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		std::vector<Transaction> transactions;
+		if(content.compare(0, TRANSACTION_LOG_MAGIC_SIZE, TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_SIZE) == 0)
+		{
+			readBinaryLog(content, transactions);
+		}
+		else
+		{
+			readTextLog(content, transactions);
+		}
+		return transactions;
+	}
+
+	void writeTransactionLog(const std::string &iFilename, const std::vector<Transaction> &iTransactions, LogFormat iFormat)
+	{
+		std::ofstream file(iFilename.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+		if(!file.is_open())
+		{
+			THROW_STREAM("Unable to create transaction log " << iFilename);
+		}
+		std::string content;
+		if(iFormat == LOG_BINARY)
+		{
+			content.append(TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_SIZE);
+		}
+		for(const Transaction& transaction : iTransactions)
+		{
+			const unsigned char *data = reinterpret_cast<const unsigned char*>(transaction.data.data());
+			if(iFormat == LOG_BINARY)
+			{
+				unsigned char header[TRANSACTION_HEADER_SIZE];
+				encodeTransactionHeader(header, transaction.time, transaction.direction, transaction.endPoint, transaction.data.size());
+				content.append(reinterpret_cast<char*>(header), TRANSACTION_HEADER_SIZE);
+				content += transaction.data;
+			}
+			else
+			{
+				appendTextTransaction(content, transaction.direction, data, transaction.data.size());
+			}
+		}
+		if(!file.write(content.data(), content.size()))
+		{
+			THROW_STREAM("Unable to write transaction log " << iFilename);
+		}
+	}
+
+	std::string convertTransactionLog(const std::string &iFilename)
+	{
+		bool binary = isBinaryTransactionLog(iFilename);
+		std::string converted = iFilename;
+		size_t extension = converted.find_last_of("./");
+		if(extension != std::string::npos && converted[extension] == '.')
+		{
+			converted.erase(extension);
+		}
+		converted += binary ? ".log" : ".klog";
+		writeTransactionLog(converted, readTransactionLog(iFilename), binary ? LOG_TEXT : LOG_BINARY);
+		return converted;
+	}
+}
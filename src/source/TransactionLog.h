@@ -0,0 +1,83 @@
+#ifndef _SOURCE_TRANSACTIONLOG_HPP_
+#define _SOURCE_TRANSACTIONLOG_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define TRANSACTION_LOG_MAGIC_SIZE 8
+#define TRANSACTION_HEADER_SIZE 14
+
+namespace source
+{
+	/**
+	  Transactions with a device, as logged by Logger, in one of two formats.
+
+	  Binary format, little endian: TRANSACTION_LOG_MAGIC, then for each transaction
+	   - time: 8 bytes, nanoseconds since the log was opened (monotonic clock)
+	   - direction: 1 byte, TRANSACTION_READ or TRANSACTION_WRITE
+	   - end point: 1 byte
+	   - length: 4 bytes
+	   - data: length bytes
+
+	  Text format, the historical one: a line per transaction, " <= " for data read from the
+	  device or " => " for data written to it, then each byte in hexadecimal followed by a space.
+	  It has neither times nor end points: they are read as 0.
+	 */
+	enum LogFormat
+	{
+		LOG_BINARY,
+		LOG_TEXT
+	};
+
+	enum TransactionDirection
+	{
+		TRANSACTION_READ = 0,
+		TRANSACTION_WRITE = 1
+	};
+
+	struct Transaction
+	{
+		uint64_t time;
+		TransactionDirection direction;
+		unsigned char endPoint;
+		std::string data;
+	};
+
+	extern const char TRANSACTION_LOG_MAGIC[TRANSACTION_LOG_MAGIC_SIZE];
+
+	void encodeTransactionHeader(unsigned char *oHeader, uint64_t iTime, TransactionDirection iDirection, unsigned char iEndPoint, uint32_t iLength);
+	// Fill time, direction and end point of a transaction from its header, return the length of its data
+	uint32_t decodeTransactionHeader(const unsigned char *iHeader, Transaction &oTransaction);
+	// Append a transaction in text format
+	void appendTextTransaction(std::string &oText, TransactionDirection iDirection, const unsigned char *iData, size_t iLength);
+	/**
+	  Decode the bytes of a transaction in text format: hexadecimal numbers separated by any other character
+	  @param oBytes Where decoded bytes are written, room for (iEnd - iBegin + 1) / 2 bytes is enough
+	  @return The number of decoded bytes
+	 */
+	size_t decodeHexBytes(const char *iBegin, const char *iEnd, unsigned char *oBytes);
+
+	bool isBinaryTransactionLog(const std::string &iFilename);
+
+	/**
+	  Read a log in any format
+	  @throw std::runtime_error if the file can't be read or a binary log is truncated
+	 */
+	std::vector<Transaction> readTransactionLog(const std::string &iFilename);
+
+	/**
+	  @throw std::runtime_error if the file can't be written
+	 */
+	void writeTransactionLog(const std::string &iFilename, const std::vector<Transaction> &iTransactions, LogFormat iFormat);
+
+	/**
+	  Convert a binary log to text, or a text log to binary. The converted log is written next to the
+	  original one, with the extension of its format (.klog for binary, .log for text).
+	  @return The name of the converted log
+	 */
+	std::string convertTransactionLog(const std::string &iFilename);
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "TransactionLogWriter.h"
+#include "../Utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Maximum time the thread sleeps when it missed a wake up
+#define TRANSACTION_LOG_WAKE_UP 10
+
+namespace source
+{
+	TransactionLogWriter::TransactionLogWriter(const std::string &iFilename, LogFormat iFormat, size_t iRingSize) :
+		_file(iFilename.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary), _format(iFormat),
+		_start(std::chrono::steady_clock::now()), _mask(0), _head(0), _tail(0), _stopping(false)
+	{
+		if(!_file.is_open())
+		{
+			THROW_STREAM("Unable to create transaction log " << iFilename);
+		}
+		size_t ringSize = 1;
+		while(ringSize < iRingSize) ringSize <<= 1;
+		_ring.resize(ringSize);
+		_mask = ringSize - 1;
+		if(_format == LOG_BINARY)
+		{
+			_file.write(TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_SIZE);
+			_file.flush();
+		}
+		_thread = std::thread(&TransactionLogWriter::writeTransactions, this);
+	}
+
+	TransactionLogWriter::~TransactionLogWriter()
+	{
+		_stopping.store(true);
+		_wake.notify_one();
+		_thread.join();
+	}
+
+	void TransactionLogWriter::log(TransactionDirection iDirection, unsigned char iEndPoint, const unsigned char *iData, size_t iLength)
+	{
+		uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+		unsigned char header[TRANSACTION_HEADER_SIZE];
+		encodeTransactionHeader(header, time, iDirection, iEndPoint, iLength);
+		push(header, TRANSACTION_HEADER_SIZE);
+		if(iLength > 0) push(iData, iLength);
+		_wake.notify_one();
+	}
+
+	void TransactionLogWriter::flush()
+	{
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		while(_tail.load(std::memory_order_acquire) < head)
+		{
+			_wake.notify_one();
+			std::this_thread::yield();
+		}
+	}
+
+	void TransactionLogWriter::push(const unsigned char *iData, size_t iLength)
+	{
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		while(iLength > 0)
+		{
+			size_t space = _ring.size() - (head - _tail.load(std::memory_order_acquire));
+			if(space == 0)
+			{
+				// Ring buffer full: transactions are never dropped, wait for the thread to write some
+				_wake.notify_one();
+				std::this_thread::yield();
+				continue;
+			}
+			size_t chunk = std::min(space, iLength);
+			size_t offset = head & _mask;
+			size_t first = std::min(chunk, _ring.size() - offset);
+			memcpy(&_ring[offset], iData, first);
+			memcpy(&_ring[0], iData + first, chunk - first);
+			head += chunk;
+			iData += chunk;
+			iLength -= chunk;
+			_head.store(head, std::memory_order_release);
+		}
+	}
+
+	void TransactionLogWriter::writeTransactions()
+	{
+		uint64_t tail = _tail.load(std::memory_order_relaxed);
+		while(true)
+		{
+			// Read before the head: once stopping, nothing more is pushed
+			bool stopping = _stopping.load(std::memory_order_acquire);
+			uint64_t head = _head.load(std::memory_order_acquire);
+			if(head == tail)
+			{
+				if(stopping) break;
+				std::unique_lock<std::mutex> lock(_wakeMutex);
+				_wake.wait_for(lock, std::chrono::milliseconds(TRANSACTION_LOG_WAKE_UP));
+				continue;
+			}
+			size_t offset = tail & _mask;
+			size_t available = head - tail;
+			size_t first = std::min<size_t>(available, _ring.size() - offset);
+			write(&_ring[offset], first);
+			if(available > first) write(&_ring[0], available - first);
+			_file.flush();
+			tail = head;
+			_tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	void TransactionLogWriter::write(const unsigned char *iData, size_t iLength)
+	{
+		if(_format == LOG_BINARY)
+		{
+			_file.write(reinterpret_cast<const char*>(iData), iLength);
+			return;
+		}
+
+		// Text format needs whole transactions: they may be split by the ring buffer
+		_pending.append(reinterpret_cast<const char*>(iData), iLength);
+		const unsigned char *pending = reinterpret_cast<const unsigned char*>(_pending.data());
+		size_t offset = 0;
+		_text.clear();
+		while(_pending.size() - offset >= TRANSACTION_HEADER_SIZE)
+		{
+			Transaction transaction;
+			uint32_t length = decodeTransactionHeader(pending + offset, transaction);
+			if(_pending.size() - offset - TRANSACTION_HEADER_SIZE < length) break;
+			appendTextTransaction(_text, transaction.direction, pending + offset + TRANSACTION_HEADER_SIZE, length);
+			offset += TRANSACTION_HEADER_SIZE + length;
+		}
+		_file.write(_text.data(), _text.size());
+		_pending.erase(0, offset);
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef _SOURCE_TRANSACTIONLOGWRITER_HPP_
+#define _SOURCE_TRANSACTIONLOGWRITER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TransactionLog.h"
+
+// Size of the ring buffer between the logging thread and the writing one
+#define TRANSACTION_LOG_RING_SIZE (1 << 20)
+
+namespace source
+{
+	/**
+	  Write transactions to a log file from a thread of its own. log() only copies the transaction
+	  into a lock-free ring buffer: formatting and file access don't slow down the transfers.
+	  log() must not be called by several threads at the same time.
+	 */
+	class TransactionLogWriter
+	{
+		public:
+			/**
+			  @param iFilename The log file, overwritten if it exists
+			  @param iFormat Format of the log
+			  @param iRingSize Size of the ring buffer, rounded up to a power of 2
+			  @throw std::runtime_error if the file can't be created
+			 */
+			TransactionLogWriter(const std::string &iFilename, LogFormat iFormat, size_t iRingSize = TRANSACTION_LOG_RING_SIZE);
+			// Write the transactions still in the ring buffer and close the file
+			~TransactionLogWriter();
+
+			TransactionLogWriter(const TransactionLogWriter&) = delete;
+			TransactionLogWriter& operator=(const TransactionLogWriter&) = delete;
+
+			/**
+			  Log a transaction, timestamped now. Only waits if the ring buffer is full.
+			 */
+			void log(TransactionDirection iDirection, unsigned char iEndPoint, const unsigned char *iData, size_t iLength);
+
+			/**
+			  Wait for the transactions logged so far to be written to the file
+			 */
+			void flush();
+
+		private:
+			void push(const unsigned char *iData, size_t iLength);
+			void writeTransactions();
+			void write(const unsigned char *iData, size_t iLength);
+
+			std::ofstream _file;
+			LogFormat _format;
+			std::chrono::steady_clock::time_point _start;
+			std::vector<unsigned char> _ring;
+			size_t _mask;
+			// Total number of bytes pushed by log() and written by the thread: they only grow
+			std::atomic<uint64_t> _head;
+			std::atomic<uint64_t> _tail;
+			std::atomic<bool> _stopping;
+			// Only used to sleep while the ring buffer is empty
+			std::mutex _wakeMutex;
+			std::condition_variable _wake;
+			// Text format: bytes of a transaction not completely received by the thread yet
+			std::string _pending;
+			std::string _text;
+			std::thread _thread;
+	};
+}
+
+#endif
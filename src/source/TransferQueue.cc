@@ -0,0 +1,123 @@
+#include "TransferQueue.h"
+
+#include <libusb.h>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "../Utils.h"
+
+// Number of times the destructor waits for cancelled transfers before giving up
+#define CANCEL_ATTEMPTS 10
+#define CANCEL_WAIT 100
+
+namespace source
+{
+	TransferQueue::TransferQueue(InTransport &iTransport, unsigned char iEndPoint, size_t iNbTransfers, size_t iSize) :
+		_transport(iTransport), _endPoint(iEndPoint), _next(0), _inUse(iNbTransfers), _error(0)
+	{
+		if(iNbTransfers < 2)
+		{
+			throw std::invalid_argument("TransferQueue needs at least 2 transfers");
+		}
+		std::vector<unsigned char*> buffers = _transport.allocate(iEndPoint, iNbTransfers, iSize, [this](size_t transfer, int status, size_t length)
+		{
+			onCompleted(transfer, status, length);
+		});
+		for(unsigned char *buffer : buffers)
+		{
+			_transfers.push_back(Transfer { buffer, IDLE, 0, 0 });
+		}
+		for(size_t i = 0; i < _transfers.size() && _error == 0; ++i)
+		{
+			submit(i);
+		}
+		if(_error != 0)
+		{
+			int rc = _error;
+			shutdown();
+			throw std::runtime_error(Formatter() << "can't submit USB transfer: " << rc << " " << libusb_error_name(rc));
+		}
+	}
+
+	TransferQueue::~TransferQueue()
+	{
+		shutdown();
+	}
+
+	void TransferQueue::shutdown()
+	{
+		for(size_t i = 0; i < _transfers.size(); ++i)
+		{
+			if(_transfers[i].state == PENDING) _transport.cancel(i);
+		}
+		for(int attempt = 0; attempt < CANCEL_ATTEMPTS && hasPendingTransfers(); ++attempt)
+		{
+			_transport.handleEvents(CANCEL_WAIT);
+		}
+		if(hasPendingTransfers())
+		{
+			// Freeing a pending transfer would let libusb write into freed memory: better leak it
+			std::cerr << "USB transfers could not be cancelled on endpoint " << (int)_endPoint << std::endl;
+			return;
+		}
+		_transport.free();
+	}
+
+	bool TransferQueue::hasPendingTransfers() const
+	{
+		for(const Transfer& transfer : _transfers)
+		{
+			if(transfer.state == PENDING) return true;
+		}
+		return false;
+	}
+
+	void TransferQueue::submit(size_t iTransfer)
+	{
+		int rc = _transport.submit(iTransfer);
+		if(rc < 0)
+		{
+			// The transfers would not complete in the order of the ring anymore
+			_error = rc;
+			return;
+		}
+		_transfers[iTransfer].state = PENDING;
+	}
+
+	void TransferQueue::onCompleted(size_t iTransfer, int iStatus, size_t iLength)
+	{
+		Transfer& transfer = _transfers[iTransfer];
+		transfer.state = COMPLETED;
+		transfer.status = iStatus;
+		transfer.length = iLength;
+	}
+
+	int TransferQueue::read(unsigned char **oData, size_t *oLength, uint32_t iTimeout)
+	{
+		if(_inUse < _transfers.size())
+		{
+			submit(_inUse);
+			_inUse = _transfers.size();
+		}
+		if(_error != 0) return _error;
+
+		Transfer& transfer = _transfers[_next];
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iTimeout);
+		while(transfer.state == PENDING)
+		{
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+			// The transfer stays pending: the next read waits for it again
+			if(remaining <= 0) return LIBUSB_ERROR_TIMEOUT;
+			int rc = _transport.handleEvents(remaining);
+			if(rc < 0 && rc != LIBUSB_ERROR_INTERRUPTED) return rc;
+		}
+
+		// Submitted again by the next read, even if it failed, to keep the order of the ring
+		transfer.state = IDLE;
+		_inUse = _next;
+		_next = (_next + 1) % _transfers.size();
+		*oData = transfer.buffer;
+		*oLength = transfer.length;
+		return transfer.status;
+	}
+}
@@ -0,0 +1,132 @@
+#ifndef _SOURCE_TRANSFERQUEUE_HPP_
+#define _SOURCE_TRANSFERQUEUE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace source
+{
+	/**
+	  Asynchronous IN transfers on an endpoint: what TransferQueue needs from libusb.
+	  Implemented with libusb asynchronous API by USB, and by fake transports in tests.
+	 */
+	class InTransport
+	{
+		public:
+			/**
+			  Called when a transfer is over
+			  @param transfer Index of the transfer
+			  @param status 0 if data was received, a libusb error code otherwise
+			  @param length Number of bytes received
+			 */
+			typedef std::function<void(size_t transfer, int status, size_t length)> CompletionHandler;
+
+			virtual ~InTransport() = default;
+
+			/**
+			  Create the transfers. Buffers are allocated by the transport and stay valid until free() is called.
+			  @param iEndPoint End point from which all the transfers read
+			  @param iNbTransfers Number of transfers to create
+			  @param iSize Size of the buffer of each transfer
+			  @param iHandler Called from handleEvents() for each completed transfer
+			  @return The buffers of the transfers
+			 */
+			virtual std::vector<unsigned char*> allocate(unsigned char iEndPoint, size_t iNbTransfers, size_t iSize, CompletionHandler iHandler) = 0;
+
+			/**
+			  Free the transfers and their buffers. None of them may be pending.
+			 */
+			virtual void free() = 0;
+
+			/**
+			  Start reading into a transfer buffer
+			  @return 0 or a libusb error code
+			 */
+			virtual int submit(size_t iTransfer) = 0;
+
+			/**
+			  Ask for a pending transfer to stop: its completion is reported with LIBUSB_ERROR_INTERRUPTED
+			 */
+			virtual void cancel(size_t iTransfer) = 0;
+
+			/**
+			  Wait for transfers to complete and report them to the completion handler
+			  @param iTimeout Maximum time to wait, in milliseconds
+			  @return 0 or a libusb error code
+			 */
+			virtual int handleEvents(uint32_t iTimeout) = 0;
+	};
+
+	/**
+	  A ring of IN transfers kept submitted on an endpoint, so that packets sent by the
+	  device are received while the previous ones are processed, without an idle gap
+	  between them. Packets are given back in the order they were received.
+	  Transfers are submitted with no timeout: they can wait for a packet as long as
+	  needed, read() enforces the timeout of each read.
+	  Only for protocols where the device sends data when asked: packets received
+	  by queued transfers are lost when the queue is destroyed.
+	 */
+	class TransferQueue
+	{
+		public:
+			/**
+			  Create the transfers and submit them all
+			  @param iTransport Transport used for the transfers, must outlive the queue
+			  @param iEndPoint End point from which the data is read
+			  @param iNbTransfers Number of transfers, at least 2 so that one is submitted while the caller uses the other
+			  @param iSize Size of a transfer buffer
+			 */
+			TransferQueue(InTransport &iTransport, unsigned char iEndPoint, size_t iNbTransfers, size_t iSize);
+			// Cancel pending transfers and wait for them before freeing them
+			~TransferQueue();
+
+			TransferQueue(const TransferQueue&) = delete;
+			TransferQueue& operator=(const TransferQueue&) = delete;
+
+			/**
+			  Read the next packet. The buffer returned by the previous call is submitted again.
+			  @param oData Address of a pointer set to the received data, valid until the next call
+			  @param oLength Address of a variable set to the size of the data
+			  @param iTimeout Maximum time to wait for the packet, in milliseconds
+			  @return 0 or the libusb error code of the transfer (LIBUSB_ERROR_TIMEOUT if nothing was received in time)
+			 */
+			int read(unsigned char **oData, size_t *oLength, uint32_t iTimeout);
+
+			unsigned char getEndPoint() const { return _endPoint; };
+
+		private:
+			enum TransferState
+			{
+				IDLE,
+				PENDING,
+				COMPLETED
+			};
+
+			struct Transfer
+			{
+				unsigned char *buffer;
+				TransferState state;
+				int status;
+				size_t length;
+			};
+
+			void submit(size_t iTransfer);
+			void shutdown();
+			bool hasPendingTransfers() const;
+			void onCompleted(size_t iTransfer, int iStatus, size_t iLength);
+
+			InTransport &_transport;
+			unsigned char _endPoint;
+			std::vector<Transfer> _transfers;
+			// Next transfer to complete: transfers complete in the order they were submitted
+			size_t _next;
+			// Transfer whose buffer was returned by the last read, to be submitted again by the next one
+			size_t _inUse;
+			// First error while submitting a transfer: once the ring is out of order, all reads fail
+			int _error;
+	};
+}
+
+#endif
@@ -3,10 +3,126 @@
 
 #include <iostream>
 #include <cerrno>
+#include <new>
 #include <stdexcept>
 
 namespace source
 {
+	namespace
+	{
+		// IN transfers with libusb asynchronous API
+		class LibusbInTransport : public InTransport
+		{
+			public:
+				// Transfers are only freed by free(): they may still be pending when the transport is destroyed
+				LibusbInTransport(libusb_context *context, libusb_device_handle *device) : _USBContext(context), _device(device), _size(0) {};
+
+				std::vector<unsigned char*> allocate(unsigned char iEndPoint, size_t iNbTransfers, size_t iSize, CompletionHandler iHandler) override
+				{
+					free();
+					_handler = iHandler;
+					_size = iSize;
+					// Reserved so that the slots given as user data to libusb don't move
+					_slots.reserve(iNbTransfers);
+					std::vector<unsigned char*> buffers;
+					for(size_t i = 0; i < iNbTransfers; ++i)
+					{
+						Slot slot { this, i, libusb_alloc_transfer(0), nullptr, false };
+						if(slot.transfer == nullptr) throw std::bad_alloc();
+						#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+						// Memory the device can write to directly, when the platform supports it
+						slot.buffer = libusb_dev_mem_alloc(_device, iSize);
+						slot.deviceMemory = slot.buffer != nullptr;
+						#endif
+						if(slot.buffer == nullptr) slot.buffer = new unsigned char[iSize];
+						_slots.push_back(slot);
+						// No timeout: transfers are submitted before the data is requested from the device
+						libusb_fill_bulk_transfer(slot.transfer, _device, iEndPoint, slot.buffer, iSize, &LibusbInTransport::transferCallback, &_slots.back(), 0);
+						buffers.push_back(slot.buffer);
+					}
+					return buffers;
+				}
+
+				void free() override
+				{
+					for(Slot& slot : _slots)
+					{
+						libusb_free_transfer(slot.transfer);
+						#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+						if(slot.deviceMemory)
+						{
+							libusb_dev_mem_free(_device, slot.buffer, _size);
+							continue;
+						}
+						#endif
+						delete[] slot.buffer;
+					}
+					_slots.clear();
+				}
+
+				int submit(size_t iTransfer) override
+				{
+					return libusb_submit_transfer(_slots[iTransfer].transfer);
+				}
+
+				void cancel(size_t iTransfer) override
+				{
+					libusb_cancel_transfer(_slots[iTransfer].transfer);
+				}
+
+				int handleEvents(uint32_t iTimeout) override
+				{
+					struct timeval timeout;
+					timeout.tv_sec = iTimeout / 1000;
+					timeout.tv_usec = (iTimeout % 1000) * 1000;
+					return libusb_handle_events_timeout_completed(_USBContext, &timeout, nullptr);
+				}
+
+			private:
+				struct Slot
+				{
+					LibusbInTransport *owner;
+					size_t index;
+					libusb_transfer *transfer;
+					unsigned char *buffer;
+					bool deviceMemory;
+				};
+
+				static void LIBUSB_CALL transferCallback(libusb_transfer *transfer)
+				{
+					Slot *slot = static_cast<Slot*>(transfer->user_data);
+					slot->owner->_handler(slot->index, getTransferError(transfer->status), transfer->actual_length);
+				}
+
+				static int getTransferError(int status)
+				{
+					switch(status)
+					{
+						case LIBUSB_TRANSFER_COMPLETED:
+							return 0;
+						case LIBUSB_TRANSFER_TIMED_OUT:
+							return LIBUSB_ERROR_TIMEOUT;
+						case LIBUSB_TRANSFER_CANCELLED:
+							return LIBUSB_ERROR_INTERRUPTED;
+						case LIBUSB_TRANSFER_STALL:
+							return LIBUSB_ERROR_PIPE;
+						case LIBUSB_TRANSFER_NO_DEVICE:
+							return LIBUSB_ERROR_NO_DEVICE;
+						case LIBUSB_TRANSFER_OVERFLOW:
+							return LIBUSB_ERROR_OVERFLOW;
+						default:
+							return LIBUSB_ERROR_IO;
+					}
+				}
+
+				libusb_context *_USBContext;
+				libusb_device_handle *_device;
+				CompletionHandler _handler;
+				size_t _size;
+				std::vector<Slot> _slots;
+		};
+	}
+
 	void USB::init(uint32_t vendorId, uint32_t productId)
 	{
 		libusb_device **listOfDevices;
@@ -93,6 +209,9 @@ namespace source
 	void USB::release()
 	{
 		int rc;
+		// Pending transfers must be cancelled before the device is closed
+		_queue.reset();
+		_transport.reset();
 		if (_device)
 		{
 			rc = libusb_release_interface(_device, 0);
@@ -133,6 +252,12 @@ namespace source
 				return " LIBUSB_ERROR_TIMEOUT";
 			case LIBUSB_ERROR_BUSY:
 				return " LIBUSB_ERROR_BUSY";
+			case LIBUSB_ERROR_OVERFLOW:
+				return " LIBUSB_ERROR_OVERFLOW";
+			case LIBUSB_ERROR_PIPE:
+				return " LIBUSB_ERROR_PIPE";
+			case LIBUSB_ERROR_INTERRUPTED:
+				return " LIBUSB_ERROR_INTERRUPTED";
 			default:
 				return " Unknown error";
 		}
@@ -158,6 +283,18 @@ namespace source
 
 	bool USB::read_data(unsigned char iEndPoint, unsigned char **oData, size_t *oLength)
 	{
+		if(_nbQueuedTransfers > 1 && (!_queue || _queue->getEndPoint() == iEndPoint))
+		{
+			if(!_queue)
+			{
+				_transport.reset(new LibusbInTransport(_USBContext, _device));
+				_queue.reset(new TransferQueue(*_transport, iEndPoint, _nbQueuedTransfers, RESPONSE_BUFFER_SIZE));
+			}
+			int rc = _queue->read(oData, oLength, _timeout);
+			checkAndThrowUSBOperation(rc);
+			return true;
+		}
+
 		int transferred;
 		int rc = libusb_bulk_transfer(_device, iEndPoint /*0x81*/, _responseData, RESPONSE_BUFFER_SIZE, &transferred, _timeout);
 		*oLength = (size_t) transferred;
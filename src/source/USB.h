@@ -2,8 +2,10 @@
 #define _SOURCE_USB_HPP_
 
 #include <libusb.h>
+#include <memory>
 #include <string>
 #include "Source.h"
+#include "TransferQueue.h"
 
 #define RESPONSE_BUFFER_SIZE 4096
 
@@ -16,7 +18,7 @@ namespace source
 	{
 		public:
 			// TODO: configurable timeout ?
-			USB() : _USBContext(nullptr), _device(nullptr), _timeout(5000) {};
+			USB() : _USBContext(nullptr), _device(nullptr), _timeout(5000), _nbQueuedTransfers(0) {};
 			~USB() override = default;
 
 			/**
@@ -29,6 +31,14 @@ namespace source
 			 */
 			void release() override;
 
+			/**
+			  Read the first end point read from with a ring of transfers kept submitted (see TransferQueue),
+			  instead of one synchronous transfer per read. Other end points are still read synchronously.
+			  Only for devices sending data when asked: packets are never requested by the reads themselves.
+			  @param iNbTransfers Number of transfers in the ring, 0 or 1 to read synchronously
+			 */
+			void setQueuedReads(size_t iNbTransfers) { _nbQueuedTransfers = iNbTransfers; };
+
 			/**
 			  Read data from source. Handle associated memory.
 			  @param iEndPoint End point from which the data will be read
@@ -73,6 +83,10 @@ namespace source
 			bool _kernelDriver0;
 			bool _kernelDriver1;
 			bool _hasInterface1;
+
+			size_t _nbQueuedTransfers;
+			std::unique_ptr<InTransport> _transport;
+			std::unique_ptr<TransferQueue> _queue;
 	};
 }
 
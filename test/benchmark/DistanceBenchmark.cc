@@ -0,0 +1,153 @@
+// Compares throughput and accuracy of the distance engines against distanceEarth.
+// Built and run with: make benchmark
+
+#include <Utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Track
+	{
+		const char *name;
+		std::vector<double> lat;
+		std::vector<double> lon;
+		double referenceLatitude;
+	};
+
+	// Random walk with steps of 1 to 50 meters, like the samples recorded by the watches
+	Track randomWalk(const char *name, double lat0, double lon0, size_t nbPoints, std::mt19937 &generator)
+	{
+		std::uniform_real_distribution<double> step(1, 50);
+		std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+		Track track;
+		track.name = name;
+		double lat = lat0;
+		double lon = lon0;
+		double minLat = lat;
+		double maxLat = lat;
+		for(size_t i = 0; i < nbPoints; ++i)
+		{
+			track.lat.push_back(lat);
+			track.lon.push_back(lon);
+			double meters = step(generator);
+			double angle = heading(generator);
+			lat += meters * cos(angle) / 111195.0;
+			lon += meters * sin(angle) / (111195.0 * cos(lat * M_PI / 180));
+			// Stay in an area of about 20 km, as a real session would
+			lat = std::max(lat0 - 0.1, std::min(lat0 + 0.1, lat));
+			lon = std::max(lon0 - 0.1, std::min(lon0 + 0.1, lon));
+			minLat = std::min(minLat, lat);
+			maxLat = std::max(maxLat, lat);
+		}
+		track.referenceLatitude = (minLat + maxLat) / 2;
+		return track;
+	}
+
+	template<typename Function>
+	double nanosecondsPerSegment(const Track &track, std::vector<double> &result, Function function)
+	{
+		const int nbRuns = 5;
+		double best = 0;
+		for(int run = 0; run < nbRuns; ++run)
+		{
+			auto start = std::chrono::steady_clock::now();
+			function(track, result);
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			double perSegment = elapsed.count() / result.size();
+			if(run == 0 || perSegment < best) best = perSegment;
+		}
+		return best;
+	}
+
+	void maxErrors(const std::vector<double> &reference, const std::vector<double> &result, double &maxRelative, double &maxAbsolute)
+	{
+		maxRelative = 0;
+		maxAbsolute = 0;
+		for(size_t i = 0; i < reference.size(); ++i)
+		{
+			double error = fabs(result[i] - reference[i]);
+			maxAbsolute = std::max(maxAbsolute, error);
+			if(reference[i] > 1e-3) maxRelative = std::max(maxRelative, error / reference[i]);
+		}
+	}
+
+	void benchmark(const Track &track)
+	{
+		size_t nbSegments = track.lat.size() - 1;
+		std::vector<double> reference(nbSegments);
+		std::vector<double> batch(nbSegments);
+		std::vector<double> equirectangular(nbSegments);
+		DistanceEngine engine(DISTANCE_EQUIRECTANGULAR, track.referenceLatitude);
+
+		double scalarTime = nanosecondsPerSegment(track, reference, [](const Track &t, std::vector<double> &r)
+		{
+			for(size_t i = 0; i < r.size(); ++i)
+			{
+				r[i] = distanceEarth(t.lat[i], t.lon[i], t.lat[i+1], t.lon[i+1]);
+			}
+		});
+		double batchTime = nanosecondsPerSegment(track, batch, [](const Track &t, std::vector<double> &r)
+		{
+			distanceEarthBatch(t.lat.data(), t.lon.data(), t.lat.size(), r.data());
+		});
+		double equirectangularTime = nanosecondsPerSegment(track, equirectangular, [&engine](const Track &t, std::vector<double> &r)
+		{
+			engine.distances(t.lat.data(), t.lon.data(), t.lat.size(), r.data());
+		});
+
+		double relative;
+		double absolute;
+		printf("%-22s %zu segments\n", track.name, nbSegments);
+		printf("  %-28s %8.2f ns/segment\n", "distanceEarth", scalarTime);
+		maxErrors(reference, batch, relative, absolute);
+		printf("  %-28s %8.2f ns/segment  max error %.2e (relative) %.2e m\n", (std::string("distanceEarthBatch (") + distanceEarthBatchImplementation() + ")").c_str(), batchTime, relative, absolute);
+		maxErrors(reference, equirectangular, relative, absolute);
+		printf("  %-28s %8.2f ns/segment  max error %.2e (relative) %.2e m\n", "equirectangular", equirectangularTime, relative, absolute);
+	}
+
+	// Worst cases for the equirectangular bound: segments of up to EQUIRECTANGULAR_MAX_SEGMENT,
+	// anywhere in the domain where the approximation is used
+	void equirectangularWorstCase(std::mt19937 &generator)
+	{
+		std::uniform_real_distribution<double> unit(0, 1);
+		std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+		double maxRelative = 0;
+		size_t nbChecked = 0;
+		for(int i = 0; i < 2000000; ++i)
+		{
+			double maxLatitude = DistanceEngine::EQUIRECTANGULAR_MAX_LATITUDE;
+			double gap = DistanceEngine::EQUIRECTANGULAR_MAX_LATITUDE_GAP;
+			double referenceLatitude = (2 * unit(generator) - 1) * maxLatitude;
+			double lat1 = referenceLatitude + (2 * unit(generator) - 1) * gap;
+			double lon1 = (2 * unit(generator) - 1) * 180;
+			double meters = unit(generator) * DistanceEngine::EQUIRECTANGULAR_MAX_SEGMENT;
+			double angle = heading(generator);
+			double lat2 = lat1 + meters * cos(angle) / 111195.0;
+			double lon2 = lon1 + meters * sin(angle) / (111195.0 * cos(lat1 * M_PI / 180));
+			DistanceEngine engine(DISTANCE_EQUIRECTANGULAR, referenceLatitude);
+			double expected = distanceEarth(lat1, lon1, lat2, lon2);
+			if(expected < 1) continue;
+			maxRelative = std::max(maxRelative, fabs(engine.distance(lat1, lon1, lat2, lon2) - expected) / expected);
+			++nbChecked;
+		}
+		printf("equirectangular worst case on %zu random segments: %.2e (relative), bound is %.0e\n", nbChecked, maxRelative, DistanceEngine::EQUIRECTANGULAR_MAX_RELATIVE_ERROR);
+	}
+}
+
+int main()
+{
+	std::mt19937 generator(42);
+	const size_t nbPoints = 1000000;
+	benchmark(randomWalk("Equator", 0.5, 10, nbPoints, generator));
+	benchmark(randomWalk("Paris (48.8N)", 48.8567, 2.3508, nbPoints, generator));
+	benchmark(randomWalk("Tromso (69.6N)", 69.6492, 18.9553, nbPoints, generator));
+	benchmark(randomWalk("Antimeridian (65S)", -65, 179.95, nbPoints, generator));
+	equirectangularWorstCase(generator);
+	return 0;
+}
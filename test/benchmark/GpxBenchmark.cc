@@ -0,0 +1,80 @@
+// Compares throughput of the GPX fast parser with the libxml2 reader on a long track.
+// Built and run with: make benchmark
+
+#include <device/GPX.h>
+#include <source/File.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace
+{
+	const char *GPX_FILE = "/tmp/kalenji_benchmark.gpx";
+
+	// Single track with points of a logger recording every second: position, elevation, time and heart rate
+	size_t writeTrack(size_t nbPoints)
+	{
+		std::ofstream file(GPX_FILE);
+		file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<gpx version=\"1.1\" creator=\"benchmark\" xmlns=\"http://www.topografix.com/GPX/1/1\" xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">\n"
+			"  <metadata><time>2013-12-27T14:09:08Z</time></metadata>\n"
+			"  <trk><name>Benchmark</name><trkseg>\n";
+		char point[512];
+		for(size_t i = 0; i < nbPoints; ++i)
+		{
+			size_t second = 14 * 3600 + i;
+			snprintf(point, sizeof(point), "      <trkpt lat=\"%.7f\" lon=\"%.7f\">\n        <ele>%.1f</ele>\n        <time>2013-12-%02zuT%02zu:%02zu:%02zuZ</time>\n"
+				"        <extensions><gpxtpx:TrackPointExtension><gpxtpx:hr>%zu</gpxtpx:hr></gpxtpx:TrackPointExtension></extensions>\n      </trkpt>\n",
+				48.8567 + (i % 10000) * 1e-5, 2.3508 + (i % 7000) * 1e-5, 35 + (i % 300) / 10.0,
+				1 + second / 86400 % 28, second / 3600 % 24, second / 60 % 60, second % 60, 90 + i % 90);
+			file << point;
+		}
+		file << "  </trkseg></trk>\n</gpx>\n";
+		return file.tellp();
+	}
+
+	// Best of a few runs, in MB/s
+	double throughput(size_t iSize, const std::string &iFastParser, const std::string &iJobs, size_t &oNbPoints)
+	{
+		std::map<std::string, std::string> values = { { "gpx_fast_parser", iFastParser }, { "jobs", iJobs } };
+		const int nbRuns = 3;
+		double best = 0;
+		for(int run = 0; run < nbRuns; ++run)
+		{
+			source::File file(GPX_FILE);
+			device::GPX gpx;
+			gpx.setConfiguration(Configuration(values));
+			gpx.setSource(&file);
+			SessionsMap sessions;
+			auto start = std::chrono::steady_clock::now();
+			gpx.init(gpx.getDeviceId());
+			gpx.getSessionsList(&sessions);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			gpx.release();
+			file.release();
+			oNbPoints = sessions.empty() ? 0 : sessions.begin()->second.getPoints().size();
+			double megabytesPerSecond = iSize / elapsed.count() / (1 << 20);
+			if(megabytesPerSecond > best) best = megabytesPerSecond;
+		}
+		return best;
+	}
+}
+
+int main()
+{
+	const size_t nbPoints = 500000;
+	size_t size = writeTrack(nbPoints);
+	printf("%zu points, %.1f MB\n", nbPoints, size / (double)(1 << 20));
+	size_t nbRead;
+	double libxml = throughput(size, "no", "0", nbRead);
+	printf("  %-28s %8.1f MB/s  %zu points\n", "libxml2 reader", libxml, nbRead);
+	double fastSequential = throughput(size, "yes", "1", nbRead);
+	printf("  %-28s %8.1f MB/s  %zu points\n", "fast parser, 1 job", fastSequential, nbRead);
+	double fast = throughput(size, "yes", "0", nbRead);
+	printf("  %-28s %8.1f MB/s  %zu points\n", "fast parser, 1 job per core", fast, nbRead);
+	remove(GPX_FILE);
+	return 0;
+}
@@ -0,0 +1,113 @@
+// Measures the throughput of the file outputs on a long session.
+// Built and run with: make benchmark
+
+#include <output/CSV.h>
+#include <output/Fitlog.h>
+#include <output/GPX.h>
+#include <output/GoogleMap.h>
+#include <output/GoogleStaticMap.h>
+#include <output/KML.h>
+#include <output/TCX.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <streambuf>
+#include <string>
+
+namespace
+{
+	// Counts the bytes written and drops them: only the formatting is measured, not the disk
+	class CountingBuffer : public std::streambuf
+	{
+		public:
+			size_t size = 0;
+
+		protected:
+			std::streamsize xsputn(const char *data, std::streamsize count) override
+			{
+				size += count;
+				return count;
+			}
+
+			int overflow(int c) override
+			{
+				if(c != traits_type::eof()) ++size;
+				return c;
+			}
+	};
+
+	// Session recorded every second with position, altitude, speed and heart rate, with a lap every 3000 points
+	void fillSession(Session &session, uint32_t nbPoints)
+	{
+		session.setTimeT(1388153348);
+		session.setName("Benchmark");
+		Lap *lap = nullptr;
+		for(uint32_t i = 0; i < nbPoints; ++i)
+		{
+			Point *point = session.createPoint(Field<double>(48.8567 + (i % 10000) * 1e-5), Field<double>(2.3508 + (i % 7000) * 1e-5),
+				Field<int16_t>(35 + i % 300), Field<double>(10 + (i % 50) / 10.0), 1388153348 + i, 0, Field<uint16_t>(90 + i % 90), 3);
+			if(i % 3000 == 0)
+			{
+				lap = session.createLap(i, std::min(i + 2999, nbPoints - 1), 3000, 10000, Field<double>(15), Field<double>(12),
+					Field<uint32_t>(170), Field<uint32_t>(150), Field<uint32_t>(80), FieldUndef, FieldUndef, FieldUndef);
+				lap->setLapNum(i / 3000);
+				lap->setStartPoint(point);
+			}
+			lap->setEndPoint(point);
+		}
+		session.setDuration(nbPoints);
+		session.setDistance(nbPoints * 3);
+		session.setAvgSpeed(Field<double>(12));
+		session.setMaxSpeed(Field<double>(15));
+	}
+
+	void benchmark(output::FileOutput &output, const Session &session, const Configuration &configuration)
+	{
+		output.configure(configuration);
+		const int nbRuns = 5;
+		double best = 0;
+		size_t size = 0;
+		for(int run = 0; run < nbRuns; ++run)
+		{
+			CountingBuffer buffer;
+			std::ostream stream(&buffer);
+			auto start = std::chrono::steady_clock::now();
+			{
+				output::Writer writer(stream);
+				output.dumpContent(writer, &session, configuration);
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			size = buffer.size;
+			double megabytesPerSecond = size / elapsed.count() / (1 << 20);
+			if(megabytesPerSecond > best) best = megabytesPerSecond;
+		}
+		printf("  %-16s %8.1f MB/s  %6.1f MB\n", output.getName().c_str(), best, size / (double)(1 << 20));
+	}
+}
+
+int main()
+{
+	const uint32_t nbPoints = 100000;
+	Session session;
+	fillSession(session, nbPoints);
+	std::map<std::string, std::string> values = { { "gpx_extensions", "gpxdata,gpxtpx" }, { "google_api_key", "benchmark" } };
+	Configuration configuration(values);
+	printf("%u points, %zu laps\n", nbPoints, session.getLaps().size());
+
+	output::GPX gpx;
+	output::TCX tcx;
+	output::KML kml;
+	output::Fitlog fitlog;
+	output::CSV csv;
+	output::GoogleMap googleMap;
+	output::GoogleStaticMap googleStaticMap;
+	benchmark(gpx, session, configuration);
+	benchmark(tcx, session, configuration);
+	benchmark(kml, session, configuration);
+	benchmark(fitlog, session, configuration);
+	benchmark(csv, session, configuration);
+	benchmark(googleMap, session, configuration);
+	benchmark(googleStaticMap, session, configuration);
+	return 0;
+}
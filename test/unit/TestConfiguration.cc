@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <Configuration.h>
+
+TEST(ConfigurationTest, EmptyConfiguration)
+{
+	Configuration configuration;
+
+	ASSERT_FALSE(configuration.isVerbose());
+	ASSERT_EQ(Configuration::OUTPUT_NAME_DATE, configuration.getOutputName());
+	ASSERT_EQ(DISTANCE_HAVERSINE, configuration.getDistanceMethod());
+	ASSERT_FALSE(configuration.has("directory"));
+	ASSERT_EQ("", configuration.get("directory"));
+	ASSERT_EQ(12u, configuration.getUInt("reduce_points_max", 12));
+	ASSERT_TRUE(configuration.getBool("log_transactions", true));
+	ASSERT_EQ(1u, configuration.getJobs());
+}
+
+TEST(ConfigurationTest, ConvertedValues)
+{
+	std::map<std::string, std::string> values;
+	values["verbose"] = "true";
+	values["directory"] = "/tmp/kalenji_import";
+	values["output_name"] = "name";
+	values["distance_method"] = "equirectangular";
+	values["trigger"] = "distance";
+	values["reduce_points_max"] = "200";
+	values["log_transactions"] = "no";
+	values["jobs"] = "4";
+	Configuration configuration(values);
+
+	ASSERT_TRUE(configuration.isVerbose());
+	ASSERT_EQ("/tmp/kalenji_import", configuration.getDirectory());
+	ASSERT_EQ(Configuration::OUTPUT_NAME_SESSION_NAME, configuration.getOutputName());
+	ASSERT_EQ(DISTANCE_EQUIRECTANGULAR, configuration.getDistanceMethod());
+	ASSERT_EQ("distance", configuration.getTrigger());
+	ASSERT_EQ(200u, configuration.getUInt("reduce_points_max"));
+	ASSERT_FALSE(configuration.getBool("log_transactions", true));
+	ASSERT_EQ(4u, configuration.getJobs());
+}
+
+TEST(ConfigurationTest, InvalidValues)
+{
+	std::map<std::string, std::string> values;
+	values["verbose"] = "maybe";
+	ASSERT_THROW(Configuration configuration(values), std::runtime_error);
+
+	values.clear();
+	values["output_name"] = "time";
+	ASSERT_THROW(Configuration configuration(values), std::runtime_error);
+
+	values.clear();
+	values["reduce_points_max"] = "-5";
+	values["reduce_points_min_dist"] = "10m";
+	values["google_map_height"] = "99999999999";
+	Configuration configuration(values);
+	ASSERT_THROW(configuration.getUInt("reduce_points_max"), std::runtime_error);
+	ASSERT_THROW(configuration.getUInt("reduce_points_min_dist"), std::runtime_error);
+	ASSERT_THROW(configuration.getUInt("google_map_height"), std::runtime_error);
+}
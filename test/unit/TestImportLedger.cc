@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <ImportLedger.h>
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <string>
+
+TEST(ImportLedgerTest, RecordsAreReadBack)
+{
+	std::string filename = "/tmp/kalenji_test_import_ledger";
+	std::remove(filename.c_str());
+	SessionId id = { 'A', '\x01' };
+	SessionId other = { 'B' };
+	{
+		ImportLedger ledger(filename);
+		ASSERT_FALSE(ledger.has("OnMove710", id));
+		ledger.record("OnMove710", id, 42, { "GPX" });
+		ledger.record("OnMove710", id, 42, { "KML" });
+		ledger.record("OnMove710", other, 7, { "GPX" });
+		// A session that changed replaces the previous one
+		ledger.record("OnMove710", other, 8, { "KML" });
+	}
+	// As if a crash happened while writing a record
+	std::ofstream(filename.c_str(), std::ios_base::app) << "OnMove710\t43";
+
+	ImportLedger ledger(filename);
+	ASSERT_TRUE(ledger.has("OnMove710", id));
+	ASSERT_FALSE(ledger.has("Kalenji", id));
+	ASSERT_TRUE(ledger.isImported("OnMove710", id, 42, { "GPX", "KML" }));
+	ASSERT_FALSE(ledger.isImported("OnMove710", id, 42, { "GPX", "TCX" }));
+	ASSERT_FALSE(ledger.isImported("OnMove710", id, 43, { "GPX" }));
+	ASSERT_TRUE(ledger.isImported("OnMove710", other, 8, { "KML" }));
+	ASSERT_FALSE(ledger.isImported("OnMove710", other, 8, { "GPX" }));
+
+	ledger.record("OnMove710", other, 8, { "GPX" });
+	ASSERT_TRUE(ImportLedger(filename).isImported("OnMove710", other, 8, { "GPX", "KML" }));
+}
+
+TEST(ImportLedgerTest, SummaryFingerprintChangesWhenSessionGrows)
+{
+	tm time = {};
+	time.tm_year = 120;
+	time.tm_mday = 1;
+	Session session(SessionId({ '1' }), 1, time, 100, 600, 2000, 1);
+	uint64_t fingerprint = ImportLedger::summaryFingerprint(session);
+	ASSERT_EQ(fingerprint, ImportLedger::summaryFingerprint(session));
+	session.setNbPoints(101);
+	ASSERT_NE(fingerprint, ImportLedger::summaryFingerprint(session));
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <Pipeline.h>
+#include <Registry.h>
+#include <filter/Filter.h>
+#include <output/Output.h>
+#include <bom/Session.h>
+#include <bom/Point.h>
+#include <test/unit/common.h>
+
+#include <cstdio>
+
+namespace filter
+{
+	// Fails on every session
+	class FailingTestFilter : public Filter
+	{
+		public:
+			void filter(Session *session, const Configuration &configuration) override { throw std::runtime_error("failing"); };
+			std::string getName() override { return "FailingTest"; };
+		private:
+			DECLARE_FILTER(FailingTestFilter);
+	};
+	REGISTER_FILTER(FailingTestFilter);
+}
+
+class PipelineTest : public testing::Test
+{
+	protected:
+		PipelineTest() : filters({ "ReducePoints", "Unknown" })
+		{
+			std::map<std::string, std::string> values;
+			values["reduce_points_max"] = "5";
+			configuration = Configuration(values);
+			LayerRegistry<filter::Filter>::getInstance()->getObject("ReducePoints")->configure(configuration);
+		};
+
+		Configuration configuration;
+		std::list<std::string> filters;
+		std::list<std::string> outputs;
+		Session sessions[4];
+};
+
+TEST_F(PipelineTest, ProcessesSessionsAndPrintsInOrder)
+{
+	for(int i = 0; i < 3; ++i)
+	{
+		test::addLapToSession(&sessions[i], 45.0 + i, 3.0, 60, 100, 10 * (i + 1));
+	}
+	ConsoleCapture console;
+	{
+		ThreadPool pool(3);
+		Pipeline pipeline(configuration, filters, outputs, pool);
+		for(auto& session : sessions)
+		{
+			pipeline.add(&session);
+		}
+		pipeline.add(&sessions[0]);
+		ASSERT_TRUE(pipeline.contains(&sessions[3]));
+		console.start();
+		pipeline.finish();
+		console.stop();
+	}
+
+	// Last session has no point: it's ignored. Adding a session twice does nothing.
+	std::ostringstream expected;
+	for(int i = 0; i < 3; ++i)
+	{
+		expected << "  Applying filter ReducePoints" << std::endl;
+		expected << "    Reduced session from " << 10 * (i + 1) << " to 5 points." << std::endl;
+		expected << "Filter does not exist: Unknown" << std::endl;
+	}
+	ASSERT_EQ(expected.str(), console.str());
+	for(int i = 0; i < 3; ++i)
+	{
+		ASSERT_EQ(5u, static_cast<const Session&>(sessions[i]).getPoints().size());
+	}
+}
+
+TEST_F(PipelineTest, TellsWhichOutputsSessionsWereExportedTo)
+{
+	filters.clear();
+	outputs = { "Unknown", "CSV" };
+	for(int i = 0; i < 2; ++i)
+	{
+		test::addLapToSession(&sessions[i], 45.0, 3.0, 60, 100, 10);
+	}
+	output::FileOutput *csv = dynamic_cast<output::FileOutput*>(LayerRegistry<output::Output>::getInstance()->getObject("CSV"));
+	std::map<std::string, std::string> values;
+
+	values["directory"] = "/tmp";
+	Configuration written(values);
+	std::remove(csv->getFileName(&sessions[0], written).c_str());
+	{
+		ThreadPool pool(2);
+		Pipeline pipeline(written, filters, outputs, pool);
+		pipeline.add(&sessions[0]);
+		pipeline.add(&sessions[3]);
+		pipeline.finish();
+		ASSERT_EQ(std::list<std::string>({ "CSV" }), pipeline.getExported(&sessions[0]));
+		// Sessions without points and sessions never added were not exported
+		ASSERT_TRUE(pipeline.getExported(&sessions[3]).empty());
+		ASSERT_TRUE(pipeline.getExported(&sessions[2]).empty());
+	}
+	ASSERT_EQ(0, std::remove(csv->getFileName(&sessions[0], written).c_str()));
+
+	// Output that fails, filter that fails
+	values["directory"] = "/tmp/kalenji_test_does_not_exist";
+	Configuration unwritable(values);
+	std::list<std::string> failingFilters = { "FailingTest" };
+	ThreadPool pool(2);
+	Pipeline failingOutput(unwritable, filters, outputs, pool);
+	Pipeline failingFilter(written, failingFilters, outputs, pool);
+	failingOutput.add(&sessions[0]);
+	failingFilter.add(&sessions[1]);
+	ConsoleCapture console;
+	console.start();
+	failingOutput.finish();
+	ASSERT_THROW(failingFilter.finish(), std::runtime_error);
+	console.stop();
+	ASSERT_TRUE(failingOutput.getExported(&sessions[0]).empty());
+	ASSERT_TRUE(failingFilter.getExported(&sessions[1]).empty());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <ThreadPool.h>
+#include <ConsoleCapture.h>
+#include <OrderedTasks.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsAllTasks)
+{
+	std::vector<int> done(1000, 0);
+	std::atomic<int> nbDone(0);
+	{
+		ThreadPool pool(4);
+		ASSERT_EQ(4u, pool.size());
+		for(size_t i = 0; i < done.size(); ++i)
+		{
+			pool.submit([&done, &nbDone, i]() { ++done[i]; ++nbDone; });
+		}
+		pool.wait();
+		ASSERT_EQ(1000, nbDone);
+		pool.submit([&nbDone]() { ++nbDone; });
+	}
+	ASSERT_EQ(1001, nbDone);
+	for(int count : done)
+	{
+		ASSERT_EQ(1, count);
+	}
+}
+
+TEST(ThreadPoolTest, OneThreadPerCoreByDefault)
+{
+	ThreadPool pool(0);
+	ASSERT_LE(1u, pool.size());
+}
+
+TEST(ConsoleCaptureTest, CapturesOnlyCurrentThread)
+{
+	ConsoleCapture captures[2];
+	{
+		ThreadPool pool(2);
+		for(int i = 0; i < 2; ++i)
+		{
+			ConsoleCapture *capture = &captures[i];
+			pool.submit([capture, i]()
+			{
+				capture->start();
+				for(int j = 0; j < 100; ++j)
+				{
+					std::cout << "task " << i << " line " << j << std::endl;
+				}
+				std::cerr << "task " << i << " error" << std::endl;
+				capture->stop();
+			});
+		}
+	}
+	for(int i = 0; i < 2; ++i)
+	{
+		std::ostringstream expected;
+		for(int j = 0; j < 100; ++j)
+		{
+			expected << "task " << i << " line " << j << std::endl;
+		}
+		expected << "task " << i << " error" << std::endl;
+		ASSERT_EQ(expected.str(), captures[i].str());
+	}
+}
+
+TEST(OrderedTasksTest, CompletesInSubmissionOrderOnSharedPool)
+{
+	ThreadPool pool(4);
+	ConsoleCapture console;
+	std::vector<int> completed;
+	{
+		OrderedTasks first(pool);
+		OrderedTasks second(pool);
+		for(int i = 0; i < 4; ++i)
+		{
+			// First tasks take longer: they are done last
+			first.submit([i]() { std::this_thread::sleep_for(std::chrono::milliseconds(5 * (4 - i))); std::cout << "first " << i << std::endl; });
+			second.submit([i]() { std::cout << "second " << i << std::endl; if(i == 2) throw std::runtime_error("Task failed"); });
+		}
+		console.start();
+		for(int i = 0; i < 4; ++i)
+		{
+			ASSERT_TRUE(first.completeNext());
+			completed.push_back(i);
+		}
+		ASSERT_FALSE(first.completeNext());
+		// Tasks after the failing one are run but not completed
+		ASSERT_THROW(second.completeAll(), std::runtime_error);
+		console.stop();
+	}
+	ASSERT_EQ(std::vector<int>({ 0, 1, 2, 3 }), completed);
+	ASSERT_EQ("first 0\nfirst 1\nfirst 2\nfirst 3\nsecond 0\nsecond 1\nsecond 2\n", console.str());
+}
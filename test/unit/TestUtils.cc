@@ -3,6 +3,10 @@
 #include <bom/Field.h>
 #include <bom/Point.h>
 #include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
 
 class UtilsTest : public testing::Test 
 {
@@ -191,3 +195,116 @@ TEST_F(UtilsTest, testDirOnRegularFile)
 
     ASSERT_EQ(-1, testDir(_testFileName, true));
 }
+
+TEST_F(UtilsTest, distanceEarthBatchMatchesScalar)
+{
+    // Track with small steps followed by long jumps (antimeridian, poles, antipodes)
+    std::vector<double> lat;
+    std::vector<double> lon;
+    srand(42);
+    for(int i = 0; i < 1001; ++i)
+    {
+        lat.push_back(45.0 + i * 1e-4 + (rand() % 100) * 1e-6);
+        lon.push_back(5.0 + i * 2e-4 - (rand() % 100) * 1e-6);
+    }
+    const double jumps[][2] = { {0, 179.9}, {0, -179.9}, {90, 0}, {-90, 45}, {10, 20}, {-10, -160}, {-10, -160}, {89.99, 10}, {-45, 3} };
+    for(const auto& jump : jumps)
+    {
+        lat.push_back(jump[0]);
+        lon.push_back(jump[1]);
+    }
+
+    std::vector<double> distances(lat.size() - 1, -1);
+    distanceEarthBatch(lat.data(), lon.data(), lat.size(), distances.data());
+    for(size_t i = 0; i < distances.size(); ++i)
+    {
+        double expected = distanceEarth(lat[i], lon[i], lat[i+1], lon[i+1]);
+        // Antipodes: asin is evaluated close to 1 where rounding errors are amplified
+        double tolerance = expected > 20000000 ? 1 : expected * DISTANCE_EARTH_BATCH_TOLERANCE + 1e-9;
+        ASSERT_NEAR(expected, distances[i], tolerance) << "segment " << i << " with " << distanceEarthBatchImplementation();
+    }
+    EXPECT_EQ(0, distances[distances.size() - 3]);
+}
+
+TEST_F(UtilsTest, parseDistanceMethod)
+{
+    ASSERT_EQ(DISTANCE_HAVERSINE, parseDistanceMethod("haversine"));
+    ASSERT_EQ(DISTANCE_HAVERSINE, parseDistanceMethod(""));
+    ASSERT_EQ(DISTANCE_EQUIRECTANGULAR, parseDistanceMethod("equirectangular"));
+    ASSERT_THROW(parseDistanceMethod("flat"), std::runtime_error);
+}
+
+TEST_F(UtilsTest, equirectangularDistanceWithinBound)
+{
+    DistanceEngine engine(DISTANCE_EQUIRECTANGULAR, 48.85);
+    // Short segments around the reference latitude, in all directions
+    const double segments[][4] = { {48.8567, 2.3508, 48.8568, 2.3510}, {48.9, 2.35, 48.9, 2.36}, {48.2, 2.35, 48.205, 2.35}, {49.6, 2.35, 49.601, 2.349} };
+    for(const auto& segment : segments)
+    {
+        double expected = distanceEarth(segment[0], segment[1], segment[2], segment[3]);
+        ASSERT_NEAR(expected, engine.distance(segment[0], segment[1], segment[2], segment[3]), expected * DistanceEngine::EQUIRECTANGULAR_MAX_RELATIVE_ERROR);
+    }
+
+    // Across the antimeridian
+    DistanceEngine south(DISTANCE_EQUIRECTANGULAR, -65);
+    double expected = distanceEarth(-65, 179.999, -65, -179.999);
+    ASSERT_NEAR(expected, south.distance(-65, 179.999, -65, -179.999), expected * DistanceEngine::EQUIRECTANGULAR_MAX_RELATIVE_ERROR);
+
+    // Out of the domain of the approximation: same as distanceEarth
+    ASSERT_EQ(distanceEarth(48.85, 2.35, 51.5, -0.12), engine.distance(48.85, 2.35, 51.5, -0.12));
+    ASSERT_EQ(distanceEarth(52, 2.35, 52.001, 2.35), engine.distance(52, 2.35, 52.001, 2.35));
+}
+
+TEST_F(UtilsTest, timeCodecParse)
+{
+    TimeCodec codec;
+    time_t time;
+    ASSERT_TRUE(codec.parseUtc("2013-12-27T14:09:08Z", 20, time));
+    ASSERT_EQ(1388153348, time);
+    // Fraction of second and time zone are ignored, as before
+    ASSERT_TRUE(codec.parseUtc("2013-12-28T00:00:01.500+02:00", 29, time));
+    ASSERT_EQ(1388188801, time);
+    ASSERT_FALSE(codec.parseUtc("2013-12-27T14:09:08", 19, time));
+    ASSERT_FALSE(codec.parseUtc("2013-12-27T14:0x:08Z", 20, time));
+    ASSERT_FALSE(codec.parseUtc("Fri Dec 27 14:09:08 2013", 24, time));
+
+    tm fields;
+    ASSERT_TRUE(TimeCodec::parse("2013-12-27T14:09:08Z", 20, fields));
+    ASSERT_EQ(113, fields.tm_year);
+    ASSERT_EQ(11, fields.tm_mon);
+    ASSERT_EQ(27, fields.tm_mday);
+    ASSERT_EQ(14, fields.tm_hour);
+    ASSERT_EQ(9, fields.tm_min);
+    ASSERT_EQ(8, fields.tm_sec);
+}
+
+TEST_F(UtilsTest, timeCodecMatchesStrftime)
+{
+    TimeCodec codec;
+    char buffer[TimeCodec::FORMAT_BUFFER_SIZE];
+    char expected[64];
+    // Consecutive times spanning several days, then times far from each other
+    std::vector<time_t> times;
+    for(time_t time = 1388100000; time < 1388400000; time += 7) times.push_back(time);
+    for(time_t time = 0; time < 4000000000LL; time += 98765431) times.push_back(time);
+    for(time_t time : times)
+    {
+        tm utc;
+        gmtime_r(&time, &utc);
+        strftime(expected, sizeof(expected), "%Y-%m-%dT%H:%M:%S.042Z", &utc);
+        size_t size = codec.format(time, 42, buffer);
+        ASSERT_EQ(std::string(expected), std::string(buffer, size));
+        time_t parsed;
+        ASSERT_TRUE(codec.parseUtc(buffer, size, parsed));
+        ASSERT_EQ(time, parsed);
+        strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", &utc);
+        ASSERT_EQ(std::string(expected), std::string(buffer, codec.format(time, buffer, true)));
+
+        tm local;
+        localtime_r(&time, &local);
+        strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S.999", &local);
+        ASSERT_EQ(std::string(expected), std::string(buffer, codec.format(time, 999, buffer, true, true)));
+        ASSERT_TRUE(codec.parseLocal(expected, strlen(expected), parsed));
+        ASSERT_EQ(mktime(&local), parsed);
+    }
+}
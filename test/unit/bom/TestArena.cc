@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <bom/Arena.h>
+#include <bom/Session.h>
+
+TEST(ArenaTest, AllocationsAreAlignedAndOwned)
+{
+  Arena arena(64);
+  char *c = static_cast<char*>(arena.allocate(1, 1));
+  double *d = static_cast<double*>(arena.allocate(sizeof(double), alignof(double)));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(d) % alignof(double));
+  EXPECT_TRUE(arena.owns(c));
+  EXPECT_TRUE(arena.owns(d));
+  int onStack = 0;
+  EXPECT_FALSE(arena.owns(&onStack));
+  EXPECT_EQ(1u, arena.getNbBlocks());
+}
+
+TEST(ArenaTest, GrowsWhenBlockIsFull)
+{
+  Arena arena(64);
+  Point *first = arena.create<Point>();
+  for(int i = 0; i < 10; ++i)
+  {
+    arena.create<Point>();
+  }
+  EXPECT_LT(1u, arena.getNbBlocks());
+  EXPECT_TRUE(arena.owns(first));
+  // Bigger than any block: must still be served
+  EXPECT_NE(nullptr, arena.allocate(1024, 8));
+}
+
+TEST(ArenaTest, SessionCreatesPointsAndLaps)
+{
+  Session session;
+  Point *p1 = session.createPoint(45.5, 3.25, 120, FieldUndef, 1000, 0, 140, 3);
+  Point *p2 = session.createPoint();
+  Lap *lap = session.createLap();
+  // Points added the classic way must still be freed by the session
+  session.addPoint(new Point());
+
+  ASSERT_EQ(3u, session.getPoints().size());
+  EXPECT_EQ(p1, session.getPoints()[0]);
+  EXPECT_EQ(p2, session.getPoints()[1]);
+  EXPECT_DOUBLE_EQ(45.5, session.getPoints()[0]->getLatitude());
+  ASSERT_EQ(1u, session.getLaps().size());
+  EXPECT_EQ(lap, session.getLaps()[0]);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <bom/Session.h>
+
+TEST(PointColumnsTest, ColumnsMirrorPoints)
+{
+  Session session;
+  session.addPoint(new Point(45.5, 3.25, 120, FieldUndef, 1000, 250, 140, 3));
+  session.addPoint(new Point(FieldUndef, FieldUndef, FieldUndef, 12.5, 1001, 0, FieldUndef, 3));
+
+  const PointColumns &columns = session.getColumns();
+  ASSERT_EQ(2u, columns.size());
+
+  PointRef first = columns[0];
+  EXPECT_TRUE(columns.isDefined(0, PointColumns::POSITION | PointColumns::ALTITUDE | PointColumns::HEARTRATE));
+  EXPECT_FALSE(first.getSpeed().isDefined());
+  EXPECT_DOUBLE_EQ(45.5, first.getLatitude());
+  EXPECT_DOUBLE_EQ(3.25, first.getLongitude());
+  EXPECT_EQ(120, first.getAltitude());
+  EXPECT_EQ(140, first.getHeartRate());
+  EXPECT_EQ(session.getPoints()[0]->getTimeAsString(), first.getTimeAsString());
+
+  PointRef second = columns[1];
+  EXPECT_FALSE(second.getLatitude().isDefined());
+  EXPECT_FALSE(second.getAltitude().isDefined());
+  EXPECT_TRUE(second.getSpeed().isDefined());
+  EXPECT_DOUBLE_EQ(12.5, second.getSpeed());
+  EXPECT_EQ(1001, second.getTime());
+}
+
+TEST(PointColumnsTest, ColumnsRebuiltAfterModification)
+{
+  Session session;
+  session.addPoint(new Point(45.5, 3.25, 120, FieldUndef, 1000, 0, 140, 3));
+  EXPECT_EQ(1u, session.getColumns().size());
+
+  session.addPoint(new Point(45.6, 3.26, 121, FieldUndef, 1001, 0, 141, 3));
+  EXPECT_EQ(2u, session.getColumns().size());
+
+  session.getPoints()[1]->setAltitude(200);
+  EXPECT_EQ(200, session.getColumns()[1].getAltitude());
+}
+
+TEST(PointColumnsTest, DerivedChannels)
+{
+  Session session;
+  session.addPoint(new Point(48.8567, 2.3508, FieldUndef, FieldUndef, 1000, 0, FieldUndef, 3));
+  session.addPoint(new Point(48.8567, 2.3608, FieldUndef, FieldUndef, 1100, 0, FieldUndef, 3));
+  // No position: distance travelled at the given speed (36 km/h during 10 s)
+  session.addPoint(new Point(FieldUndef, FieldUndef, FieldUndef, 36, 1110, 0, FieldUndef, 3));
+  // Distance given by the watch takes precedence
+  Point *last = new Point(48.8567, 2.3708, FieldUndef, FieldUndef, 1120, 0, FieldUndef, 3);
+  last->setDistance(1000);
+  session.addPoint(last);
+
+  const PointColumns &columns = session.getColumns();
+  const std::vector<double> &distances = columns.getCumulativeDistances();
+  double segment = distanceEarth(48.8567, 2.3508, 48.8567, 2.3608);
+  ASSERT_EQ(4u, distances.size());
+  EXPECT_DOUBLE_EQ(0, distances[0]);
+  EXPECT_DOUBLE_EQ(segment, distances[1]);
+  EXPECT_DOUBLE_EQ(segment + 100, distances[2]);
+  EXPECT_DOUBLE_EQ(1000, distances[3]);
+
+  const std::vector<double> &elapsed = columns.getElapsedSeconds();
+  EXPECT_DOUBLE_EQ(0, elapsed[0]);
+  EXPECT_DOUBLE_EQ(120, elapsed[3]);
+
+  const std::vector<double> &speeds = columns.getInstantSpeeds();
+  EXPECT_DOUBLE_EQ(3.6 * segment / 100, speeds[0]);
+  EXPECT_DOUBLE_EQ(36, speeds[1]);
+  EXPECT_DOUBLE_EQ(speeds[2], speeds[3]);
+}
+
+TEST(PointColumnsTest, DistanceMethodOfSession)
+{
+  Session session;
+  session.addPoint(new Point(48.8567, 2.3508, FieldUndef, FieldUndef, 1000, 0, FieldUndef, 3));
+  session.addPoint(new Point(48.8570, 2.3512, FieldUndef, FieldUndef, 1010, 0, FieldUndef, 3));
+  double haversine = session.getColumns().getCumulativeDistances()[1];
+  EXPECT_DOUBLE_EQ(distanceEarth(48.8567, 2.3508, 48.8570, 2.3512), haversine);
+
+  session.setDistanceMethod(DISTANCE_EQUIRECTANGULAR);
+  const PointColumns &columns = session.getColumns();
+  EXPECT_EQ(DISTANCE_EQUIRECTANGULAR, columns.getDistanceEngine().getMethod());
+  EXPECT_DOUBLE_EQ(48.85685, columns.getDistanceEngine().getReferenceLatitude());
+  EXPECT_NEAR(haversine, columns.getCumulativeDistances()[1], haversine * DistanceEngine::EQUIRECTANGULAR_MAX_RELATIVE_ERROR);
+}
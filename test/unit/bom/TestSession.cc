@@ -1,5 +1,5 @@
 #include <gtest/gtest.h>
-#include <bom/Session.h>
+#include <bom/SessionsMap.h>
 
 #include <sstream>
 #include <ctime>
@@ -18,3 +18,66 @@ TEST(SessionTest, SessionToStream)
 
   EXPECT_EQ("   17 - 2000-12-31 00:00:00     1 laps          1 km          13m14s",oss.str());
 }
+
+TEST(SessionTest, MoveTransfersPointsAndLaps)
+{
+  Session session;
+  session.setNum(3);
+  Point *point = session.createPoint(45.5, 3.25, 120, FieldUndef, 1000, 0, 140, 3);
+  session.addPoint(new Point());
+  session.createLap();
+
+  Session moved(std::move(session));
+  EXPECT_EQ(0u, session.getPoints().size());
+  EXPECT_EQ(0u, session.getLaps().size());
+  ASSERT_EQ(2u, moved.getPoints().size());
+  EXPECT_EQ(point, moved.getPoints()[0]);
+  EXPECT_EQ(1u, moved.getLaps().size());
+  EXPECT_EQ(3u, moved.getNum());
+
+  Session assigned;
+  assigned.createPoint();
+  assigned = std::move(moved);
+  ASSERT_EQ(2u, assigned.getPoints().size());
+  EXPECT_EQ(point, assigned.getPoints()[0]);
+  EXPECT_EQ(0u, moved.getPoints().size());
+}
+
+TEST(SessionTest, EmplaceInSessionsMap)
+{
+  SessionsMap sessions;
+  SessionId id = {'4', '2'};
+  Session &inserted = sessions.emplace(id, Session()).first->second;
+  inserted.createPoint();
+  EXPECT_EQ(1u, sessions.find(id)->second.getPoints().size());
+}
+
+TEST(SessionTest, RemovePointsRebindsLaps)
+{
+  Session session;
+  std::vector<Point*> created;
+  for(int i = 0; i < 6; ++i)
+  {
+    created.push_back(session.createPoint(45.5, 3.25, 120, FieldUndef, 1000 + i, 0, 140, 3));
+  }
+  Lap *first = session.createLap();
+  first->setStartPoint(created[0]);
+  first->setEndPoint(created[3]);
+  Lap *second = session.createLap();
+  second->setStartPoint(created[3]);
+  second->setEndPoint(created[5]);
+
+  std::vector<bool> toRemove = { true, false, false, true, true, false };
+  EXPECT_EQ(3u, session.removePoints(toRemove));
+
+  ASSERT_EQ(3u, session.getPoints().size());
+  EXPECT_EQ(created[1], session.getPoints()[0]);
+  EXPECT_EQ(created[5], session.getPoints()[2]);
+  // No kept point before the first one: next kept point
+  EXPECT_EQ(created[1], first->getStartPoint());
+  // Previous kept point
+  EXPECT_EQ(created[2], first->getEndPoint());
+  EXPECT_EQ(created[2], second->getStartPoint());
+  EXPECT_EQ(created[5], second->getEndPoint());
+  EXPECT_EQ(3u, session.getColumns().size());
+}
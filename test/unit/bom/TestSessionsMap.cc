@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <bom/SessionsMap.h>
+
+#include <string>
+
+static Session sessionWithNum(uint32_t num)
+{
+  Session session;
+  session.setNum(num);
+  return session;
+}
+
+TEST(SessionIdTest, ComparesAndHashesContent)
+{
+  std::string prefix = "ABCD0001";
+  SessionId fromString(prefix.begin(), prefix.end());
+  SessionId fromList = {'A', 'B', 'C', 'D', '0', '0', '0', '1'};
+  SessionId other = {'A', 'B', 'C', 'D', '0', '0', '0', '2'};
+
+  EXPECT_EQ(fromString, fromList);
+  EXPECT_EQ(fromString.hash(), fromList.hash());
+  EXPECT_NE(fromString, other);
+  EXPECT_TRUE(fromString < other);
+  EXPECT_EQ(prefix, std::string(fromString.begin(), fromString.end()));
+  EXPECT_EQ('1', fromString.back());
+}
+
+TEST(SessionIdTest, ThrowsWhenTooLong)
+{
+  std::string tooLong(SessionId::MAX_SIZE + 1, 'x');
+  EXPECT_THROW(SessionId(tooLong.begin(), tooLong.end()), std::runtime_error);
+}
+
+TEST(SessionsMapTest, KeepsInsertionOrderAndFindsById)
+{
+  SessionsMap sessions;
+  SessionId id2 = {'2'};
+  SessionId id1 = {'1'};
+  SessionId id3 = {'3'};
+  sessions.emplace(id2, sessionWithNum(2));
+  sessions.emplace(id1, sessionWithNum(1));
+  sessions.emplace(id3, sessionWithNum(3));
+  // Same id: not inserted
+  EXPECT_FALSE(sessions.emplace(id1, sessionWithNum(4)).second);
+
+  ASSERT_EQ(3u, sessions.size());
+  auto it = sessions.begin();
+  EXPECT_EQ(id2, it->first);
+  EXPECT_EQ(id1, (++it)->first);
+  EXPECT_EQ(id3, (++it)->first);
+
+  EXPECT_EQ(1u, sessions.find(id1)->second.getNum());
+  EXPECT_EQ(sessions.end(), sessions.find(SessionId({'4'})));
+}
+
+TEST(SessionsMapTest, FindByNumFollowsErase)
+{
+  SessionsMap sessions;
+  SessionId id1 = {'1'};
+  SessionId id2 = {'2'};
+  sessions.emplace(id1, sessionWithNum(10));
+  sessions.emplace(id2, sessionWithNum(20));
+
+  EXPECT_EQ(id2, sessions.findByNum(20)->first);
+  EXPECT_EQ(sessions.end(), sessions.findByNum(30));
+
+  sessions.erase(sessions.find(id2));
+  EXPECT_EQ(sessions.end(), sessions.findByNum(20));
+  EXPECT_EQ(sessions.end(), sessions.find(id2));
+  EXPECT_EQ(id1, sessions.findByNum(10)->first);
+}
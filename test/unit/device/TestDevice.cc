@@ -1,6 +1,56 @@
 #include <gtest/gtest.h>
 #include <device/Device.h>
+#include <ConsoleCapture.h>
 
-TEST(DeviceTest, NoMoreTest)
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A mass storage device whose sessions take less time to decode as they come
+class ParallelDevice : public device::Device
+{
+	public:
+		void init(const device::DeviceId& deviceId) override {};
+		void release() override {};
+		void getSessionsList(SessionsMap *oSessions) override {};
+		void exportSession(const Session *iSession) override {};
+		void getSessionsDetails(SessionsMap *ioSessions) override
+		{
+			decodeSessions(ioSessions, [ioSessions](Session *session)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(5 * (ioSessions->size() - session->getNum())));
+				std::cout << "Decode " << session->getNum() << std::endl;
+				if(session->getNum() == 3) throw std::runtime_error("Corrupted session");
+			});
+		};
+		std::string getName() override { return "ParallelDevice"; };
+		device::DeviceId getDeviceId() override { return { 0, 0 }; };
+};
+
+TEST(DeviceTest, DecodeSessionsInOrder)
 {
+	std::map<std::string, std::string> values = { { "jobs", "4" } };
+	ParallelDevice device;
+	device.setConfiguration(Configuration(values));
+	std::vector<uint32_t> completed;
+	device.setSessionListener([&completed](Session *session) { completed.push_back(session->getNum()); });
+	SessionsMap sessions;
+	for(uint32_t num = 0; num < 5; ++num)
+	{
+		Session session;
+		session.setNum(num);
+		sessions.emplace(SessionId({ (char)('0' + num) }), std::move(session));
+	}
+
+	ConsoleCapture console;
+	console.start();
+	// Sessions after the failing one are decoded but not completed
+	ASSERT_THROW(device.getSessionsDetails(&sessions), std::runtime_error);
+	console.stop();
+	ASSERT_EQ(std::vector<uint32_t>({ 0, 1, 2 }), completed);
+	ASSERT_EQ("Decode 0\nDecode 1\nDecode 2\nDecode 3\n", console.str());
 }
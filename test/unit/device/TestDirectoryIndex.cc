@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <device/DirectoryIndex.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+TEST(DirectoryIndexTest, GroupsFilesByPrefix)
+{
+	std::string path = "/tmp/kalenji_test_directory_index";
+	mkdir(path.c_str(), 0755);
+	mkdir((path + "/DIR.GHP").c_str(), 0755);
+	std::ofstream(path + "/B.GHP") << "12345";
+	std::ofstream(path + "/B.GHT") << "1";
+	std::ofstream(path + "/A.GHT") << "";
+	std::ofstream(path + "/A.txt") << "";
+	std::ofstream(path + "/C.ght") << "";
+
+	device::DirectoryIndex index(path, { ".GHP", ".GHT" });
+	// Directories and other extensions are ignored
+	ASSERT_EQ(std::vector<std::string>({ "A", "B" }), index.getPrefixes());
+	ASSERT_TRUE(index.isComplete("B"));
+	ASSERT_FALSE(index.isComplete("A"));
+	ASSERT_FALSE(index.isComplete("C"));
+	ASSERT_EQ(nullptr, index.find("A", ".GHP"));
+	ASSERT_EQ(nullptr, index.find("B", ".GHL"));
+	const device::DirectoryIndex::File *file = index.find("B", ".GHP");
+	ASSERT_NE(nullptr, file);
+	ASSERT_EQ(path + "/B.GHP", file->path);
+	ASSERT_EQ(5u, file->size);
+	ASSERT_GT(file->modificationTime, 0);
+
+	ASSERT_THROW(device::DirectoryIndex(path + "/missing", { ".GHP" }), std::runtime_error);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <device/GPX.h>
+#include <source/File.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+
+static void parseGPX(const std::string &content, SessionsMap &oSessions, const std::string &fastParser = "no")
+{
+	std::ofstream("/tmp/kalenji_test.gpx") << content;
+	source::File file("/tmp/kalenji_test.gpx");
+	std::map<std::string, std::string> values = { { "gpx_fast_parser", fastParser }, { "jobs", "4" } };
+	device::GPX gpx;
+	gpx.setConfiguration(Configuration(values));
+	gpx.setSource(&file);
+	gpx.init(gpx.getDeviceId());
+	gpx.getSessionsList(&oSessions);
+	gpx.release();
+	file.release();
+}
+
+TEST(GPXTest, StreamsPointsIntoSession)
+{
+	std::string content = "<?xml version=\"1.0\"?>\n"
+		"<gpx version=\"1.1\" xmlns=\"http://www.topografix.com/GPX/1/1\" xmlns:gpxdata=\"http://www.cluetrust.com/XML/GPXDATA/1/0\">\n"
+		"  <metadata><name>Morning run</name><!-- ignored --><desc/></metadata>\n"
+		"  <trk><name>Track</name><trkseg>\n";
+	// Spread points over several chunks of the source
+	const int nbPoints = 20000;
+	for(int i = 0; i < nbPoints; ++i)
+	{
+		content += "    <trkpt lat=\"45.5\" lon=\"-0.25\"><ele>" + std::to_string(i) + "</ele><extensions><gpxdata:hr>142</gpxdata:hr></extensions><cmt/></trkpt>\n";
+	}
+	content += "    <trkpt lat=\"1\" lon=\"2\"/>\n  </trkseg></trk>\n</gpx>\n";
+	ASSERT_LT((size_t)FILE_CHUNK_SIZE, content.size());
+
+	SessionsMap sessions;
+	parseGPX(content, sessions);
+	ASSERT_EQ(1u, sessions.size());
+	Session &session = sessions.begin()->second;
+	ASSERT_EQ("Track", session.getName());
+	ASSERT_EQ((size_t)nbPoints + 1, session.getPoints().size());
+	Point *point = session.getPoints()[nbPoints - 1];
+	ASSERT_DOUBLE_EQ(45.5, point->getLatitude());
+	ASSERT_DOUBLE_EQ(-0.25, point->getLongitude());
+	ASSERT_EQ(nbPoints - 1, point->getAltitude());
+	ASSERT_EQ(142, point->getHeartRate());
+	ASSERT_TRUE(point->isImportant());
+	ASSERT_DOUBLE_EQ(2, session.getPoints()[nbPoints]->getLongitude());
+}
+
+TEST(GPXTest, MalformedDocumentGivesNoSession)
+{
+	SessionsMap sessions;
+	parseGPX("<?xml version=\"1.0\"?>\n<gpx><trk><trkseg><trkpt lat=\"1\" lon=\"2\"></trkseg></trk></gpx>\n", sessions);
+	ASSERT_EQ(0u, sessions.size());
+	parseGPX("<?xml version=\"1.0\"?>\n<kml></kml>\n", sessions);
+	ASSERT_EQ(0u, sessions.size());
+	parseGPX("", sessions);
+	ASSERT_EQ(0u, sessions.size());
+}
+
+// Parse a document with the fast parser and with libxml2 only: they must give the same points
+static void expectSamePoints(const std::string &content, size_t nbPoints)
+{
+	SessionsMap fastSessions;
+	SessionsMap sessions;
+	parseGPX(content, fastSessions, "yes");
+	parseGPX(content, sessions, "no");
+	ASSERT_EQ(1u, fastSessions.size());
+	ASSERT_EQ(1u, sessions.size());
+	const Session &fast = fastSessions.begin()->second;
+	const Session &reference = sessions.begin()->second;
+	ASSERT_EQ(reference.getName(), fast.getName());
+	ASSERT_EQ(reference.getTime(), fast.getTime());
+	ASSERT_EQ(reference.getLaps().size(), fast.getLaps().size());
+	ASSERT_EQ(nbPoints, reference.getPoints().size());
+	ASSERT_EQ(nbPoints, fast.getPoints().size());
+	for(size_t i = 0; i < nbPoints; ++i)
+	{
+		const Point *expected = reference.getPoints()[i];
+		const Point *point = fast.getPoints()[i];
+		ASSERT_DOUBLE_EQ(expected->getLatitude(), point->getLatitude()) << "point " << i;
+		ASSERT_DOUBLE_EQ(expected->getLongitude(), point->getLongitude()) << "point " << i;
+		ASSERT_EQ(expected->getAltitude().isDefined(), point->getAltitude().isDefined()) << "point " << i;
+		ASSERT_EQ(expected->getAltitude(), point->getAltitude()) << "point " << i;
+		ASSERT_EQ(expected->getHeartRate().isDefined(), point->getHeartRate().isDefined()) << "point " << i;
+		ASSERT_EQ(expected->getHeartRate(), point->getHeartRate()) << "point " << i;
+		ASSERT_EQ(expected->getTime(), point->getTime()) << "point " << i;
+		ASSERT_EQ(expected->isImportant(), point->isImportant()) << "point " << i;
+	}
+}
+
+TEST(GPXTest, FastParserMatchesLibxml)
+{
+	std::string header = "<?xml version=\"1.0\"?>\n"
+		"<gpx version=\"1.1\" xmlns=\"http://www.topografix.com/GPX/1/1\" xmlns:gpxdata=\"http://www.cluetrust.com/XML/GPXDATA/1/0\" xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">\n"
+		"  <metadata><name>Ride</name><time>2013-12-27T14:09:08Z</time></metadata>\n"
+		"  <trk><name>Track</name><trkseg>\n";
+	std::string points;
+	// Long enough to be read by the fast parser, and split in several chunks
+	const size_t nbPoints = 60000;
+	for(size_t i = 0; i < nbPoints; ++i)
+	{
+		std::string time = "2013-12-27T" + std::to_string(10 + i / 3600 % 10) + ":" + std::to_string(10 + i / 60 % 50) + ":" + std::to_string(10 + i % 50) + (i % 2 ? ".5Z" : "Z");
+		switch(i % 5)
+		{
+			case 0: points += "<trkpt lat=\"45." + std::to_string(i) + "\" lon='4.3'><ele>612.7</ele><time>" + time + "</time><extensions><gpxdata:hr>" + std::to_string(i % 200) + "</gpxdata:hr></extensions></trkpt>\n"; break;
+			case 1: points += "<trkpt lon=\"-4\" lat=\"45\" >\n <time>" + time + "</time>\n <sat>4</sat><cmt>lap</cmt>\n <extensions><gpxtpx:TrackPointExtension><gpxtpx:hr>90</gpxtpx:hr></gpxtpx:TrackPointExtension></extensions>\n</trkpt>\n"; break;
+			case 2: points += "<trkpt lat=\"1\" lon=\"2\"/>\n"; break;
+			case 3: points += "<trkpt lat=\"1\" lon=\"2\"><ele/><desc><b>skipped</b></desc></trkpt ></trkseg>\n<trkseg>\n"; break;
+			default: points += "<trkpt lat=\"3\" lon=\"4\"><time>" + time + "</time><extensions/></trkpt>"; break;
+		}
+	}
+	ASSERT_LT((size_t)GPX_FAST_PARSER_MIN_SIZE, points.size());
+	std::string footer = "  </trkseg></trk>\n<extensions><lap><index>1</index></lap></extensions></gpx>\n";
+	expectSamePoints(header + points + footer, nbPoints);
+
+	// Not handled by the fast parser, parsed with libxml2
+	expectSamePoints(header + points + "<!-- comment --><trkpt lat=\"1\" lon=\"2\"/>" + footer, nbPoints + 1);
+	expectSamePoints(header + points + "<trkpt lat=\"1\" lon=\"2\"><name>&amp;</name></trkpt>" + footer, nbPoints + 1);
+	expectSamePoints(header + points + "</trkseg></trk><trk><trkseg><trkpt lat=\"1\" lon=\"2\"/>" + footer, nbPoints + 1);
+	expectSamePoints(header + "<trkpt lat=\"1\" lon=\"2\"><time>2013-12-27</time></trkpt>" + footer, 1);
+	std::string waypoint = "<wpt lat=\"5\" lon=\"6\"/>";
+	expectSamePoints(header.substr(0, header.find("<trk>")) + waypoint + header.substr(header.find("<trk>")) + points + footer, nbPoints + 1);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <device/MoreDataReader.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A device answering each dataMore request with the next response of a list
+class FakeMoreDataDevice
+{
+ public:
+	explicit FakeMoreDataDevice(std::vector<std::string> responses) : nbReads(0), _responses(std::move(responses)) {}
+
+	device::MoreDataReader::ReadResponse reader()
+	{
+		return [this](unsigned char **oData, size_t *oLength)
+		{
+			if(nbReads >= _responses.size()) return false;
+			if(_responses[nbReads] == "error") throw std::runtime_error("USB error");
+			requests += "read ";
+			*oData = reinterpret_cast<unsigned char*>(&_responses[nbReads][0]);
+			*oLength = _responses[nbReads].size();
+			++nbReads;
+			return true;
+		};
+	}
+
+	device::MoreDataReader::RequestMore requester()
+	{
+		return [this]() { requests += "more "; };
+	}
+
+	std::string requests;
+	std::atomic<size_t> nbReads;
+
+ private:
+	std::vector<std::string> _responses;
+};
+
+static std::string next(device::MoreDataReader &reader)
+{
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	if(!reader.next(&data, &length)) return "none";
+	return std::string(reinterpret_cast<char*>(data), length);
+}
+
+TEST(MoreDataReaderTest, SameRequestsWithOrWithoutPrefetch)
+{
+	for(size_t depth : { 0, 1, 3 })
+	{
+		FakeMoreDataDevice device({ "\x80" "first", "\x80" "second", "\x8A" });
+		device::MoreDataReader reader(device.reader(), device.requester(), depth);
+		ASSERT_EQ("\x80" "first", next(reader));
+		ASSERT_EQ("\x80" "second", next(reader));
+		ASSERT_EQ("\x8A", next(reader));
+		// Nothing is read after the end marker
+		ASSERT_EQ("none", next(reader));
+		ASSERT_EQ("read more read more read ", device.requests);
+	}
+}
+
+TEST(MoreDataReaderTest, PrefetchIsBounded)
+{
+	FakeMoreDataDevice device({ "\x80" "1", "\x80" "2", "\x80" "3", "\x80" "4", "\x8A" });
+	device::MoreDataReader reader(device.reader(), device.requester(), 2);
+	for(int i = 0; i < 100 && device.nbReads < 2; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASSERT_EQ(2u, device.nbReads);
+
+	ASSERT_EQ("\x80" "1", next(reader));
+	ASSERT_EQ("\x80" "2", next(reader));
+	ASSERT_EQ("\x80" "3", next(reader));
+	reader.close();
+	ASSERT_LE(device.nbReads, 5u);
+}
+
+TEST(MoreDataReaderTest, ReadErrors)
+{
+	FakeMoreDataDevice device({ "\x80" "ok", "error" });
+	device::MoreDataReader reader(device.reader(), device.requester(), 2);
+	ASSERT_EQ("\x80" "ok", next(reader));
+	ASSERT_THROW(next(reader), std::runtime_error);
+
+	// A response that can't be read ends the responses, leaving the last one available
+	FakeMoreDataDevice truncated({ "\x80" "last" });
+	device::MoreDataReader truncatedReader(truncated.reader(), truncated.requester(), 2);
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	ASSERT_TRUE(truncatedReader.next(&data, &length));
+	ASSERT_FALSE(truncatedReader.next(&data, &length));
+	ASSERT_EQ("\x80" "last", std::string(reinterpret_cast<char*>(data), length));
+}
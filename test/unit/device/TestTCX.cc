@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <device/TCX.h>
+#include <source/File.h>
+#include <source/HexdumpFile.h>
+#include <ConsoleCapture.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+static std::string activity(const std::string &id, int nbPoints)
+{
+	std::string content = "<Activity Sport=\"Running\"><Id>" + id + "</Id><Lap StartTime=\"" + id + "\"><TotalTimeSeconds>60</TotalTimeSeconds><Track>";
+	for(int i = 0; i < nbPoints; ++i)
+	{
+		content += "<Trackpoint><Time>" + id + "</Time><Position><LatitudeDegrees>45.5</LatitudeDegrees><LongitudeDegrees>" + std::to_string(i) + "</LongitudeDegrees></Position>"
+			"<Extensions><ns3:TPX><ns3:Speed>2.5</ns3:Speed></ns3:TPX></Extensions></Trackpoint>";
+	}
+	return content + "</Track></Lap></Activity>\n";
+}
+
+static void readTCX(const std::string &content, SessionsMap &oSessions, std::vector<Session*> &oCompleted)
+{
+	std::ofstream("/tmp/kalenji_test.tcx") << content;
+	source::File file("/tmp/kalenji_test.tcx");
+	std::map<std::string, std::string> values = { { "jobs", "3" } };
+	device::TCX tcx;
+	tcx.setConfiguration(Configuration(values));
+	tcx.setSource(&file);
+	tcx.setSessionListener([&oCompleted](Session *session) { oCompleted.push_back(session); });
+	tcx.init(tcx.getDeviceId());
+	tcx.getSessionsList(&oSessions);
+	tcx.getSessionsDetails(&oSessions);
+	tcx.release();
+	file.release();
+}
+
+TEST(TCXTest, SessionPerActivity)
+{
+	std::string content = "<?xml version=\"1.0\"?>\n"
+		"<TrainingCenterDatabase xmlns=\"http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2\" xmlns:ns3=\"http://www.garmin.com/xmlschemas/ActivityExtension/v2\">\n"
+		"<Activities>\n<!-- <Activity><Id>commented</Id></Activity> -->\n" +
+		activity("2013-08-23T07:55:49Z", 3) + activity("2013-08-24T08:00:00Z", 5) + activity("2013-08-25T09:00:00Z", 0) +
+		"</Activities>\n</TrainingCenterDatabase>\n";
+
+	SessionsMap sessions;
+	std::vector<Session*> completed;
+	ConsoleCapture console;
+	console.start();
+	readTCX(content, sessions, completed);
+	console.stop();
+	ASSERT_EQ("", console.str());
+	ASSERT_EQ(3u, sessions.size());
+	ASSERT_EQ(3u, completed.size());
+	ASSERT_EQ("2013-08-23T07:55:49Z", completed[0]->getName());
+	ASSERT_EQ(3u, completed[0]->getPoints().size());
+	ASSERT_EQ(5u, completed[1]->getPoints().size());
+	ASSERT_EQ(0u, completed[2]->getPoints().size());
+	ASSERT_EQ(1377331200, completed[1]->getTime());
+	Point *point = completed[1]->getPoints()[4];
+	ASSERT_DOUBLE_EQ(4, point->getLongitude());
+	ASSERT_DOUBLE_EQ(9, point->getSpeed());
+	ASSERT_EQ(1u, completed[1]->getLaps().size());
+}
+
+TEST(TCXTest, TruncatedFile)
+{
+	std::string content = "<?xml version=\"1.0\"?>\n<TrainingCenterDatabase xmlns:ns3=\"http://www.garmin.com/xmlschemas/ActivityExtension/v2\"><Activities>\n" +
+		activity("2013-08-23T07:55:49Z", 3) + activity("2013-08-24T08:00:00Z", 5);
+	content.resize(content.size() - 40);
+
+	SessionsMap sessions;
+	std::vector<Session*> completed;
+	readTCX(content, sessions, completed);
+	ASSERT_EQ(1u, completed.size());
+	ASSERT_EQ(3u, completed[0]->getPoints().size());
+}
+
+TEST(TCXTest, OnlyReadsFiles)
+{
+	std::ofstream("/tmp/kalenji_test.tcx") << "<?xml version=\"1.0\"?>\n<TrainingCenterDatabase/>\n";
+	source::HexdumpFile hexdump("/tmp/kalenji_test.tcx");
+	device::TCX tcx;
+	tcx.setConfiguration(Configuration());
+	tcx.setSource(&hexdump);
+	ConsoleCapture console;
+	console.start();
+	ASSERT_THROW(tcx.init(tcx.getDeviceId()), std::runtime_error);
+	console.stop();
+	hexdump.release();
+}
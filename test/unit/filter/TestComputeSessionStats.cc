@@ -7,7 +7,7 @@
 class ComputeSessionStatsTest : public testing::Test 
 {
 	protected:
-		std::map<std::string, std::string> emptyConfiguration;
+		Configuration emptyConfiguration;
 		filter::ComputeSessionStats aComputeSessionsStatsFilter;
 		Session aSession;
 };
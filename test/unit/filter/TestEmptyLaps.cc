@@ -25,7 +25,7 @@ class EmptyLapsTest : public testing::Test
 		test::addLapToSession(&aSession, lat, lon, 50, 20, 1);
         }
 
-	std::map<std::string, std::string> emptyConfiguration;
+	Configuration emptyConfiguration;
 	filter::EmptyLaps aEmptyLapsFilter;
 	Session aSession;
 };
@@ -6,7 +6,7 @@
 class NullHeartrateTest : public testing::Test 
 {
 	protected:
-		std::map<std::string, std::string> emptyConfiguration;
+		Configuration emptyConfiguration;
 		filter::NullHeartrate aNullHeartrateFilter;
 		Session aSession;
 };
@@ -2,11 +2,14 @@
 #include <filter/ReducePoints.h>
 #include <bom/Session.h>
 #include <bom/Point.h>
+#include <bom/Lap.h>
+#include <cmath>
 
 class ReducePointsTest : public testing::Test 
 {
 	protected:
 		void addPointsToSession(uint32_t nbPoints, double startLat, double startLon, double deltaLat, double deltaLon);
+		void applyFilter();
 
 		std::map<std::string, std::string> aConfiguration;
 		filter::ReducePoints aReducePointsFilter;
@@ -22,12 +25,19 @@ void ReducePointsTest::addPointsToSession(uint32_t nbPoints, double startLat, do
 	}
 }
 
+void ReducePointsTest::applyFilter()
+{
+	Configuration configuration(aConfiguration);
+	aReducePointsFilter.configure(configuration);
+	aReducePointsFilter.filter(&aSession, configuration);
+}
+
 TEST_F(ReducePointsTest, LessPointsThanMax)
 {
 	aConfiguration["reduce_points_max"] = "50";
 	addPointsToSession(10, 45.5781883, 2.9440619, 0.0001, 0.0001);
 
-	aReducePointsFilter.filter(&aSession, aConfiguration);
+	applyFilter();
 
 	ASSERT_EQ(10u, aSession.getPoints().size());
 }
@@ -38,7 +48,7 @@ TEST_F(ReducePointsTest, MorePointsThanMax)
 	aConfiguration["reduce_points_min_dist"] = "10";
 	addPointsToSession(60, 45.5781883, 2.9440619, 0.00001, 0.00001);
 
-	aReducePointsFilter.filter(&aSession, aConfiguration);
+	applyFilter();
 
 	ASSERT_GE(50u, aSession.getPoints().size());
 }
@@ -53,7 +63,57 @@ TEST_F(ReducePointsTest, MorePointsThanMaxRemovesStraightLines)
 	addPointsToSession(50, 45.5781883+0.0005, 2.9440619+0.0005, -0.00001, 0.00001 );
 	addPointsToSession(50, 45.5781883,        2.9440619,        -0.00001, -0.00001);
 
-	aReducePointsFilter.filter(&aSession, aConfiguration);
+	applyFilter();
+
+	ASSERT_EQ(50u, aSession.getPoints().size());
+}
+
+TEST_F(ReducePointsTest, KeepsCornersOfStraightLines)
+{
+	aConfiguration["reduce_points_max"] = "4";
+	addPointsToSession(50, 45.5781883,        2.9440619,        0.00001,  0.00001 );
+	addPointsToSession(50, 45.5781883+0.0005, 2.9440619+0.0005, 0.00001,  -0.00001);
+	addPointsToSession(50, 45.5781883+0.001,  2.9440619,        -0.00001, -0.00001);
+
+	applyFilter();
+
+	const std::vector<Point*> &points = aSession.getPoints();
+	ASSERT_EQ(4u, points.size());
+	EXPECT_DOUBLE_EQ(45.5781883, points[0]->getLatitude());
+	EXPECT_NEAR(45.5786883, points[1]->getLatitude(), 0.00002);
+	EXPECT_NEAR(45.5791883, points[2]->getLatitude(), 0.00002);
+	EXPECT_DOUBLE_EQ(45.5781883+0.001-49*0.00001, points[3]->getLatitude());
+}
+
+TEST_F(ReducePointsTest, KeepsImportantPointsAndLapBoundaries)
+{
+	aConfiguration["reduce_points_max"] = "5";
+	addPointsToSession(100, 45.5781883, 2.9440619, 0.00001, 0.00001);
+	std::vector<Point*> &points = aSession.getPoints();
+	points[30]->setImportant(true);
+	Point *lapStart = points[50];
+	Point *lapEnd = points[70];
+	aSession.addLap(new Lap());
+	aSession.getLaps()[0]->setStartPoint(lapStart);
+	aSession.getLaps()[0]->setEndPoint(lapEnd);
+
+	applyFilter();
+
+	ASSERT_EQ(5u, points.size());
+	EXPECT_TRUE(points[1]->isImportant());
+	EXPECT_EQ(lapStart, points[2]);
+	EXPECT_EQ(lapEnd, points[3]);
+}
+
+TEST_F(ReducePointsTest, ReachesMaxOnLongTrack)
+{
+	aConfiguration["reduce_points_max"] = "500";
+	for(uint32_t i = 0; i < 100000; ++i)
+	{
+		aSession.addPoint(new Point(45.5 + 0.01 * sin(i / 100.0), 2.9 + i * 0.00001, FieldUndef, FieldUndef, i, 0, 100, 3));
+	}
+
+	applyFilter();
 
-	ASSERT_EQ(6u, aSession.getPoints().size());
+	ASSERT_EQ(500u, aSession.getPoints().size());
 }
@@ -4,7 +4,7 @@
 class UnreliablePointsTest : public testing::Test
 {
 	protected:
-		std::map<std::string, std::string> _emptyConfiguration;
+		Configuration _emptyConfiguration;
 		filter::UnreliablePoints _unreliablePointsFilter;
 		Session _session;
 };
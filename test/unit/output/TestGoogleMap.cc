@@ -9,11 +9,17 @@ class GoogleMapTest : public testing::Test
 		Session aSession;
 		output::GoogleMap aGoogleMapOutput;
 		std::ostringstream aOss;
+
+		void dumpSessionSummary()
+		{
+			output::Writer writer(aOss);
+			aGoogleMapOutput.dumpSessionSummary(writer, &aSession);
+		}
 };
 
 TEST_F(GoogleMapTest, DumpEmptySessionSummary)
 {
-	aGoogleMapOutput.dumpSessionSummary(aOss, &aSession);
+	dumpSessionSummary();
 
 	std::string expected = "<div id=\"summary\" style=\"width: 100% ; text-align:left\">\n"
 			"<b>Session summary:</b><br>\n"
@@ -26,7 +32,7 @@ TEST_F(GoogleMapTest, DumpOneLapSessionSummary)
 	double lat(12.345678), lon(9.876543), duration(30);
 	uint32_t length(500), nbPoints(30);
 	test::addLapToSession(&aSession, lat, lon, duration, length, nbPoints);
-	aGoogleMapOutput.dumpSessionSummary(aOss, &aSession);
+	dumpSessionSummary();
 
 	std::string expected = "<div id=\"summary\" style=\"width: 100% ; text-align:left\">\n"
 			"<b>Session summary:</b><br>\n"
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <output/Writer.h>
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+TEST(WriterTest, NumbersAsOstream)
+{
+	std::ostringstream expected;
+	std::ostringstream result;
+	{
+		output::Writer writer(result);
+		for(int precision : { 6, 8, 12 })
+		{
+			expected.precision(precision);
+			writer.precision(precision);
+			for(double value : { 0.0, -0.0, 1.0, 45.123456789, -0.000012345678, 1e21, 123456789.0, 1.0 / 3, (double) NAN, (double) INFINITY })
+			{
+				expected << value << ' ';
+				writer << value << ' ';
+			}
+		}
+		expected << std::numeric_limits<long long>::min() << ' ' << std::numeric_limits<unsigned long long>::max() << ' ' << (int16_t) -42 << ' ' << (uint16_t) 65535 << ' ' << 0u << '\n';
+		writer << std::numeric_limits<long long>::min() << ' ' << std::numeric_limits<unsigned long long>::max() << ' ' << (int16_t) -42 << ' ' << (uint16_t) 65535 << ' ' << 0u << '\n';
+	}
+	ASSERT_EQ(expected.str(), result.str());
+}
+
+TEST(WriterTest, FieldsPaddingAndEscaping)
+{
+	std::ostringstream result;
+	{
+		output::Writer writer(result);
+		writer.precision(12);
+		writer << output::ifDefined(Field<double>(45.123456789), "<lat>", "</lat>") << output::ifDefined(Field<double>(FieldUndef), "<lon>", "</lon>");
+		writer << Field<int16_t>(FieldUndef) << '|' << output::padded(5) << 42 << '|' << output::padded(2) << "long" << '|';
+		writer.hex(0xff00, 6);
+		writer << '|' << output::escaped("Tom & \"Jerry\" <run>") << '\n';
+	}
+	ASSERT_EQ("<lat>45.123457</lat>0|   42|long|00ff00|Tom &amp; &quot;Jerry&quot; &lt;run&gt;\n", result.str());
+}
+
+TEST(WriterTest, FlushesWhenFull)
+{
+	std::ostringstream result;
+	std::string expected;
+	output::Writer writer(result, 16);
+	for(int i = 0; i < 100; ++i)
+	{
+		writer << "point " << i << '\n';
+		expected += "point " + std::to_string(i) + "\n";
+	}
+	std::string longText(100, 'x');
+	writer << longText;
+	expected += longText;
+	ASSERT_GT(result.str().size(), 0u);
+	writer.flush();
+	ASSERT_EQ(expected, result.str());
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <source/Emulator.h>
+#include <source/TransactionLog.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// A query and its two responses, 20 ms later then 10 ms later
+static void writeLog(const std::string &filename)
+{
+	std::vector<source::Transaction> transactions = {
+		{ 0, source::TRANSACTION_WRITE, 0x03, std::string("\x02\x00\x01\x85\x84", 5) },
+		{ 20000000, source::TRANSACTION_READ, 0x81, std::string("\x85\x00", 2) },
+		{ 30000000, source::TRANSACTION_READ, 0x81, std::string("\x8a\x00", 2) }
+	};
+	source::writeTransactionLog(filename, transactions, source::LOG_BINARY);
+}
+
+static std::string readString(source::Emulator &emulator)
+{
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	emulator.read_data(0x81, &data, &length);
+	return std::string(reinterpret_cast<char*>(data), length);
+}
+
+TEST(EmulatorTest, FollowsTheLog)
+{
+	writeLog("/tmp/kalenji_test_emulator.klog");
+	source::Emulator emulator("/tmp/kalenji_test_emulator.klog", { source::EMULATOR_TIMING_NONE, 0, 0, 0 }, true);
+	emulator.init(0, 0);
+	// The watch waits for the query
+	ASSERT_THROW(readString(emulator), std::runtime_error);
+	unsigned char query[] = { 0x02, 0x00, 0x01, 0x85, 0x84 };
+	emulator.write_data(0x03, query, sizeof(query));
+	ASSERT_EQ(std::string("\x85\x00", 2), readString(emulator));
+	ASSERT_EQ(std::string("\x8a\x00", 2), readString(emulator));
+	// The log is over
+	ASSERT_THROW(readString(emulator), std::runtime_error);
+	ASSERT_EQ(2u, emulator.getReport().reads);
+	ASSERT_EQ(1u, emulator.getReport().writes);
+	ASSERT_EQ(0u, emulator.getReport().mismatches);
+	ASSERT_EQ(2u, emulator.getReport().stalls);
+}
+
+TEST(EmulatorTest, ReportsMismatches)
+{
+	writeLog("/tmp/kalenji_test_emulator.klog");
+	unsigned char query[] = { 0x02, 0x00, 0x01, 0x86, 0x84 };
+	source::Emulator strict("/tmp/kalenji_test_emulator.klog", { source::EMULATOR_TIMING_NONE, 0, 0, 0 }, true);
+	strict.init(0, 0);
+	ASSERT_THROW(strict.write_data(0x03, query, sizeof(query)), std::runtime_error);
+
+	source::Emulator emulator("/tmp/kalenji_test_emulator.klog", { source::EMULATOR_TIMING_NONE, 0, 0, 0 }, false);
+	emulator.init(0, 0);
+	emulator.write_data(0x03, query, sizeof(query));
+	// The watch answers anyway, responses not read before the next write are lost
+	ASSERT_EQ(std::string("\x85\x00", 2), readString(emulator));
+	emulator.write_data(0x03, query, sizeof(query));
+	ASSERT_EQ(2u, emulator.getReport().mismatches);
+	ASSERT_EQ(1u, emulator.getReport().unread);
+}
+
+TEST(EmulatorTest, DelaysResponses)
+{
+	writeLog("/tmp/kalenji_test_emulator.klog");
+	unsigned char query[] = { 0x02, 0x00, 0x01, 0x85, 0x84 };
+	source::Emulator emulator("/tmp/kalenji_test_emulator.klog", { source::EMULATOR_TIMING_RECORDED, 0, 0, 0 }, true);
+	emulator.init(0, 0);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	emulator.write_data(0x03, query, sizeof(query));
+	readString(emulator);
+	readString(emulator);
+	ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+	ASSERT_GE(emulator.getReport().waited, std::chrono::milliseconds(25));
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <source/TransactionLog.h>
+#include <source/TransactionLogWriter.h>
+#include <source/HexdumpFile.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::string readFile(const std::string &filename)
+{
+	std::ifstream file(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void logString(source::TransactionLogWriter &writer, source::TransactionDirection direction, unsigned char endPoint, const std::string &data)
+{
+	writer.log(direction, endPoint, reinterpret_cast<const unsigned char*>(data.data()), data.size());
+}
+
+TEST(TransactionLogTest, BinaryLogKeepsTransactionsThroughASmallRing)
+{
+	std::string big(100, '\x42');
+	{
+		// Smaller than the transactions: they wrap around the ring and are written in pieces
+		source::TransactionLogWriter writer("/tmp/kalenji_test_log.klog", source::LOG_BINARY, 16);
+		logString(writer, source::TRANSACTION_WRITE, 0x03, std::string("\x02\x00\x01\x85\x84", 5));
+		logString(writer, source::TRANSACTION_READ, 0x81, big);
+		logString(writer, source::TRANSACTION_READ, 0x81, "");
+	}
+
+	ASSERT_TRUE(source::isBinaryTransactionLog("/tmp/kalenji_test_log.klog"));
+	std::vector<source::Transaction> transactions = source::readTransactionLog("/tmp/kalenji_test_log.klog");
+	ASSERT_EQ(3u, transactions.size());
+	ASSERT_EQ(source::TRANSACTION_WRITE, transactions[0].direction);
+	ASSERT_EQ(0x03, transactions[0].endPoint);
+	ASSERT_EQ(std::string("\x02\x00\x01\x85\x84", 5), transactions[0].data);
+	ASSERT_EQ(source::TRANSACTION_READ, transactions[1].direction);
+	ASSERT_EQ(0x81, transactions[1].endPoint);
+	ASSERT_EQ(big, transactions[1].data);
+	ASSERT_EQ("", transactions[2].data);
+	ASSERT_LE(transactions[0].time, transactions[1].time);
+	ASSERT_LE(transactions[1].time, transactions[2].time);
+}
+
+TEST(TransactionLogTest, TextLogHasHistoricalFormat)
+{
+	{
+		source::TransactionLogWriter writer("/tmp/kalenji_test_log.log", source::LOG_TEXT, 16);
+		logString(writer, source::TRANSACTION_WRITE, 0x03, std::string("\x02\x00\x01\x85\x84", 5));
+		writer.flush();
+		ASSERT_EQ(" => 02 00 01 85 84 \n", readFile("/tmp/kalenji_test_log.log"));
+		logString(writer, source::TRANSACTION_READ, 0x81, "\x8A\xff");
+	}
+	ASSERT_EQ(" => 02 00 01 85 84 \n <= 8a ff \n", readFile("/tmp/kalenji_test_log.log"));
+	ASSERT_FALSE(source::isBinaryTransactionLog("/tmp/kalenji_test_log.log"));
+}
+
+TEST(TransactionLogTest, ConvertsBetweenFormats)
+{
+	std::string text = " => 02 00 01 78 79 \n <= 78 00 01 0a \n => 02 00 01 81 80 \n <= 8a 00 00 \n";
+	std::ofstream("/tmp/kalenji_test_convert.log") << text;
+
+	ASSERT_EQ("/tmp/kalenji_test_convert.klog", source::convertTransactionLog("/tmp/kalenji_test_convert.log"));
+	ASSERT_TRUE(source::isBinaryTransactionLog("/tmp/kalenji_test_convert.klog"));
+	ASSERT_EQ("/tmp/kalenji_test_convert.log", source::convertTransactionLog("/tmp/kalenji_test_convert.klog"));
+	ASSERT_EQ(text, readFile("/tmp/kalenji_test_convert.log"));
+
+	// The binary log is replayed like the text one
+	source::HexdumpFile replay("/tmp/kalenji_test_convert.klog");
+	replay.init(0, 0);
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	replay.read_data(0x81, &data, &length);
+	ASSERT_EQ(std::string("\x78\x00\x01\x0a", 4), std::string(reinterpret_cast<char*>(data), length));
+	replay.read_data(0x81, &data, &length);
+	ASSERT_EQ(std::string("\x8a\x00\x00", 3), std::string(reinterpret_cast<char*>(data), length));
+}
+
+TEST(TransactionLogTest, TruncatedBinaryLog)
+{
+	std::vector<source::Transaction> transactions = { { 12, source::TRANSACTION_READ, 0x81, std::string("\x8a\x00\x00", 3) } };
+	source::writeTransactionLog("/tmp/kalenji_test_truncated.klog", transactions, source::LOG_BINARY);
+	ASSERT_EQ(1u, source::readTransactionLog("/tmp/kalenji_test_truncated.klog").size());
+	std::string content = readFile("/tmp/kalenji_test_truncated.klog");
+	std::ofstream("/tmp/kalenji_test_truncated.klog") << content.substr(0, content.size() - 1);
+	ASSERT_THROW(source::readTransactionLog("/tmp/kalenji_test_truncated.klog"), std::runtime_error);
+	ASSERT_THROW(source::readTransactionLog("/tmp/kalenji_test_missing.klog"), std::runtime_error);
+}
+
+TEST(TransactionLogTest, TextLogReplay)
+{
+	// Written data and short lines are skipped, any number of digits is accepted
+	std::ofstream("/tmp/kalenji_test_replay.log") << " => 02 00 01 78 79 \r\n <= 78 0 1 a \r\n <= \n => 02 \n <= 8a 00 00";
+	source::HexdumpFile replay("/tmp/kalenji_test_replay.log");
+	replay.init(0, 0);
+	unsigned char *first = nullptr;
+	unsigned char *second = nullptr;
+	size_t firstLength = 0;
+	size_t secondLength = 0;
+	ASSERT_TRUE(replay.read_data(0x81, &first, &firstLength));
+	ASSERT_FALSE(replay.read_data(0x81, &second, &secondLength));
+	// Packets stay valid once the next ones are read
+	ASSERT_EQ(std::string("\x78\x00\x01\x0a", 4), std::string(reinterpret_cast<char*>(first), firstLength));
+	ASSERT_EQ(std::string("\x8a\x00\x00", 3), std::string(reinterpret_cast<char*>(second), secondLength));
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <source/TransferQueue.h>
+
+#include <libusb.h>
+#include <deque>
+#include <set>
+#include <string>
+
+// Delivers queued packets to the transfers in the order they were submitted, without hardware
+class FakeTransport : public source::InTransport
+{
+ public:
+	FakeTransport() : nbSubmits(0), nbCancels(0), freed(false), submitError(0) {}
+
+	std::vector<unsigned char*> allocate(unsigned char iEndPoint, size_t iNbTransfers, size_t iSize, CompletionHandler iHandler) override
+	{
+		_handler = iHandler;
+		_buffers.assign(iNbTransfers, std::string(iSize, '\0'));
+		std::vector<unsigned char*> buffers;
+		for(std::string& buffer : _buffers)
+		{
+			buffers.push_back(reinterpret_cast<unsigned char*>(&buffer[0]));
+		}
+		return buffers;
+	}
+
+	void free() override
+	{
+		EXPECT_TRUE(_pending.empty());
+		freed = true;
+	}
+
+	int submit(size_t iTransfer) override
+	{
+		if(submitError != 0) return submitError;
+		++nbSubmits;
+		_pending.push_back(iTransfer);
+		return 0;
+	}
+
+	void cancel(size_t iTransfer) override
+	{
+		++nbCancels;
+		_cancelled.insert(iTransfer);
+	}
+
+	int handleEvents(uint32_t iTimeout) override
+	{
+		while(!_pending.empty())
+		{
+			size_t transfer = _pending.front();
+			if(_cancelled.count(transfer) != 0)
+			{
+				_pending.pop_front();
+				_handler(transfer, LIBUSB_ERROR_INTERRUPTED, 0);
+			}
+			else if(!errors.empty())
+			{
+				_pending.pop_front();
+				_handler(transfer, errors.front(), 0);
+				errors.pop_front();
+			}
+			else if(!packets.empty())
+			{
+				_pending.pop_front();
+				_buffers[transfer].replace(0, packets.front().size(), packets.front());
+				_handler(transfer, 0, packets.front().size());
+				packets.pop_front();
+			}
+			else
+			{
+				break;
+			}
+		}
+		return 0;
+	}
+
+	std::deque<std::string> packets;
+	std::deque<int> errors;
+	int nbSubmits;
+	int nbCancels;
+	bool freed;
+	int submitError;
+
+ private:
+	CompletionHandler _handler;
+	std::vector<std::string> _buffers;
+	std::deque<size_t> _pending;
+	std::set<size_t> _cancelled;
+};
+
+static std::string readPacket(source::TransferQueue &queue, int expectedStatus = 0)
+{
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	EXPECT_EQ(expectedStatus, queue.read(&data, &length, 1000));
+	return data == nullptr ? std::string() : std::string(reinterpret_cast<char*>(data), length);
+}
+
+TEST(TransferQueueTest, ReadsPacketsInOrderAroundTheRing)
+{
+	FakeTransport transport;
+	transport.packets = { "p1", "p2", "packet3", "p4", "p5" };
+	{
+		source::TransferQueue queue(transport, 0x81, 2, 16);
+		ASSERT_EQ(2, transport.nbSubmits);
+		ASSERT_EQ("p1", readPacket(queue));
+		ASSERT_EQ("p2", readPacket(queue));
+		ASSERT_EQ("packet3", readPacket(queue));
+		ASSERT_EQ("p4", readPacket(queue));
+		ASSERT_EQ("p5", readPacket(queue));
+		// The buffer of each read but the last one was submitted again by the next read
+		ASSERT_EQ(6, transport.nbSubmits);
+	}
+	// The transfer of the last read was not submitted again
+	ASSERT_EQ(1, transport.nbCancels);
+	ASSERT_TRUE(transport.freed);
+}
+
+TEST(TransferQueueTest, KeepsBufferUntilNextRead)
+{
+	FakeTransport transport;
+	transport.packets = { "first", "second", "third" };
+	source::TransferQueue queue(transport, 0x81, 2, 16);
+
+	unsigned char *first = nullptr;
+	size_t length = 0;
+	ASSERT_EQ(0, queue.read(&first, &length, 1000));
+	ASSERT_EQ("second", readPacket(queue));
+	// The first buffer is submitted again only now and receives the third packet
+	ASSERT_EQ("third", readPacket(queue));
+	ASSERT_EQ("third", std::string(reinterpret_cast<char*>(first), 5));
+}
+
+TEST(TransferQueueTest, TimeoutDoesNotLosePackets)
+{
+	FakeTransport transport;
+	source::TransferQueue queue(transport, 0x81, 3, 16);
+
+	unsigned char *data = nullptr;
+	size_t length = 0;
+	ASSERT_EQ(LIBUSB_ERROR_TIMEOUT, queue.read(&data, &length, 10));
+	transport.packets = { "late" };
+	ASSERT_EQ("late", readPacket(queue));
+}
+
+TEST(TransferQueueTest, ReportsTransferErrors)
+{
+	FakeTransport transport;
+	transport.errors = { LIBUSB_ERROR_PIPE };
+	transport.packets = { "after" };
+	source::TransferQueue queue(transport, 0x81, 2, 16);
+
+	readPacket(queue, LIBUSB_ERROR_PIPE);
+	ASSERT_EQ("after", readPacket(queue));
+
+	transport.submitError = LIBUSB_ERROR_NO_DEVICE;
+	readPacket(queue, LIBUSB_ERROR_NO_DEVICE);
+}
+
+TEST(TransferQueueTest, ThrowsIfTransfersCantBeSubmitted)
+{
+	FakeTransport transport;
+	transport.submitError = LIBUSB_ERROR_NO_DEVICE;
+	ASSERT_THROW(source::TransferQueue(transport, 0x81, 2, 16), std::runtime_error);
+	ASSERT_TRUE(transport.freed);
+
+	ASSERT_THROW(source::TransferQueue(transport, 0x81, 1, 16), std::invalid_argument);
+}